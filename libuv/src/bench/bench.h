@@ -0,0 +1,47 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Shared by the benchmarks. Every result is one line of JSON on stdout:
+ *
+ *   {"name": "tcp_pump", "value": 1843.21, "unit": "MB/s"}
+ *
+ * Collect a run with `benchmark-foo >> results.jsonl`, or all of them with
+ * the `benchmarks` target, and compare runs by name.
+ */
+
+#ifndef UV_BENCH_H_
+#define UV_BENCH_H_
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static void bench_report(double value, const char* unit, const char* fmt, ...) {
+  va_list ap;
+
+  printf("{\"name\": \"");
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+  printf("\", \"value\": %.6g, \"unit\": \"%s\"}\n", value, unit);
+  fflush(stdout);
+}
+
+#endif /* UV_BENCH_H_ */
@@ -0,0 +1,131 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* A thread calls uv_async_send() in a loop while the loop thread closes the
+ * handle, then frees and poisons it from the close callback. A send that
+ * still touches the handle after uv_close() shows up as a crash here, or as
+ * a use-after-free when built with -fsanitize=address. Reports how many of
+ * those close rounds complete per second.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_ROUNDS 500
+
+static uv_async_t* handle;
+static uv_thread_t thread;
+static uv_idle_t idle;
+static volatile int stop;
+static volatile unsigned int sends;
+static unsigned int rounds;
+static int failed;
+
+static void start(uv_loop_t* loop);
+
+
+static void sender(void* arg) {
+  uv_async_t* h;
+
+  h = arg;
+  while (!stop) {
+    uv_async_send(h);
+    sends++;
+  }
+}
+
+
+static void async_cb(uv_async_t* h) {
+}
+
+
+static void close_cb(uv_handle_t* h) {
+  stop = 1;
+  if (uv_thread_join(&thread))
+    failed = 1;
+
+  memset(h, 0xdb, sizeof(uv_async_t));
+  free(h);
+  handle = NULL;
+
+  if (++rounds < NUM_ROUNDS && !failed)
+    start(idle.loop);
+  else
+    uv_close((uv_handle_t*) &idle, NULL);
+}
+
+
+/* Closes the handle once the sender is known to be running. */
+static void idle_cb(uv_idle_t* i) {
+  if (handle != NULL && sends > 5 && !uv_is_closing((uv_handle_t*) handle))
+    uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+static void start(uv_loop_t* loop) {
+  handle = malloc(sizeof(*handle));
+  if (handle == NULL || uv_async_init(loop, handle, async_cb)) {
+    failed = 1;
+    return;
+  }
+
+  stop = 0;
+  sends = 0;
+
+  if (uv_thread_create(&thread, sender, handle))
+    failed = 1;
+}
+
+
+int main(void) {
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_idle_init(&loop, &idle) || uv_idle_start(&idle, idle_cb))
+    return 1;
+
+  before = uv_hrtime();
+  start(&loop);
+  if (failed)
+    return 1;
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (failed || rounds != NUM_ROUNDS)
+    return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(NUM_ROUNDS / ((after - before) / 1e9),
+               "closes/s",
+               "async_close_while_sending");
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* 1, 4 and 16 threads call uv_async_send() on the same handle as fast as they
+ * can. Sends that arrive while the loop hasn't run the callback yet are
+ * coalesced, so the callback count says how much wakeup work they caused.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define NUM_SENDS (1000 * 1000)  /* Per thread. */
+#define MAX_THREADS 16
+
+static uv_async_t handle;
+static uv_mutex_t mutex;
+static unsigned int nthreads;
+static unsigned int finished;
+static unsigned int callbacks;
+
+
+static void sender(void* arg) {
+  unsigned int i;
+
+  for (i = 0; i < NUM_SENDS; i++)
+    uv_async_send(&handle);
+
+  uv_mutex_lock(&mutex);
+  finished++;
+  uv_mutex_unlock(&mutex);
+
+  /* Makes sure the callback runs after the last thread is done. */
+  uv_async_send(&handle);
+}
+
+
+static void async_cb(uv_async_t* handle) {
+  unsigned int n;
+
+  callbacks++;
+
+  uv_mutex_lock(&mutex);
+  n = finished;
+  uv_mutex_unlock(&mutex);
+
+  if (n == nthreads)
+    uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static int run(unsigned int n) {
+  uv_thread_t threads[MAX_THREADS];
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_async_init(&loop, &handle, async_cb))
+    return 1;
+
+  nthreads = n;
+  finished = 0;
+  callbacks = 0;
+  before = uv_hrtime();
+
+  for (i = 0; i < n; i++)
+    if (uv_thread_create(threads + i, sender, NULL))
+      return 1;
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  for (i = 0; i < n; i++)
+    if (uv_thread_join(threads + i))
+      return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report((double) n * NUM_SENDS / ((after - before) / 1e9),
+               "sends/s",
+               "async_fan_in_%u_threads",
+               n);
+  bench_report(callbacks, "callbacks", "async_fan_in_%u_threads_callbacks", n);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (uv_mutex_init(&mutex))
+    return 1;
+
+  if (run(1))
+    return 1;
+
+  if (run(4))
+    return 1;
+
+  if (run(MAX_THREADS))
+    return 1;
+
+  uv_mutex_destroy(&mutex);
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* One thread signals one async handle and waits for the loop to respond, on
+ * a loop with 1, 100 and 10,000 async handles. The idle handles shouldn't
+ * make a difference for the round trip time.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_PINGS (100 * 1000)
+
+static uv_async_t* handles;
+static unsigned int nhandles;
+static unsigned int pongs;
+static uv_sem_t sem;
+
+
+static void idle_async_cb(uv_async_t* handle) {
+  abort();  /* Nobody signals these. */
+}
+
+
+static void hot_async_cb(uv_async_t* handle) {
+  unsigned int i;
+
+  pongs++;
+  uv_sem_post(&sem);
+
+  if (pongs < NUM_PINGS)
+    return;
+
+  for (i = 0; i < nhandles; i++)
+    uv_close((uv_handle_t*) (handles + i), NULL);
+}
+
+
+static void sender(void* arg) {
+  unsigned int i;
+
+  for (i = 0; i < NUM_PINGS; i++) {
+    uv_async_send(handles);
+    uv_sem_wait(&sem);
+  }
+}
+
+
+static int run(unsigned int n) {
+  uv_thread_t thread;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  handles = malloc(n * sizeof(handles[0]));
+  if (handles == NULL)
+    return 1;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_sem_init(&sem, 0))
+    return 1;
+
+  nhandles = n;
+  pongs = 0;
+
+  if (uv_async_init(&loop, handles, hot_async_cb))
+    return 1;
+
+  for (i = 1; i < n; i++)
+    if (uv_async_init(&loop, handles + i, idle_async_cb))
+      return 1;
+
+  before = uv_hrtime();
+
+  if (uv_thread_create(&thread, sender, NULL))
+    return 1;
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (uv_thread_join(&thread))
+    return 1;
+
+  if (pongs != NUM_PINGS)
+    return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  uv_sem_destroy(&sem);
+  free(handles);
+
+  bench_report(NUM_PINGS / ((after - before) / 1e9),
+               "roundtrips/s",
+               "async_pending_%u_handles",
+               n);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run(1))
+    return 1;
+
+  if (run(100))
+    return 1;
+
+  if (run(10 * 1000))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,207 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Passes messages from 1, 2 and 4 threads into a loop, first the way
+ * applications do it today (uv_async_t plus a mutex-protected list) and then
+ * through a uv_channel_t. The channel is big enough that the producers
+ * rarely find it full; the number of times they did is reported as well.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_MSGS (2 * 1000 * 1000)
+#define CHANNEL_CAPACITY (64 * 1024)
+
+struct message {
+  struct message* next;
+};
+
+struct producer {
+  uv_thread_t thread;
+  unsigned int index;
+  unsigned int full;
+};
+
+static struct message* messages;
+static unsigned int nproducers;
+static unsigned int received;
+
+static uv_async_t async_handle;
+static uv_mutex_t mutex;
+static struct message* list_head;
+static struct message* list_tail;
+
+static uv_channel_t channel;
+
+
+static void async_producer(void* arg) {
+  struct producer* p;
+  struct message* m;
+  unsigned int i;
+
+  p = arg;
+
+  for (i = p->index; i < NUM_MSGS; i += nproducers) {
+    m = messages + i;
+    m->next = NULL;
+
+    uv_mutex_lock(&mutex);
+    if (list_tail == NULL)
+      list_head = m;
+    else
+      list_tail->next = m;
+    list_tail = m;
+    uv_mutex_unlock(&mutex);
+
+    uv_async_send(&async_handle);
+  }
+}
+
+
+static void async_cb(uv_async_t* handle) {
+  struct message* m;
+
+  uv_mutex_lock(&mutex);
+  m = list_head;
+  list_head = NULL;
+  list_tail = NULL;
+  uv_mutex_unlock(&mutex);
+
+  for (; m != NULL; m = m->next)
+    received++;
+
+  if (received == NUM_MSGS)
+    uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void channel_producer(void* arg) {
+  struct producer* p;
+  unsigned int i;
+
+  p = arg;
+
+  for (i = p->index; i < NUM_MSGS; i += nproducers) {
+    while (uv_channel_send(&channel, messages + i) == UV_EAGAIN) {
+      p->full++;
+      sched_yield();
+    }
+  }
+}
+
+
+static void channel_cb(uv_channel_t* handle, void** msgs, unsigned int n) {
+  received += n;
+
+  if (received == NUM_MSGS)
+    uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static int run(const char* name, unsigned int n, int use_channel) {
+  struct producer producers[4];
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int full;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  nproducers = n;
+  received = 0;
+
+  if (use_channel) {
+    if (uv_channel_init(&loop, &channel, CHANNEL_CAPACITY, channel_cb))
+      return 1;
+  } else {
+    if (uv_mutex_init(&mutex))
+      return 1;
+    if (uv_async_init(&loop, &async_handle, async_cb))
+      return 1;
+  }
+
+  before = uv_hrtime();
+
+  for (i = 0; i < n; i++) {
+    producers[i].index = i;
+    producers[i].full = 0;
+    if (uv_thread_create(&producers[i].thread,
+                         use_channel ? channel_producer : async_producer,
+                         producers + i)) {
+      return 1;
+    }
+  }
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  full = 0;
+  for (i = 0; i < n; i++) {
+    if (uv_thread_join(&producers[i].thread))
+      return 1;
+    full += producers[i].full;
+  }
+
+  if (received != NUM_MSGS)
+    return 1;
+
+  if (!use_channel)
+    uv_mutex_destroy(&mutex);
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(NUM_MSGS / ((after - before) / 1e9),
+               "msgs/s",
+               "%s_%u_producers",
+               name,
+               n);
+  bench_report(full, "full sends", "%s_%u_producers_full", name, n);
+
+  return 0;
+}
+
+
+int main(void) {
+  unsigned int n;
+
+  messages = malloc(NUM_MSGS * sizeof(messages[0]));
+  if (messages == NULL)
+    return 1;
+
+  for (n = 1; n <= 4; n *= 2) {
+    if (run("async_mutex", n, 0))
+      return 1;
+    if (run("channel", n, 1))
+      return 1;
+  }
+
+  free(messages);
+
+  return 0;
+}
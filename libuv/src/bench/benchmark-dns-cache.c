@@ -0,0 +1,121 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Resolves "localhost" over and over with 64 lookups in flight, the way a
+ * connection pool would, first straight through the threadpool and then
+ * with the loop's DNS cache turned on.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_LOOKUPS (100 * 1000)
+#define CONCURRENCY 64
+
+static uv_getaddrinfo_t reqs[CONCURRENCY];
+static unsigned int started;
+static unsigned int done;
+
+
+static void getaddrinfo_cb(uv_getaddrinfo_t* req,
+                           int status,
+                           struct addrinfo* res) {
+  if (status != 0)
+    abort();
+
+  uv_freeaddrinfo(res);
+  done++;
+
+  if (started == NUM_LOOKUPS)
+    return;
+
+  started++;
+  if (uv_getaddrinfo(req->loop, req, getaddrinfo_cb, "localhost", NULL, NULL))
+    abort();
+}
+
+
+static int run(const char* name, unsigned int ttl) {
+  uv_dns_cache_stats_t stats;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_loop_set_dns_cache(&loop, ttl, 0, 0))
+    return 1;
+
+  started = 0;
+  done = 0;
+  before = uv_hrtime();
+
+  for (i = 0; i < CONCURRENCY; i++) {
+    started++;
+    if (uv_getaddrinfo(&loop,
+                       reqs + i,
+                       getaddrinfo_cb,
+                       "localhost",
+                       NULL,
+                       NULL)) {
+      return 1;
+    }
+  }
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (done != NUM_LOOKUPS)
+    return 1;
+
+  if (uv_dns_cache_stats(&loop, &stats))
+    return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(NUM_LOOKUPS / ((after - before) / 1e9),
+               "lookups/s",
+               "dns_%s",
+               name);
+  bench_report(stats.hits, "lookups", "dns_%s_hits", name);
+  bench_report(stats.misses, "lookups", "dns_%s_misses", name);
+  bench_report(stats.coalesced, "lookups", "dns_%s_coalesced", name);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run("uncached", 0))
+    return 1;
+
+  if (run("cached", 1000))
+    return 1;
+
+  return 0;
+}
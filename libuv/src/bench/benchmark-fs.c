@@ -0,0 +1,161 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Writes and reads a 64 MB file in 4 kB blocks, then stats it, with 16
+ * requests in flight on the threadpool. The reads come from the page cache,
+ * so this is about the cost of the requests rather than the disk.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BLOCK_SIZE 4096
+#define NUM_BLOCKS (16 * 1024)
+#define NUM_STATS (200 * 1000)
+#define CONCURRENCY 16
+
+enum fs_op {
+  FS_WRITE,
+  FS_READ,
+  FS_STAT
+};
+
+static uv_loop_t* loop;
+static uv_fs_t reqs[CONCURRENCY];
+static char bufs[CONCURRENCY][BLOCK_SIZE];
+static char path[64];
+static enum fs_op op;
+static uv_file fd;
+static unsigned int total;
+static unsigned int started;
+static unsigned int done;
+
+
+static void fs_cb(uv_fs_t* req);
+
+
+static void start(uv_fs_t* req) {
+  unsigned int i;
+  int64_t offset;
+  uv_buf_t buf;
+  int err;
+
+  i = req - reqs;
+  offset = (int64_t) started * BLOCK_SIZE;
+  buf = uv_buf_init(bufs[i], BLOCK_SIZE);
+  started++;
+
+  switch (op) {
+  case FS_WRITE:
+    err = uv_fs_write(loop, req, fd, &buf, 1, offset, fs_cb);
+    break;
+  case FS_READ:
+    err = uv_fs_read(loop, req, fd, &buf, 1, offset, fs_cb);
+    break;
+  default:
+    err = uv_fs_stat(loop, req, path, fs_cb);
+    break;
+  }
+
+  if (err)
+    abort();
+}
+
+
+static void fs_cb(uv_fs_t* req) {
+  if (req->result < 0)
+    abort();
+
+  if (op != FS_STAT && req->result != BLOCK_SIZE)
+    abort();
+
+  uv_fs_req_cleanup(req);
+  done++;
+
+  if (started < total)
+    start(req);
+}
+
+
+static int run(const char* name, enum fs_op fs_op, unsigned int n) {
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+  double secs;
+
+  op = fs_op;
+  total = n;
+  started = 0;
+  done = 0;
+  before = uv_hrtime();
+
+  for (i = 0; i < CONCURRENCY; i++)
+    start(reqs + i);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (done != total)
+    return 1;
+
+  secs = (after - before) / 1e9;
+  bench_report(total / secs, "ops/s", "%s", name);
+  if (op != FS_STAT)
+    bench_report((double) total * BLOCK_SIZE / secs / (1024 * 1024),
+                 "MB/s",
+                 "%s_throughput",
+                 name);
+
+  return 0;
+}
+
+
+int main(void) {
+  uv_fs_t req;
+  int r;
+
+  loop = uv_default_loop();
+  sprintf(path, "/tmp/uv-benchmark-fs-%d", (int) getpid());
+
+  fd = uv_fs_open(loop, &req, path, O_RDWR | O_CREAT | O_TRUNC, 0600, NULL);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0)
+    return 1;
+
+  r = run("fs_write_4k", FS_WRITE, NUM_BLOCKS) ||
+      run("fs_read_4k", FS_READ, NUM_BLOCKS) ||
+      run("fs_stat", FS_STAT, NUM_STATS);
+
+  uv_fs_close(loop, &req, fd, NULL);
+  uv_fs_req_cleanup(&req);
+  uv_fs_unlink(loop, &req, path, NULL);
+  uv_fs_req_cleanup(&req);
+
+  if (r)
+    return 1;
+
+  return uv_loop_close(loop) != 0;
+}
@@ -0,0 +1,425 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Measures how connection accept and echo throughput scale with the number
+ * of loops in a uv_loop_group_t. Every server loop listens on the same port
+ * with UV_TCP_REUSEPORT. The clients run on a second group of equal size.
+ *
+ * Usage: benchmark-loop-group [max_loops], defaults to the number of CPUs.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DURATION 1000   /* ms */
+#define CONNS 8         /* Client connections per client loop. */
+#define MSGLEN 64
+
+typedef struct {
+  uv_tcp_t handle;
+  char buf[MSGLEN];
+} server_conn_t;
+
+typedef struct {
+  uv_tcp_t listener;
+  uint64_t count;
+  server_conn_t* conns[CONNS * 64];
+  unsigned int nconns;
+} server_loop_t;
+
+typedef struct {
+  uv_tcp_t handle;
+  uv_connect_t connect_req;
+  char buf[MSGLEN];
+  unsigned int nread;
+  struct client_loop_s* client;
+} client_conn_t;
+
+typedef struct client_loop_s {
+  client_conn_t conns[CONNS];
+  uint64_t count;
+  int stopping;
+} client_loop_t;
+
+static struct sockaddr_in addr;
+static server_loop_t* servers;
+static client_loop_t* clients;
+static int echo;
+
+
+static void server_close_cb(uv_handle_t* handle) {
+  free(handle);
+}
+
+
+/* The next message can arrive before the write callback of the previous one
+ * ran, every write gets a request of its own.
+ */
+static void write_cb(uv_write_t* req, int status) {
+  free(req);
+}
+
+
+static void write_msg(uv_stream_t* stream, char* base, size_t len) {
+  uv_write_t* req;
+  uv_buf_t buf;
+
+  req = malloc(sizeof(*req));
+  if (req == NULL)
+    abort();
+
+  buf = uv_buf_init(base, len);
+  if (uv_write(req, stream, &buf, 1, write_cb))
+    abort();
+}
+
+
+static void server_alloc_cb(uv_handle_t* handle,
+                            size_t suggested_size,
+                            uv_buf_t* buf) {
+  server_conn_t* conn = (server_conn_t*) handle;
+  buf->base = conn->buf;
+  buf->len = sizeof(conn->buf);
+}
+
+
+static void server_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  server_conn_t* conn = (server_conn_t*) stream;
+
+  /* Closed later on by server_close_conns(). */
+  if (nread < 0)
+    uv_read_stop(stream);
+  else if (nread > 0)
+    write_msg(stream, conn->buf, nread);
+}
+
+
+static void connection_cb(uv_stream_t* listener, int status) {
+  server_loop_t* server = listener->data;
+  server_conn_t* conn;
+
+  if (status)
+    return;
+
+  conn = malloc(sizeof(*conn));
+  if (conn == NULL)
+    abort();
+
+  if (uv_tcp_init(listener->loop, &conn->handle))
+    abort();
+
+  if (uv_accept(listener, (uv_stream_t*) &conn->handle))
+    abort();
+
+  server->count++;
+
+  if (!echo || server->nconns == sizeof(server->conns) / sizeof(conn)) {
+    uv_close((uv_handle_t*) &conn->handle, server_close_cb);
+    return;
+  }
+
+  server->conns[server->nconns++] = conn;
+  if (uv_read_start((uv_stream_t*) &conn->handle,
+                    server_alloc_cb,
+                    server_read_cb)) {
+    abort();
+  }
+}
+
+
+static void server_start_cb(uv_loop_t* loop, unsigned int index, void* arg) {
+  server_loop_t* server = servers + index;
+
+  if (uv_tcp_init(loop, &server->listener))
+    abort();
+
+  server->listener.data = server;
+
+  if (uv_tcp_bind(&server->listener,
+                  (const struct sockaddr*) &addr,
+                  UV_TCP_REUSEPORT)) {
+    abort();
+  }
+
+  if (uv_listen((uv_stream_t*) &server->listener, 511, connection_cb))
+    abort();
+}
+
+
+/* Runs on the server loop before the group stops, the connections need their
+ * close callback to be freed.
+ */
+static void server_close_conns(uv_loop_t* loop, unsigned int index, void* arg) {
+  server_loop_t* server = servers + index;
+  unsigned int i;
+
+  for (i = 0; i < server->nconns; i++)
+    uv_close((uv_handle_t*) &server->conns[i]->handle, server_close_cb);
+
+  server->nconns = 0;
+}
+
+
+static void client_connect(client_conn_t* conn, uv_loop_t* loop);
+
+
+static void client_close_cb(uv_handle_t* handle) {
+  client_conn_t* conn = (client_conn_t*) handle;
+
+  if (!conn->client->stopping)
+    client_connect(conn, handle->loop);
+}
+
+
+/* Runs on the client loop before the group stops, so that connections that
+ * are closing don't start new ones.
+ */
+static void client_stop(uv_loop_t* loop, unsigned int index, void* arg) {
+  clients[index].stopping = 1;
+}
+
+
+static void client_alloc_cb(uv_handle_t* handle,
+                            size_t suggested_size,
+                            uv_buf_t* buf) {
+  client_conn_t* conn = (client_conn_t*) handle;
+  buf->base = conn->buf + conn->nread;
+  buf->len = sizeof(conn->buf) - conn->nread;
+}
+
+
+static void client_send(client_conn_t* conn) {
+  write_msg((uv_stream_t*) &conn->handle, conn->buf, sizeof(conn->buf));
+}
+
+
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  client_conn_t* conn = (client_conn_t*) stream;
+
+  if (nread < 0) {
+    /* Accept mode, the server closed the connection. */
+    uv_close((uv_handle_t*) stream, client_close_cb);
+    return;
+  }
+
+  conn->nread += nread;
+  if (conn->nread < sizeof(conn->buf))
+    return;
+
+  conn->nread = 0;
+  conn->client->count++;
+  client_send(conn);
+}
+
+
+static void client_connect_cb(uv_connect_t* req, int status) {
+  client_conn_t* conn = req->data;
+
+  if (status) {
+    if (status != UV_ECANCELED)
+      uv_close((uv_handle_t*) &conn->handle, client_close_cb);
+    return;
+  }
+
+  if (!echo)
+    conn->client->count++;
+
+  conn->nread = 0;
+  if (uv_read_start((uv_stream_t*) &conn->handle,
+                    client_alloc_cb,
+                    client_read_cb)) {
+    abort();
+  }
+
+  if (echo)
+    client_send(conn);
+}
+
+
+static void client_connect(client_conn_t* conn, uv_loop_t* loop) {
+  if (uv_tcp_init(loop, &conn->handle))
+    abort();
+
+  conn->connect_req.data = conn;
+  if (uv_tcp_connect(&conn->connect_req,
+                     &conn->handle,
+                     (const struct sockaddr*) &addr,
+                     client_connect_cb)) {
+    abort();
+  }
+}
+
+
+static void client_start_cb(uv_loop_t* loop, unsigned int index, void* arg) {
+  client_loop_t* client = clients + index;
+  unsigned int i;
+
+  for (i = 0; i < CONNS; i++) {
+    client->conns[i].client = client;
+    memset(client->conns[i].buf, 'x', sizeof(client->conns[i].buf));
+    client_connect(client->conns + i, loop);
+  }
+}
+
+
+static void sleep_cb(uv_timer_t* handle) {
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void sleep_ms(unsigned int ms) {
+  uv_timer_t timer;
+  uv_loop_t loop;
+
+  if (uv_loop_init(&loop))
+    abort();
+
+  if (uv_timer_init(&loop, &timer))
+    abort();
+
+  if (uv_timer_start(&timer, sleep_cb, ms, 0))
+    abort();
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  if (uv_loop_close(&loop))
+    abort();
+}
+
+
+static void run(unsigned int nloops) {
+  uv_loop_group_t server_group;
+  uv_loop_group_t client_group;
+  uint64_t start;
+  uint64_t total;
+  double secs;
+  unsigned int i;
+
+  servers = calloc(nloops, sizeof(*servers));
+  clients = calloc(nloops, sizeof(*clients));
+  if (servers == NULL || clients == NULL)
+    abort();
+
+  if (uv_loop_group_init(&server_group, nloops))
+    abort();
+
+  if (uv_loop_group_init(&client_group, nloops))
+    abort();
+
+  if (uv_loop_group_start(&server_group, server_start_cb, NULL))
+    abort();
+
+  /* Give the listeners a moment to come up. */
+  sleep_ms(50);
+
+  start = uv_hrtime();
+  if (uv_loop_group_start(&client_group, client_start_cb, NULL))
+    abort();
+
+  sleep_ms(DURATION);
+
+  for (i = 0; i < nloops; i++)
+    if (uv_loop_group_post(&client_group, i, client_stop, NULL))
+      abort();
+
+  if (uv_loop_group_stop(&client_group))
+    abort();
+
+  secs = (uv_hrtime() - start) / 1e9;
+
+  for (i = 0; i < nloops; i++)
+    if (uv_loop_group_post(&server_group, i, server_close_conns, NULL))
+      abort();
+
+  if (uv_loop_group_stop(&server_group))
+    abort();
+
+  total = 0;
+  for (i = 0; i < nloops; i++)
+    total += clients[i].count;
+
+  bench_report(total / secs,
+               echo ? "req/s" : "conn/s",
+               "loop_group_%s_%u",
+               echo ? "echo" : "accept",
+               nloops);
+
+  free(servers);
+  free(clients);
+}
+
+
+int main(int argc, char** argv) {
+  uv_cpu_info_t* cpu_infos;
+  unsigned int max_loops;
+  unsigned int n;
+  uv_tcp_t probe;
+  int namelen;
+  int count;
+
+  if (argc > 1) {
+    max_loops = atoi(argv[1]);
+  } else {
+    if (uv_cpu_info(&cpu_infos, &count))
+      return 1;
+    uv_free_cpu_info(cpu_infos, count);
+    max_loops = count;
+  }
+
+  if (max_loops < 1)
+    max_loops = 1;
+
+  /* Find a free port. The probe socket stays bound but doesn't listen so
+   * it doesn't take part in load balancing.
+   */
+  if (uv_ip4_addr("127.0.0.1", 0, &addr))
+    return 1;
+
+  if (uv_tcp_init(uv_default_loop(), &probe))
+    return 1;
+
+  if (uv_tcp_bind(&probe, (const struct sockaddr*) &addr, UV_TCP_REUSEPORT))
+    return 1;
+
+  namelen = sizeof(addr);
+  if (uv_tcp_getsockname(&probe, (struct sockaddr*) &addr, &namelen))
+    return 1;
+
+  for (echo = 0; echo < 2; echo++) {
+    for (n = 1; n < max_loops; n *= 2)
+      run(n);
+    run(max_loops);
+  }
+
+  uv_close((uv_handle_t*) &probe, NULL);
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Loop iterations and threadpool round trips with metrics off and on. The
+ * iterations come from an idle handle so every one of them polls without
+ * blocking, which is as close to measuring the bookkeeping alone as it gets.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_ITERATIONS (2 * 1000 * 1000)
+#define NUM_WORK (200 * 1000)
+
+static unsigned int iterations;
+static unsigned int work_started;
+static unsigned int work_done;
+
+
+static void idle_cb(uv_idle_t* handle) {
+  if (++iterations == NUM_ITERATIONS)
+    uv_idle_stop(handle);
+}
+
+
+static void work_cb(uv_work_t* req) {
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  if (status != 0)
+    abort();
+
+  work_done++;
+  if (work_started == NUM_WORK)
+    return;
+
+  work_started++;
+  if (uv_queue_work(req->loop, req, work_cb, after_work_cb))
+    abort();
+}
+
+
+static int run(int enable) {
+  uv_work_t reqs[8];
+  uv_idle_t idle;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_loop_set_metrics(&loop, enable))
+    return 1;
+
+  if (uv_idle_init(&loop, &idle))
+    return 1;
+
+  iterations = 0;
+  if (uv_idle_start(&idle, idle_cb))
+    return 1;
+
+  before = uv_hrtime();
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  bench_report((double) (after - before) / NUM_ITERATIONS,
+               "ns/iteration",
+               "metrics_%s_iteration",
+               enable ? "on" : "off");
+
+  work_started = 0;
+  work_done = 0;
+  for (i = 0; i < sizeof(reqs) / sizeof(reqs[0]); i++) {
+    work_started++;
+    if (uv_queue_work(&loop, reqs + i, work_cb, after_work_cb))
+      return 1;
+  }
+
+  before = uv_hrtime();
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (work_done != NUM_WORK)
+    return 1;
+
+  bench_report(NUM_WORK / ((after - before) / 1e9),
+               "work/s",
+               "metrics_%s_work",
+               enable ? "on" : "off");
+
+  uv_close((uv_handle_t*) &idle, NULL);
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  return uv_loop_close(&loop) != 0;
+}
+
+
+int main(void) {
+  if (run(0))
+    return 1;
+
+  if (run(1))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Starts, restarts and expires one million timers, first with the timer
+ * heap and then with the timer wheel.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TIMERS (1000 * 1000)
+
+static int timer_cb_called;
+static int close_cb_called;
+
+
+static void timer_cb(uv_timer_t* handle) {
+  timer_cb_called++;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static int run(const char* name, int wheel) {
+  uv_timer_t* timers;
+  uv_loop_t loop;
+  uint64_t before_start;
+  uint64_t before_restart;
+  uint64_t before_run;
+  uint64_t before_close;
+  uint64_t after;
+  int i;
+
+  timers = malloc(NUM_TIMERS * sizeof(timers[0]));
+  if (timers == NULL)
+    return 1;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_loop_set_timer_wheel(&loop, wheel))
+    return 1;
+
+  timer_cb_called = 0;
+  close_cb_called = 0;
+
+  /* Spread the timeouts over one second, like idle timeouts of connections
+   * that were accepted at different times.
+   */
+  before_start = uv_hrtime();
+  for (i = 0; i < NUM_TIMERS; i++) {
+    uv_timer_init(&loop, timers + i);
+    uv_timer_start(timers + i, timer_cb, 1 + i / 1000, 0);
+  }
+
+  /* Every connection saw traffic, push its idle timeout back. */
+  before_restart = uv_hrtime();
+  for (i = 0; i < NUM_TIMERS; i++)
+    uv_timer_start(timers + i, timer_cb, 1 + i / 1000, 0);
+
+  before_run = uv_hrtime();
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  before_close = uv_hrtime();
+  for (i = 0; i < NUM_TIMERS; i++)
+    uv_close((uv_handle_t*) (timers + i), close_cb);
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (timer_cb_called != NUM_TIMERS || close_cb_called != NUM_TIMERS)
+    return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  free(timers);
+
+  bench_report((after - before_start) / 1e9, "s", "%s_total", name);
+  bench_report((double) (before_restart - before_start) / NUM_TIMERS,
+               "ns/start",
+               "%s_start",
+               name);
+  bench_report((double) (before_run - before_restart) / NUM_TIMERS,
+               "ns/restart",
+               "%s_restart",
+               name);
+  /* Includes waiting for the timeouts. */
+  bench_report((before_close - before_run) / 1e9, "s", "%s_run", name);
+  bench_report((after - before_close) / 1e9, "s", "%s_close", name);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run("million_timers_heap", 0))
+    return 1;
+
+  if (run("million_timers_wheel", 1))
+    return 1;
+
+  return 0;
+}
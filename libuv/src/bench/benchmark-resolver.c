@@ -0,0 +1,230 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Resolves A records through a uv_resolver_t with 1, 64 and 1024 lookups in
+ * flight, and with all of them started at once. The name server is a stand-in
+ * on the loopback interface that runs its own loop in another thread and
+ * answers every query with a single record.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_LOOKUPS (100 * 1000)
+
+static uv_loop_t server_loop;
+static uv_udp_t server_handle;
+static uv_async_t server_stop;
+static struct sockaddr_in server_addr;
+static char server_buf[512];
+
+static uv_resolve_t* reqs;
+static unsigned int started;
+static unsigned int done;
+
+
+static void server_alloc_cb(uv_handle_t* handle,
+                            size_t suggested_size,
+                            uv_buf_t* buf) {
+  *buf = uv_buf_init(server_buf, sizeof(server_buf));
+}
+
+
+static void server_recv_cb(uv_udp_t* handle,
+                           ssize_t nread,
+                           const uv_buf_t* buf,
+                           const struct sockaddr* addr,
+                           unsigned int flags) {
+  static const unsigned char record[] = {
+    0xC0, 12,        /* Pointer to the name in the question. */
+    0, 1, 0, 1,      /* A, IN */
+    0, 0, 1, 44,     /* TTL */
+    0, 4, 127, 0, 0, 1
+  };
+  unsigned char* msg;
+  uv_buf_t reply;
+
+  if (nread < 12 || addr == NULL || nread + sizeof(record) > sizeof(server_buf))
+    return;
+
+  msg = (unsigned char*) buf->base;
+  msg[2] = 0x81;  /* QR, RD */
+  msg[3] = 0x80;  /* RA, NOERROR */
+  msg[7] = 1;     /* ANCOUNT */
+  memcpy(msg + nread, record, sizeof(record));
+
+  reply = uv_buf_init(buf->base, nread + sizeof(record));
+  uv_udp_try_send(handle, &reply, 1, addr);
+}
+
+
+static void server_stop_cb(uv_async_t* handle) {
+  uv_close((uv_handle_t*) &server_handle, NULL);
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void server_run(void* arg) {
+  uv_run(&server_loop, UV_RUN_DEFAULT);
+}
+
+
+static int server_start(uv_thread_t* thread) {
+  struct sockaddr_in addr;
+  int namelen;
+  int size;
+
+  if (uv_loop_init(&server_loop))
+    return 1;
+
+  if (uv_ip4_addr("127.0.0.1", 0, &addr))
+    return 1;
+
+  if (uv_udp_init(&server_loop, &server_handle))
+    return 1;
+
+  if (uv_udp_bind(&server_handle, (const struct sockaddr*) &addr, 0))
+    return 1;
+
+  namelen = sizeof(server_addr);
+  if (uv_udp_getsockname(&server_handle,
+                         (struct sockaddr*) &server_addr,
+                         &namelen)) {
+    return 1;
+  }
+
+  size = 4 << 20;
+  uv_recv_buffer_size((uv_handle_t*) &server_handle, &size);
+
+  if (uv_udp_recv_start(&server_handle, server_alloc_cb, server_recv_cb))
+    return 1;
+
+  if (uv_async_init(&server_loop, &server_stop, server_stop_cb))
+    return 1;
+
+  return uv_thread_create(thread, server_run, NULL);
+}
+
+
+static void resolve_cb(uv_resolve_t* req,
+                       int status,
+                       const uv_dns_record_t* records,
+                       unsigned int nrecords) {
+  if (status != 0 || nrecords != 1)
+    abort();
+
+  done++;
+
+  if (started == NUM_LOOKUPS)
+    return;
+
+  started++;
+  if (uv_resolve(req->resolver, req, "bench.test.", UV_DNS_A, resolve_cb))
+    abort();
+}
+
+
+static int run(const char* name, unsigned int concurrency) {
+  const struct sockaddr* addrs[1];
+  uv_resolver_t resolver;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_resolver_init(&loop, &resolver))
+    return 1;
+
+  addrs[0] = (const struct sockaddr*) &server_addr;
+  if (uv_resolver_set_servers(&resolver, addrs, 1))
+    return 1;
+
+  started = 0;
+  done = 0;
+  before = uv_hrtime();
+
+  for (i = 0; i < concurrency; i++) {
+    started++;
+    if (uv_resolve(&resolver, reqs + i, "bench.test.", UV_DNS_A, resolve_cb))
+      return 1;
+  }
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (done != NUM_LOOKUPS)
+    return 1;
+
+  uv_close((uv_handle_t*) &resolver, NULL);
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(NUM_LOOKUPS / ((after - before) / 1e9),
+               "lookups/s",
+               "resolver_%s",
+               name);
+
+  return 0;
+}
+
+
+int main(void) {
+  uv_thread_t thread;
+
+  reqs = malloc(NUM_LOOKUPS * sizeof(reqs[0]));
+  if (reqs == NULL)
+    return 1;
+
+  if (server_start(&thread))
+    return 1;
+
+  if (run("1_in_flight", 1))
+    return 1;
+
+  if (run("64_in_flight", 64))
+    return 1;
+
+  if (run("1024_in_flight", 1024))
+    return 1;
+
+  if (run("all_at_once", NUM_LOOKUPS))
+    return 1;
+
+  uv_async_send(&server_stop);
+  if (uv_thread_join(&thread))
+    return 1;
+
+  if (uv_loop_close(&server_loop))
+    return 1;
+
+  free(reqs);
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Spawns /bin/true back to back from a process with 0, 256 MB and 1 GB of
+ * resident heap. Asking for UV_PROCESS_SETUID with our own uid forces the
+ * fork() path; without it uv_spawn() uses posix_spawn() where available.
+ * fork() has to copy the page tables so its cost grows with RSS, the
+ * posix_spawn() path shouldn't.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_SPAWNS 200
+
+static uv_process_options_t options;
+static unsigned int spawned;
+static uint64_t spawn_time;
+
+
+static void exit_cb(uv_process_t* process, int64_t status, int term_signal);
+
+
+static int spawn_one(uv_loop_t* loop) {
+  uv_process_t* process;
+  uint64_t before;
+
+  process = malloc(sizeof(*process));
+  if (process == NULL)
+    return 1;
+
+  before = uv_hrtime();
+  if (uv_spawn(loop, process, &options))
+    return 1;
+  spawn_time += uv_hrtime() - before;
+  spawned++;
+
+  return 0;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  free(handle);
+}
+
+
+static void exit_cb(uv_process_t* process, int64_t status, int term_signal) {
+  if (status != 0 || term_signal != 0)
+    abort();
+
+  uv_close((uv_handle_t*) process, close_cb);
+
+  if (spawned < NUM_SPAWNS)
+    if (spawn_one(process->loop))
+      abort();
+}
+
+
+static int run(const char* name, size_t rss_mb, unsigned int flags) {
+  char* args[2];
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  args[0] = "/bin/true";
+  args[1] = NULL;
+
+  memset(&options, 0, sizeof(options));
+  options.file = args[0];
+  options.args = args;
+  options.flags = flags;
+  options.uid = getuid();
+  options.exit_cb = exit_cb;
+
+  spawned = 0;
+  spawn_time = 0;
+
+  before = uv_hrtime();
+  if (spawn_one(&loop))
+    return 1;
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(spawn_time / 1e3 / NUM_SPAWNS,
+               "us/uv_spawn",
+               "spawn_%s_%lumb_rss_uv_spawn",
+               name,
+               (unsigned long) rss_mb);
+  bench_report(NUM_SPAWNS / ((after - before) / 1e9),
+               "spawns/s",
+               "spawn_%s_%lumb_rss",
+               name,
+               (unsigned long) rss_mb);
+
+  return 0;
+}
+
+
+int main(void) {
+  static const size_t sizes[] = { 0, 256, 1024 };
+  char* heap;
+  size_t i;
+
+  heap = NULL;
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    free(heap);
+    heap = NULL;
+
+    if (sizes[i] > 0) {
+      heap = malloc(sizes[i] << 20);
+      if (heap == NULL)
+        return 1;
+      memset(heap, 1, sizes[i] << 20);  /* Fault it in. */
+    }
+
+    if (run("fork", sizes[i], UV_PROCESS_SETUID))
+      return 1;
+
+    if (run("default", sizes[i], 0))
+      return 1;
+  }
+
+  free(heap);
+
+  return 0;
+}
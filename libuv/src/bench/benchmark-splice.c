@@ -0,0 +1,330 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Pushes data from a client through a proxy to a sink over loopback TCP
+ * connections. The proxy forwards with uv_splice_start() in one run and with
+ * uv_read_start() plus uv_write() in the other.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOTAL (1024 * 1024 * 1024)  /* bytes */
+#define CHUNK (256 * 1024)
+#define INFLIGHT 8                  /* Client writes in flight. */
+#define HIGH_WATER (1024 * 1024)    /* Read+write proxy pauses reading. */
+
+typedef struct {
+  uv_write_t req;
+  char* base;
+} proxy_write_t;
+
+static uv_tcp_t sink_server;
+static uv_tcp_t sink_conn;
+static uv_tcp_t proxy_server;
+static uv_tcp_t proxy_in;
+static uv_tcp_t proxy_out;
+static uv_tcp_t client;
+static uv_connect_t client_req;
+static uv_connect_t proxy_req;
+static uv_write_t client_writes[INFLIGHT];
+static uv_splice_t splice_req;
+static struct sockaddr_in sink_addr;
+static char chunk[CHUNK];
+static char slab[65536];
+static size_t nsent;
+static size_t nreceived;
+static int use_splice;
+
+
+static void close_all(void) {
+  uv_close((uv_handle_t*) &sink_server, NULL);
+  uv_close((uv_handle_t*) &sink_conn, NULL);
+  uv_close((uv_handle_t*) &proxy_server, NULL);
+  uv_close((uv_handle_t*) &proxy_in, NULL);
+  uv_close((uv_handle_t*) &proxy_out, NULL);
+  uv_close((uv_handle_t*) &client, NULL);
+}
+
+
+static void sink_alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void sink_read_cb(uv_stream_t* stream, ssize_t n, const uv_buf_t* buf) {
+  if (n < 0)
+    abort();
+
+  nreceived += n;
+  if (nreceived == TOTAL)
+    close_all();
+}
+
+
+static void sink_connection_cb(uv_stream_t* server, int status) {
+  if (status)
+    abort();
+
+  if (uv_tcp_init(server->loop, &sink_conn))
+    abort();
+
+  if (uv_accept(server, (uv_stream_t*) &sink_conn))
+    abort();
+
+  if (uv_read_start((uv_stream_t*) &sink_conn, sink_alloc_cb, sink_read_cb))
+    abort();
+}
+
+
+static void splice_cb(uv_splice_t* req, int status) {
+  /* The sink closes everything once it has seen all data. */
+  if (status != 0 && status != UV_ECANCELED)
+    abort();
+}
+
+
+static void proxy_alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = malloc(size);
+  buf->len = buf->base == NULL ? 0 : size;
+}
+
+
+static void proxy_read_cb(uv_stream_t* stream, ssize_t n, const uv_buf_t* buf);
+
+
+static void proxy_write_cb(uv_write_t* req, int status) {
+  proxy_write_t* w;
+
+  w = (proxy_write_t*) req;
+  free(w->base);
+  free(w);
+
+  if (status == UV_ECANCELED)
+    return;
+
+  if (status)
+    abort();
+
+  /* Resume reading once the other side caught up. */
+  if (proxy_out.write_queue_size < HIGH_WATER / 2 &&
+      !uv_is_closing((uv_handle_t*) &proxy_in) &&
+      !uv_is_active((uv_handle_t*) &proxy_in)) {
+    uv_read_start((uv_stream_t*) &proxy_in, proxy_alloc_cb, proxy_read_cb);
+  }
+}
+
+
+static void proxy_read_cb(uv_stream_t* stream, ssize_t n, const uv_buf_t* buf) {
+  proxy_write_t* w;
+  uv_buf_t out;
+
+  if (n <= 0) {
+    free(buf->base);
+    if (n < 0 && n != UV_EOF)
+      abort();
+    return;
+  }
+
+  w = malloc(sizeof(*w));
+  if (w == NULL)
+    abort();
+
+  w->base = buf->base;
+  out = uv_buf_init(buf->base, n);
+  if (uv_write(&w->req, (uv_stream_t*) &proxy_out, &out, 1, proxy_write_cb))
+    abort();
+
+  if (proxy_out.write_queue_size > HIGH_WATER)
+    uv_read_stop(stream);
+}
+
+
+static void proxy_connect_cb(uv_connect_t* req, int status) {
+  if (status)
+    abort();
+
+  if (use_splice) {
+    if (uv_splice_start(&splice_req,
+                        (uv_stream_t*) &proxy_in,
+                        (uv_stream_t*) &proxy_out,
+                        splice_cb)) {
+      abort();
+    }
+  } else {
+    if (uv_read_start((uv_stream_t*) &proxy_in, proxy_alloc_cb, proxy_read_cb))
+      abort();
+  }
+}
+
+
+static void proxy_connection_cb(uv_stream_t* server, int status) {
+  if (status)
+    abort();
+
+  if (uv_tcp_init(server->loop, &proxy_in))
+    abort();
+
+  if (uv_accept(server, (uv_stream_t*) &proxy_in))
+    abort();
+
+  if (uv_tcp_init(server->loop, &proxy_out))
+    abort();
+
+  if (uv_tcp_connect(&proxy_req,
+                     &proxy_out,
+                     (const struct sockaddr*) &sink_addr,
+                     proxy_connect_cb)) {
+    abort();
+  }
+}
+
+
+static void client_write_cb(uv_write_t* req, int status) {
+  uv_buf_t buf;
+
+  if (status == UV_ECANCELED)
+    return;
+
+  if (status)
+    abort();
+
+  if (nsent == TOTAL)
+    return;
+
+  buf = uv_buf_init(chunk, sizeof(chunk));
+  if (uv_write(req, (uv_stream_t*) &client, &buf, 1, client_write_cb))
+    abort();
+
+  nsent += sizeof(chunk);
+}
+
+
+static void client_connect_cb(uv_connect_t* req, int status) {
+  int i;
+
+  if (status)
+    abort();
+
+  for (i = 0; i < INFLIGHT; i++)
+    client_write_cb(client_writes + i, 0);
+}
+
+
+static int listen_on(uv_loop_t* loop,
+                     uv_tcp_t* server,
+                     struct sockaddr_in* addr,
+                     uv_connection_cb cb) {
+  int namelen;
+
+  if (uv_ip4_addr("127.0.0.1", 0, addr))
+    return 1;
+
+  if (uv_tcp_init(loop, server))
+    return 1;
+
+  if (uv_tcp_bind(server, (const struct sockaddr*) addr, 0))
+    return 1;
+
+  if (uv_listen((uv_stream_t*) server, 1, cb))
+    return 1;
+
+  namelen = sizeof(*addr);
+  if (uv_tcp_getsockname(server, (struct sockaddr*) addr, &namelen))
+    return 1;
+
+  return 0;
+}
+
+
+static int run(const char* name, int splice) {
+  struct sockaddr_in proxy_addr;
+  uv_rusage_t before;
+  uv_rusage_t after;
+  uint64_t start;
+  uint64_t end;
+  uv_loop_t loop;
+  double cpu;
+  double secs;
+
+  use_splice = splice;
+  nsent = 0;
+  nreceived = 0;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (listen_on(&loop, &sink_server, &sink_addr, sink_connection_cb))
+    return 1;
+
+  if (listen_on(&loop, &proxy_server, &proxy_addr, proxy_connection_cb))
+    return 1;
+
+  if (uv_tcp_init(&loop, &client))
+    return 1;
+
+  if (uv_tcp_connect(&client_req,
+                     &client,
+                     (const struct sockaddr*) &proxy_addr,
+                     client_connect_cb)) {
+    return 1;
+  }
+
+  uv_getrusage(&before);
+  start = uv_hrtime();
+  uv_run(&loop, UV_RUN_DEFAULT);
+  end = uv_hrtime();
+  uv_getrusage(&after);
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  if (nreceived != TOTAL)
+    return 1;
+
+  secs = (end - start) / 1e9;
+  cpu = (after.ru_utime.tv_sec - before.ru_utime.tv_sec) +
+        (after.ru_stime.tv_sec - before.ru_stime.tv_sec) +
+        (after.ru_utime.tv_usec - before.ru_utime.tv_usec) / 1e6 +
+        (after.ru_stime.tv_usec - before.ru_stime.tv_usec) / 1e6;
+
+  bench_report(TOTAL / secs / (1024 * 1024), "MB/s", "%s", name);
+  bench_report(cpu, "cpu s", "%s_cpu", name);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run("splice_proxy_read_write", 0))
+    return 1;
+
+  if (run("splice_proxy_splice", 1))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,290 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Ping-pong and pump over a TCP connection on the loopback interface and over
+ * a unix domain socket, both ends on the same loop. Ping-pong bounces a small
+ * message back and forth, pump writes 64 kB chunks as fast as the other end
+ * reads them.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_PINGS (100 * 1000)
+#define PUMP_TOTAL (1024 * 1024 * 1024)
+#define PUMP_CHUNK (64 * 1024)
+#define PUMP_WINDOW 8  /* Write requests in flight. */
+
+union stream_handle {
+  uv_stream_t stream;
+  uv_tcp_t tcp;
+  uv_pipe_t pipe;
+};
+
+static uv_loop_t* loop;
+static union stream_handle server;
+static union stream_handle client;
+static union stream_handle peer;
+static uv_connect_t connect_req;
+static uv_write_t write_reqs[PUMP_WINDOW];
+static char pump_buf[PUMP_CHUNK];
+static char read_buf[PUMP_CHUNK];
+static char pipe_name[64];
+static int use_pipe;
+static int pump;
+
+static unsigned int pings;
+static unsigned int pong_bytes;
+static unsigned long written;
+static unsigned long nread_total;
+
+
+static int stream_init(union stream_handle* handle) {
+  if (use_pipe)
+    return uv_pipe_init(loop, &handle->pipe, 0);
+
+  return uv_tcp_init(loop, &handle->tcp);
+}
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  *buf = uv_buf_init(read_buf, sizeof(read_buf));
+}
+
+
+static void finish(void) {
+  uv_close((uv_handle_t*) &server, NULL);
+  uv_close((uv_handle_t*) &client, NULL);
+  uv_close((uv_handle_t*) &peer, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  if (status != 0 && status != UV_ECANCELED)
+    abort();
+
+  free(req);
+}
+
+
+static void write_copy(uv_stream_t* stream, char* base, size_t len) {
+  uv_write_t* req;
+  uv_buf_t buf;
+
+  req = malloc(sizeof(*req));
+  if (req == NULL)
+    abort();
+
+  buf = uv_buf_init(base, len);
+  if (uv_write(req, stream, &buf, 1, write_cb))
+    abort();
+}
+
+
+/* The client counts a round trip for every 4 bytes that come back. */
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  if (nread < 0)
+    abort();
+
+  pong_bytes += nread;
+  while (pong_bytes >= 4) {
+    pong_bytes -= 4;
+    if (++pings == NUM_PINGS) {
+      finish();
+      return;
+    }
+    write_copy(stream, "PING", 4);
+  }
+}
+
+
+static void peer_read_cb(uv_stream_t* stream,
+                         ssize_t nread,
+                         const uv_buf_t* buf) {
+  if (nread == UV_EOF || nread == UV_ECANCELED)
+    return;
+
+  if (nread < 0)
+    abort();
+
+  if (pump) {
+    nread_total += nread;
+    if (nread_total == PUMP_TOTAL)
+      finish();
+    return;
+  }
+
+  write_copy(stream, buf->base, nread);
+}
+
+
+static void pump_write_cb(uv_write_t* req, int status);
+
+
+static void pump_write(uv_stream_t* stream, uv_write_t* req) {
+  uv_buf_t buf;
+
+  written += sizeof(pump_buf);
+  buf = uv_buf_init(pump_buf, sizeof(pump_buf));
+  if (uv_write(req, stream, &buf, 1, pump_write_cb))
+    abort();
+}
+
+
+static void pump_write_cb(uv_write_t* req, int status) {
+  if (status == UV_ECANCELED)
+    return;
+
+  if (status != 0)
+    abort();
+
+  if (written < PUMP_TOTAL)
+    pump_write(req->handle, req);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  unsigned int i;
+
+  if (status != 0)
+    abort();
+
+  if (pump == 0) {
+    if (uv_read_start(req->handle, alloc_cb, client_read_cb))
+      abort();
+    write_copy(req->handle, "PING", 4);
+    return;
+  }
+
+  for (i = 0; i < PUMP_WINDOW; i++)
+    pump_write(req->handle, write_reqs + i);
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  if (status != 0)
+    abort();
+
+  if (stream_init(&peer))
+    abort();
+
+  if (uv_accept(stream, &peer.stream))
+    abort();
+
+  if (use_pipe == 0)
+    uv_tcp_nodelay(&peer.tcp, 1);
+
+  if (uv_read_start(&peer.stream, alloc_cb, peer_read_cb))
+    abort();
+}
+
+
+static int run(const char* name, int pipe, int pump_mode) {
+  struct sockaddr_in addr;
+  uint64_t before;
+  uint64_t after;
+  double secs;
+  int namelen;
+
+  use_pipe = pipe;
+  pump = pump_mode;
+  pings = 0;
+  pong_bytes = 0;
+  written = 0;
+  nread_total = 0;
+
+  if (stream_init(&server) || stream_init(&client))
+    return 1;
+
+  if (use_pipe) {
+    unlink(pipe_name);
+    if (uv_pipe_bind(&server.pipe, pipe_name))
+      return 1;
+  } else {
+    if (uv_ip4_addr("127.0.0.1", 0, &addr))
+      return 1;
+    if (uv_tcp_bind(&server.tcp, (const struct sockaddr*) &addr, 0))
+      return 1;
+    namelen = sizeof(addr);
+    if (uv_tcp_getsockname(&server.tcp, (struct sockaddr*) &addr, &namelen))
+      return 1;
+  }
+
+  if (uv_listen(&server.stream, 128, connection_cb))
+    return 1;
+
+  before = uv_hrtime();
+
+  if (use_pipe) {
+    uv_pipe_connect(&connect_req, &client.pipe, pipe_name, connect_cb);
+  } else {
+    uv_tcp_nodelay(&client.tcp, 1);
+    if (uv_tcp_connect(&connect_req,
+                       &client.tcp,
+                       (const struct sockaddr*) &addr,
+                       connect_cb)) {
+      return 1;
+    }
+  }
+
+  uv_run(loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (use_pipe)
+    unlink(pipe_name);
+
+  secs = (after - before) / 1e9;
+  if (pump)
+    bench_report(PUMP_TOTAL / secs / (1024 * 1024), "MB/s", "%s", name);
+  else
+    bench_report(NUM_PINGS / secs, "roundtrips/s", "%s", name);
+
+  return 0;
+}
+
+
+int main(void) {
+  loop = uv_default_loop();
+  sprintf(pipe_name, "/tmp/uv-benchmark-stream-%d.sock", (int) getpid());
+
+  if (run("tcp_pingpong", 0, 0))
+    return 1;
+
+  if (run("tcp_pump", 0, 1))
+    return 1;
+
+  if (run("pipe_pingpong", 1, 0))
+    return 1;
+
+  if (run("pipe_pump", 1, 1))
+    return 1;
+
+  return uv_loop_close(loop) != 0;
+}
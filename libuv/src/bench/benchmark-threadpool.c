@@ -0,0 +1,110 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Empty uv_queue_work() requests with 1, 64 and 1024 of them in flight. What's
+ * left is the cost of the queue, the wakeups and the done callbacks.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define NUM_WORK (500 * 1000)
+
+static uv_work_t* reqs;
+static unsigned int started;
+static unsigned int done;
+
+
+static void work_cb(uv_work_t* req) {
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  if (status != 0)
+    abort();
+
+  done++;
+  if (started == NUM_WORK)
+    return;
+
+  started++;
+  if (uv_queue_work(req->loop, req, work_cb, after_work_cb))
+    abort();
+}
+
+
+static int run(unsigned int concurrency) {
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  unsigned int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  started = 0;
+  done = 0;
+  before = uv_hrtime();
+
+  for (i = 0; i < concurrency; i++) {
+    started++;
+    if (uv_queue_work(&loop, reqs + i, work_cb, after_work_cb))
+      return 1;
+  }
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (done != NUM_WORK)
+    return 1;
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  bench_report(NUM_WORK / ((after - before) / 1e9),
+               "work/s",
+               "threadpool_%u_in_flight",
+               concurrency);
+
+  return 0;
+}
+
+
+int main(void) {
+  reqs = malloc(1024 * sizeof(reqs[0]));
+  if (reqs == NULL)
+    return 1;
+
+  if (run(1))
+    return 1;
+
+  if (run(64))
+    return 1;
+
+  if (run(1024))
+    return 1;
+
+  free(reqs);
+
+  return 0;
+}
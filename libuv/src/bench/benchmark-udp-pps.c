@@ -0,0 +1,181 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Blasts datagrams over the loopback interface for a few seconds, first
+ * from an unconnected handle that names the peer on every send and then
+ * from a handle that has been connected with uv_udp_connect().
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DURATION 2000  /* ms */
+#define WINDOW 64      /* Send requests in flight. */
+#define PAYLOAD 64     /* Bytes per datagram, think DNS query. */
+
+static uv_udp_t sender;
+static uv_udp_t receiver;
+static uv_timer_t timer;
+static uv_udp_send_t reqs[WINDOW];
+static struct sockaddr_in peer;
+static char payload[PAYLOAD];
+static char slab[65536];
+static const struct sockaddr* dest;
+static unsigned int send_cb_called;
+static unsigned int send_errors;
+static unsigned int recv_cb_called;
+static int stopping;
+
+
+static void send_cb(uv_udp_send_t* req, int status);
+
+
+static void do_send(uv_udp_send_t* req) {
+  uv_buf_t buf;
+
+  buf = uv_buf_init(payload, sizeof(payload));
+  if (uv_udp_send(req, &sender, &buf, 1, dest, send_cb))
+    abort();
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  if (status == 0)
+    send_cb_called++;
+  else if (status != UV_ECANCELED)
+    send_errors++;
+
+  if (!stopping)
+    do_send(req);
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  if (nread > 0)
+    recv_cb_called++;
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  stopping = 1;
+  uv_close((uv_handle_t*) &sender, NULL);
+  uv_close((uv_handle_t*) &receiver, NULL);
+  uv_close((uv_handle_t*) &timer, NULL);
+}
+
+
+static int run(const char* name, int connected) {
+  struct sockaddr_in addr;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  double secs;
+  int namelen;
+  int size;
+  int i;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  send_cb_called = 0;
+  send_errors = 0;
+  recv_cb_called = 0;
+  stopping = 0;
+
+  if (uv_ip4_addr("127.0.0.1", 0, &addr))
+    return 1;
+
+  if (uv_udp_init(&loop, &receiver))
+    return 1;
+
+  if (uv_udp_bind(&receiver, (const struct sockaddr*) &addr, 0))
+    return 1;
+
+  /* Give the receiver some slack so it's the sender that's measured. */
+  size = 4 << 20;
+  uv_recv_buffer_size((uv_handle_t*) &receiver, &size);
+
+  namelen = sizeof(peer);
+  if (uv_udp_getsockname(&receiver, (struct sockaddr*) &peer, &namelen))
+    return 1;
+
+  if (uv_udp_recv_start(&receiver, alloc_cb, recv_cb))
+    return 1;
+
+  if (uv_udp_init(&loop, &sender))
+    return 1;
+
+  dest = (const struct sockaddr*) &peer;
+  if (connected) {
+    if (uv_udp_connect(&sender, dest))
+      return 1;
+    dest = NULL;
+  }
+
+  if (uv_timer_init(&loop, &timer))
+    return 1;
+
+  if (uv_timer_start(&timer, timer_cb, DURATION, 0))
+    return 1;
+
+  before = uv_hrtime();
+  for (i = 0; i < WINDOW; i++)
+    do_send(reqs + i);
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = uv_hrtime();
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  secs = (after - before) / 1e9;
+  bench_report(send_cb_called / secs, "sent/s", "%s_sent", name);
+  bench_report(recv_cb_called / secs, "received/s", "%s_received", name);
+  bench_report(send_errors, "errors", "%s_send_errors", name);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run("udp_pps_unconnected", 0))
+    return 1;
+
+  if (run("udp_pps_connected", 1))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Writes 64 byte messages over a loopback TCP connection at a rate of
+ * 100,000 per second, like a pub/sub server fanning out small updates, and
+ * reports the CPU time spent per message. It does so once with uv_write(),
+ * whose queued requests are written out together, and once with a
+ * uv_try_write() per message, which is one system call per message.
+ */
+
+#include "uv.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DURATION 2000  /* ms */
+#define RATE 100       /* Messages per millisecond. */
+#define MSGSIZE 64
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t peer;
+static uv_connect_t connect_req;
+static uv_timer_t timer;
+static char message[MSGSIZE];
+static char slab[65536];
+static uint64_t start_time;
+static size_t nwritten;
+static size_t nread;
+static unsigned int nmessages;
+static int use_try_write;
+static int done;
+
+
+static void close_all(void) {
+  uv_close((uv_handle_t*) &server, NULL);
+  uv_close((uv_handle_t*) &client, NULL);
+  uv_close((uv_handle_t*) &peer, NULL);
+  uv_close((uv_handle_t*) &timer, NULL);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  if (status)
+    abort();
+  free(req);
+}
+
+
+static void write_message(const char* base, size_t len) {
+  uv_write_t* req;
+  uv_buf_t buf;
+
+  req = malloc(sizeof(*req));
+  if (req == NULL)
+    abort();
+
+  buf = uv_buf_init((char*) base, len);
+  if (uv_write(req, (uv_stream_t*) &client, &buf, 1, write_cb))
+    abort();
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  uint64_t elapsed;
+  unsigned int due;
+  uv_buf_t buf;
+  int r;
+
+  elapsed = uv_now(handle->loop) - start_time;
+  if (elapsed >= DURATION) {
+    elapsed = DURATION;
+    done = 1;
+    uv_timer_stop(handle);
+  }
+
+  /* Catch up when the timer fires late. */
+  for (due = elapsed * RATE; nmessages < due; nmessages++) {
+    nwritten += sizeof(message);
+
+    if (!use_try_write) {
+      write_message(message, sizeof(message));
+      continue;
+    }
+
+    buf = uv_buf_init(message, sizeof(message));
+    r = uv_try_write((uv_stream_t*) &client, &buf, 1);
+    if (r == UV_EAGAIN)
+      r = 0;
+    else if (r < 0)
+      abort();
+
+    if (r < (int) sizeof(message))
+      write_message(message + r, sizeof(message) - r);
+  }
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t n, const uv_buf_t* buf) {
+  if (n < 0)
+    abort();
+
+  nread += n;
+  if (done && nread == nwritten)
+    close_all();
+}
+
+
+static void connection_cb(uv_stream_t* handle, int status) {
+  if (status)
+    abort();
+
+  if (uv_tcp_init(handle->loop, &peer))
+    abort();
+
+  if (uv_accept(handle, (uv_stream_t*) &peer))
+    abort();
+
+  if (uv_read_start((uv_stream_t*) &peer, alloc_cb, read_cb))
+    abort();
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  if (status)
+    abort();
+
+  uv_tcp_nodelay(&client, 1);
+  start_time = uv_now(req->handle->loop);
+
+  if (uv_timer_start(&timer, timer_cb, 1, 1))
+    abort();
+}
+
+
+static uint64_t cpu_usec(void) {
+  uv_rusage_t ru;
+
+  if (uv_getrusage(&ru))
+    abort();
+
+  return (uint64_t) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+         ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+
+static int run(const char* name, int try_write) {
+  struct sockaddr_in addr;
+  uv_loop_t loop;
+  uint64_t before;
+  uint64_t after;
+  int namelen;
+
+  use_try_write = try_write;
+  nwritten = 0;
+  nread = 0;
+  nmessages = 0;
+  done = 0;
+
+  if (uv_loop_init(&loop))
+    return 1;
+
+  if (uv_ip4_addr("127.0.0.1", 0, &addr))
+    return 1;
+
+  if (uv_tcp_init(&loop, &server))
+    return 1;
+
+  if (uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0))
+    return 1;
+
+  if (uv_listen((uv_stream_t*) &server, 1, connection_cb))
+    return 1;
+
+  namelen = sizeof(addr);
+  if (uv_tcp_getsockname(&server, (struct sockaddr*) &addr, &namelen))
+    return 1;
+
+  if (uv_tcp_init(&loop, &client))
+    return 1;
+
+  if (uv_timer_init(&loop, &timer))
+    return 1;
+
+  if (uv_tcp_connect(&connect_req,
+                     &client,
+                     (const struct sockaddr*) &addr,
+                     connect_cb)) {
+    return 1;
+  }
+
+  before = cpu_usec();
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after = cpu_usec();
+
+  if (uv_loop_close(&loop))
+    return 1;
+
+  if (nread != nwritten || nmessages != DURATION * RATE)
+    return 1;
+
+  bench_report((double) (after - before) / nmessages,
+               "us cpu/message",
+               "%s",
+               name);
+
+  return 0;
+}
+
+
+int main(void) {
+  if (run("write_coalesce_queued", 0))
+    return 1;
+
+  if (run("write_coalesce_try_write", 1))
+    return 1;
+
+  return 0;
+}
@@ -25,10 +25,38 @@
 #include <linux/netlink.h>
 
 
+#define UV_IO_PRIVATE_PLATFORM_FIELDS                                         \
+  void* edge_queue[2];                                                        \
+  unsigned int edge;                                                          \
+  unsigned int ready;                                                         \
+  unsigned int exclusive;                                                     \
+
+#define UV_PROCESS_PRIVATE_PLATFORM_FIELDS                                    \
+  uv__io_t pidfd_watcher;                                                     \
+
+#define UV_SIGNAL_PRIVATE_PLATFORM_FIELDS                                     \
+  void* signalfd_queue[2];                                                    \
+
 #define UV_PLATFORM_LOOP_FIELDS                                               \
   uv__io_t inotify_read_watcher;                                              \
   void* inotify_watchers;                                                     \
   int inotify_fd;                                                             \
+  void* iou;                                                                  \
+  unsigned int* epoll_masks;                                                  \
+  unsigned int nepoll_masks;                                                  \
+  void* edge_queue[2];                                                        \
+  /* epoll_ctl() calls avoided by lazy interest updates in the last */        \
+  /* uv__io_poll() call and since the loop was created. */                   \
+  unsigned int epoll_ctl_saved;                                               \
+  uint64_t epoll_ctl_saved_total;                                             \
+  /* Signals this loop reads from its signalfd, one bit per signal number, */ \
+  /* and the subset of those the loop thread blocked for that purpose. */     \
+  uv__io_t signalfd_watcher;                                                  \
+  void* signalfd_handles[2];                                                  \
+  uint64_t signalfd_mask;                                                     \
+  uint64_t signalfd_blocked;                                                  \
+  /* Active watchers per signal number, signal 1 is at index 0. */           \
+  unsigned int signalfd_watchers[64];                                         \
 
 #define UV_PLATFORM_FS_EVENT_FIELDS                                           \
   void* watchers[2];                                                          \
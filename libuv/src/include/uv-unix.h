@@ -117,6 +117,14 @@ struct uv__async {
 # define UV_STREAM_PRIVATE_PLATFORM_FIELDS /* empty */
 #endif
 
+#ifndef UV_PROCESS_PRIVATE_PLATFORM_FIELDS
+# define UV_PROCESS_PRIVATE_PLATFORM_FIELDS /* empty */
+#endif
+
+#ifndef UV_SIGNAL_PRIVATE_PLATFORM_FIELDS
+# define UV_SIGNAL_PRIVATE_PLATFORM_FIELDS /* empty */
+#endif
+
 /* Note: May be cast to struct iovec. See writev(2). */
 typedef struct uv_buf_t {
   char* base;
@@ -222,13 +230,18 @@ typedef struct {
   void* prepare_handles[2];                                                   \
   void* check_handles[2];                                                     \
   void* idle_handles[2];                                                      \
-  void* async_handles[2];                                                     \
+  void* async_pending[2];                                                     \
+  void* async_stack;                                                          \
   struct uv__async async_watcher;                                             \
   struct {                                                                    \
     void* min;                                                                \
     unsigned int nelts;                                                       \
   } timer_heap;                                                               \
   uint64_t timer_counter;                                                     \
+  void* timer_wheel;                                                          \
+  void* buf_pool;                                                             \
+  void* dns_cache;                                                            \
+  void* metrics;                                                              \
   uint64_t time;                                                              \
   int signal_pipefd[2];                                                       \
   uv__io_t signal_io_watcher;                                                 \
@@ -249,12 +262,21 @@ typedef struct {
   unsigned int nbufs;                                                         \
   int error;                                                                  \
   uv_buf_t bufsml[4];                                                         \
+  int file;                                                                   \
+  int64_t file_offset;                                                        \
+  unsigned int zerocopy;                                                      \
 
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   void* queue[2];                                                             \
 
 #define UV_SHUTDOWN_PRIVATE_FIELDS /* empty */
 
+#define UV_SPLICE_PRIVATE_FIELDS                                              \
+  int pipefd[2];                                                              \
+  size_t pending;                                                             \
+  int eof;                                                                    \
+  int pipe_full;                                                              \
+
 #define UV_UDP_SEND_PRIVATE_FIELDS                                            \
   void* queue[2];                                                             \
   struct sockaddr_storage addr;                                               \
@@ -275,9 +297,16 @@ typedef struct {
   void* write_queue[2];                                                       \
   void* write_completed_queue[2];                                             \
   uv_connection_cb connection_cb;                                             \
+  uv_connection_batch_cb connection_batch_cb;                                 \
   int delayed_error;                                                          \
   int accepted_fd;                                                            \
   void* queued_fds;                                                           \
+  uv_splice_t* splice_read;                                                   \
+  uv_splice_t* splice_write;                                                  \
+  void* zerocopy_queue[2];                                                    \
+  size_t zerocopy_threshold;                                                  \
+  unsigned int zerocopy_seq;                                                  \
+  unsigned int zerocopy_acked;                                                \
   UV_STREAM_PRIVATE_PLATFORM_FIELDS                                           \
 
 #define UV_TCP_PRIVATE_FIELDS /* empty */
@@ -288,6 +317,7 @@ typedef struct {
   uv__io_t io_watcher;                                                        \
   void* write_queue[2];                                                       \
   void* write_completed_queue[2];                                             \
+  unsigned int mmsg_size;                                                     \
 
 #define UV_PIPE_PRIVATE_FIELDS                                                \
   const char* pipe_fname; /* strdup'ed */
@@ -310,7 +340,20 @@ typedef struct {
 #define UV_ASYNC_PRIVATE_FIELDS                                               \
   uv_async_cb async_cb;                                                       \
   void* queue[2];                                                             \
+  void* pending_next;                                                         \
   int pending;                                                                \
+  int busy;                                                                   \
+
+/* Starts with the uv_async_t fields, the loop dispatches channels as if they
+ * were async handles.
+ */
+#define UV_CHANNEL_PRIVATE_FIELDS                                             \
+  UV_ASYNC_PRIVATE_FIELDS                                                     \
+  uv_channel_cb channel_cb;                                                   \
+  void* cells;                                                                \
+  unsigned long mask;                                                         \
+  unsigned long head;                                                         \
+  unsigned long tail;                                                         \
 
 #define UV_TIMER_PRIVATE_FIELDS                                               \
   uv_timer_cb timer_cb;                                                       \
@@ -326,7 +369,15 @@ typedef struct {
   char* hostname;                                                             \
   char* service;                                                              \
   struct addrinfo* res;                                                       \
-  int retcode;
+  int retcode;                                                                \
+  void* cache_entry;
+
+#define UV_RESOLVER_PRIVATE_FIELDS                                            \
+  void* resolver_ctx;                                                         \
+
+#define UV_RESOLVE_PRIVATE_FIELDS                                             \
+  uv_resolve_cb cb;                                                           \
+  void* query;                                                                \
 
 #define UV_GETNAMEINFO_PRIVATE_FIELDS                                         \
   struct uv__work work_req;                                                   \
@@ -340,6 +391,7 @@ typedef struct {
 #define UV_PROCESS_PRIVATE_FIELDS                                             \
   void* queue[2];                                                             \
   int status;                                                                 \
+  UV_PROCESS_PRIVATE_PLATFORM_FIELDS                                          \
 
 #define UV_FS_PRIVATE_FIELDS                                                  \
   const char *new_path;                                                       \
@@ -373,7 +425,8 @@ typedef struct {
   } tree_entry;                                                               \
   /* Use two counters here so we don have to fiddle with atomics. */          \
   unsigned int caught_signals;                                                \
-  unsigned int dispatched_signals;
+  unsigned int dispatched_signals;                                            \
+  UV_SIGNAL_PRIVATE_PLATFORM_FIELDS                                           \
 
 #define UV_FS_EVENT_PRIVATE_FIELDS                                            \
   uv_fs_event_cb cb;                                                          \
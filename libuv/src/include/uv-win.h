@@ -380,6 +380,8 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   /* empty */
 
+#define UV_SPLICE_PRIVATE_FIELDS /* empty */
+
 #define UV_SHUTDOWN_PRIVATE_FIELDS                                            \
   /* empty */
 
@@ -543,6 +545,10 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
   /* char to avoid alignment issues */                                        \
   char volatile async_sent;
 
+#define UV_CHANNEL_PRIVATE_FIELDS                                             \
+  UV_ASYNC_PRIVATE_FIELDS                                                     \
+  uv_channel_cb channel_cb;
+
 #define UV_PREPARE_PRIVATE_FIELDS                                             \
   uv_prepare_t* prepare_prev;                                                 \
   uv_prepare_t* prepare_next;                                                 \
@@ -572,6 +578,10 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
   struct addrinfoW* res;                                                      \
   int retcode;
 
+#define UV_RESOLVER_PRIVATE_FIELDS /* empty */
+
+#define UV_RESOLVE_PRIVATE_FIELDS /* empty */
+
 #define UV_GETNAMEINFO_PRIVATE_FIELDS                                         \
   struct uv__work work_req;                                                   \
   uv_getnameinfo_cb getnameinfo_cb;                                           \
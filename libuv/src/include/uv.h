@@ -156,6 +156,8 @@ extern "C" {
   XX(TTY, tty)                                                                \
   XX(UDP, udp)                                                                \
   XX(SIGNAL, signal)                                                          \
+  XX(CHANNEL, channel)                                                        \
+  XX(RESOLVER, resolver)                                                      \
 
 #define UV_REQ_TYPE_MAP(XX)                                                   \
   XX(REQ, req)                                                                \
@@ -167,6 +169,8 @@ extern "C" {
   XX(WORK, work)                                                              \
   XX(GETADDRINFO, getaddrinfo)                                                \
   XX(GETNAMEINFO, getnameinfo)                                                \
+  XX(SPLICE, splice)                                                          \
+  XX(RESOLVE, resolve)                                                        \
 
 typedef enum {
 #define XX(code, _) UV_ ## code = UV__ ## code,
@@ -208,10 +212,12 @@ typedef struct uv_prepare_s uv_prepare_t;
 typedef struct uv_check_s uv_check_t;
 typedef struct uv_idle_s uv_idle_t;
 typedef struct uv_async_s uv_async_t;
+typedef struct uv_channel_s uv_channel_t;
 typedef struct uv_process_s uv_process_t;
 typedef struct uv_fs_event_s uv_fs_event_t;
 typedef struct uv_fs_poll_s uv_fs_poll_t;
 typedef struct uv_signal_s uv_signal_t;
+typedef struct uv_resolver_s uv_resolver_t;
 
 /* Request types. */
 typedef struct uv_req_s uv_req_t;
@@ -223,11 +229,14 @@ typedef struct uv_connect_s uv_connect_t;
 typedef struct uv_udp_send_s uv_udp_send_t;
 typedef struct uv_fs_s uv_fs_t;
 typedef struct uv_work_s uv_work_t;
+typedef struct uv_splice_s uv_splice_t;
+typedef struct uv_resolve_s uv_resolve_t;
 
 /* None of the above. */
 typedef struct uv_cpu_info_s uv_cpu_info_t;
 typedef struct uv_interface_address_s uv_interface_address_t;
 typedef struct uv_dirent_s uv_dirent_t;
+typedef struct uv_loop_group_s uv_loop_group_t;
 
 
 typedef enum {
@@ -250,6 +259,30 @@ UV_EXTERN unsigned int uv_version(void);
  */
 UV_EXTERN const char* uv_version_string(void);
 
+typedef void* (*uv_malloc_func)(size_t size);
+typedef void* (*uv_realloc_func)(void* ptr, size_t size);
+typedef void* (*uv_calloc_func)(size_t count, size_t size);
+typedef void (*uv_free_func)(void* ptr);
+
+/*
+ * Replaces the functions libuv allocates its own memory with. By default
+ * libuv keeps small freed blocks in a per-thread cache and gets the rest
+ * from malloc(3), calloc(3) and realloc(3). The replacement sees every
+ * allocation, point it at an arena, a size-class allocator or an
+ * instrumented one.
+ *
+ * Must be called before any other libuv function, memory allocated before
+ * would otherwise be freed with the new functions. The free function must
+ * accept NULL. Memory that comes from the C library, like the result of
+ * uv_getaddrinfo() or the entries of uv_fs_readdir(), is not affected.
+ *
+ * Returns UV_EINVAL when one of the functions is NULL.
+ */
+UV_EXTERN int uv_replace_allocator(uv_malloc_func malloc_func,
+                                   uv_realloc_func realloc_func,
+                                   uv_calloc_func calloc_func,
+                                   uv_free_func free_func);
+
 
 /*
  * All functions besides uv_run() are non-blocking.
@@ -266,6 +299,10 @@ UV_EXTERN uv_loop_t* uv_default_loop(void);
 
 /*
  * Initializes a uv_loop_t structure.
+ *
+ * On Linux, the loop polls for i/o with io_uring instead of epoll when the
+ * UV_USE_IO_URING environment variable is set to a non-zero value and the
+ * kernel supports it (linux >= 5.11).  Otherwise epoll is used.
  */
 UV_EXTERN int uv_loop_init(uv_loop_t* loop);
 
@@ -383,6 +420,76 @@ UV_EXTERN int uv_backend_fd(const uv_loop_t*);
  */
 UV_EXTERN int uv_backend_timeout(const uv_loop_t*);
 
+/*
+ * Per-loop metrics, off by default. When they're off the loop pays for a
+ * pointer test per iteration and nothing else.
+ *
+ * Histograms have log2 buckets: counts[0] counts samples of 0, counts[i]
+ * counts samples in [2^(i-1), 2^i). The last bucket also takes everything
+ * bigger. Time histograms are in microseconds.
+ */
+#define UV_METRICS_HISTOGRAM_BUCKETS 32
+
+typedef struct {
+  uint64_t counts[UV_METRICS_HISTOGRAM_BUCKETS];
+  uint64_t samples;
+  uint64_t sum;
+  uint64_t max;
+} uv_metrics_histogram_t;
+
+typedef struct {
+  uint64_t iterations;       /* Loop iterations. */
+  uint64_t polls;            /* Calls into epoll_wait(), kevent(), etc. */
+  uint64_t poll_time;        /* Nanoseconds spent waiting in them. */
+  uint64_t events;           /* Events they returned. */
+  uint64_t work_submitted;   /* Threadpool work, including fs and DNS reqs. */
+  uint64_t work_completed;   /* Done callbacks run, cancelled work included. */
+  uv_metrics_histogram_t busy;       /* Time between two polls, i.e. time
+                                      * spent running callbacks. */
+  uv_metrics_histogram_t poll_events;  /* Events per poll. */
+  uv_metrics_histogram_t work_wait;  /* Time work spent in the queue... */
+  uv_metrics_histogram_t work_run;   /* ...and running on a worker. */
+  /* Taken when uv_loop_metrics() is called, also when metrics are off. */
+  unsigned int pending;      /* Callbacks deferred to the next iteration. */
+  unsigned int timers;       /* Active timers. */
+  unsigned int active_handles;
+  unsigned int active_reqs;
+  /* epoll_ctl() calls that lazy interest updates avoided in the last poll and
+   * since the loop was created. Linux with epoll only, zero elsewhere. */
+  unsigned int poll_ctl_saved;
+  uint64_t poll_ctl_saved_total;
+} uv_loop_metrics_t;
+
+typedef struct {
+  unsigned int threads;
+  unsigned int queued;       /* Work waiting for a thread right now... */
+  unsigned int max_queued;   /* ...and the most there's ever been. */
+  unsigned int busy;         /* Threads that are running work. */
+  uint64_t completed;        /* Work the threads have run. */
+  uv_metrics_histogram_t wait;  /* Queue time of work from loops that have
+                                 * metrics on. */
+} uv_threadpool_metrics_t;
+
+/*
+ * Turns metrics on or off. Turning them on starts from zero, turning them
+ * off drops what was recorded. Returns UV_ENOMEM when out of memory or
+ * UV_ENOSYS on platforms where it's not supported.
+ */
+UV_EXTERN int uv_loop_set_metrics(uv_loop_t* loop, int enable);
+
+/*
+ * Copies out what was recorded so far. Counters and histograms are zero when
+ * metrics are off. Can be called from callbacks, but not from other threads.
+ */
+UV_EXTERN int uv_loop_metrics(const uv_loop_t* loop,
+                              uv_loop_metrics_t* metrics);
+
+/*
+ * Threadpool gauges. The threadpool is shared by all loops and started by the
+ * first piece of work, threads is 0 until then.
+ */
+UV_EXTERN int uv_threadpool_metrics(uv_threadpool_metrics_t* metrics);
+
 
 /*
  * Should prepare a buffer that libuv can use to read data into.
@@ -407,9 +514,9 @@ typedef void (*uv_alloc_cb)(uv_handle_t* handle,
  * The callee is responsible for closing the stream when an error happens
  * by calling uv_close(). Trying to read from the stream again is undefined.
  *
- * The callee is responsible for freeing the buffer, libuv does not reuse it.
- * The buffer may be a null buffer (where buf->base=NULL and buf->len=0) on
- * error.
+ * The callee is responsible for freeing the buffer, libuv does not reuse it,
+ * unless it came from uv_buf_pool_alloc(). The buffer may be a null buffer
+ * (where buf->base=NULL and buf->len=0) on error.
  */
 typedef void (*uv_read_cb)(uv_stream_t* stream,
                            ssize_t nread,
@@ -417,11 +524,18 @@ typedef void (*uv_read_cb)(uv_stream_t* stream,
 typedef void (*uv_write_cb)(uv_write_t* req, int status);
 typedef void (*uv_connect_cb)(uv_connect_t* req, int status);
 typedef void (*uv_shutdown_cb)(uv_shutdown_t* req, int status);
+typedef void (*uv_splice_cb)(uv_splice_t* req, int status);
 typedef void (*uv_connection_cb)(uv_stream_t* server, int status);
+typedef void (*uv_connection_batch_cb)(uv_stream_t* server,
+                                       unsigned int count,
+                                       int status);
 typedef void (*uv_close_cb)(uv_handle_t* handle);
 typedef void (*uv_poll_cb)(uv_poll_t* handle, int status, int events);
 typedef void (*uv_timer_cb)(uv_timer_t* handle);
 typedef void (*uv_async_cb)(uv_async_t* handle);
+typedef void (*uv_channel_cb)(uv_channel_t* handle,
+                              void** msgs,
+                              unsigned int nmsgs);
 typedef void (*uv_prepare_cb)(uv_prepare_t* handle);
 typedef void (*uv_check_cb)(uv_check_t* handle);
 typedef void (*uv_idle_cb)(uv_idle_t* handle);
@@ -637,6 +751,45 @@ UV_EXTERN int uv_send_buffer_size(uv_handle_t* handle, int* value);
  */
 UV_EXTERN uv_buf_t uv_buf_init(char* base, unsigned int len);
 
+/*
+ * Per-loop pool of fixed-size read buffers.
+ *
+ * Pass uv_buf_pool_alloc() as the alloc callback to uv_read_start() or
+ * uv_udp_recv_start() and libuv takes the buffer back once the read or recv
+ * callback returns, so a connection only holds on to a buffer while there's
+ * data to process. The size hint is ignored, every buffer is `buf_size` bytes.
+ *
+ * Buffers are reference counted. Call uv_buf_pool_ref() from the read callback
+ * to keep the data around for longer and uv_buf_pool_unref() when done with
+ * it. `buf` must be the buffer that was passed to the callback.
+ *
+ * The pool belongs to the loop and is not thread-safe. A buffer that is still
+ * referenced when the loop is closed is freed by its last uv_buf_pool_unref().
+ */
+typedef struct {
+  size_t buf_size;
+  unsigned int in_use;  /* Handed out and not returned yet. */
+  unsigned int free;    /* Cached for reuse. */
+  uint64_t allocs;      /* uv_buf_pool_alloc() calls... */
+  uint64_t misses;      /* ...that had to allocate memory. */
+} uv_buf_pool_stats_t;
+
+/*
+ * Configure the loop's buffer pool. `buf_size` 0 means 64 kB, the default.
+ * At most `max_free` unused buffers are kept, 16 by default. Changing
+ * `buf_size` while buffers are in use returns UV_EBUSY.
+ */
+UV_EXTERN int uv_loop_set_buf_pool(uv_loop_t* loop,
+                                   size_t buf_size,
+                                   unsigned int max_free);
+UV_EXTERN void uv_buf_pool_alloc(uv_handle_t* handle,
+                                 size_t suggested_size,
+                                 uv_buf_t* buf);
+UV_EXTERN void uv_buf_pool_ref(const uv_buf_t* buf);
+UV_EXTERN void uv_buf_pool_unref(const uv_buf_t* buf);
+UV_EXTERN int uv_buf_pool_stats(const uv_loop_t* loop,
+                                uv_buf_pool_stats_t* stats);
+
 
 #define UV_STREAM_FIELDS                                                      \
   /* number of bytes queued for writing */                                    \
@@ -660,6 +813,27 @@ struct uv_stream_s {
 
 UV_EXTERN int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb);
 
+/*
+ * Like uv_listen() but accepts connections in batches. Every time the
+ * listen socket becomes readable, libuv drains as much of the backlog as it
+ * can (up to an implementation-defined limit) and calls `cb` once with the
+ * number of connections it accepted. Call uv_accept() `count` times to take
+ * them. The server doesn't accept new connections until all of them have
+ * been taken.
+ *
+ * `status` is non-zero (and `count` zero) when accept() failed.
+ *
+ * Use uv_tcp_simultaneous_accepts() to balance a listen socket that is
+ * shared between processes. On Linux the kernel then wakes up only one of
+ * the processes per incoming connection. Alternatively, bind a listen socket
+ * per process with UV_TCP_REUSEPORT.
+ *
+ * Not supported on Windows, returns UV_ENOSYS.
+ */
+UV_EXTERN int uv_listen_batch(uv_stream_t* stream,
+                              int backlog,
+                              uv_connection_batch_cb cb);
+
 /*
  * This call is used in conjunction with uv_listen() to accept incoming
  * connections. Call uv_accept after receiving a uv_connection_cb to accept
@@ -746,6 +920,24 @@ UV_EXTERN int uv_try_write(uv_stream_t* handle,
                            const uv_buf_t bufs[],
                            unsigned int nbufs);
 
+/*
+ * Write `length` bytes of `file`, starting at `offset`, to the stream. The
+ * request is queued like any other write and goes out in order. Unlike
+ * uv_fs_sendfile(), it does not use the threadpool: the data is sent with
+ * non-blocking sendfile(2) whenever the stream becomes writable.
+ *
+ * `file` must stay open until the callback is called. The callback gets
+ * UV_EOF when the file is shorter than offset + length. Where sendfile(2)
+ * isn't available or doesn't support the file, the data is read into a
+ * small buffer and written out instead.
+ */
+UV_EXTERN int uv_write_file(uv_write_t* req,
+                            uv_stream_t* handle,
+                            uv_file file,
+                            int64_t offset,
+                            size_t length,
+                            uv_write_cb cb);
+
 /* uv_write_t is a subclass of uv_req_t. */
 struct uv_write_s {
   UV_REQ_FIELDS
@@ -756,6 +948,47 @@ struct uv_write_s {
 };
 
 
+/*
+ * uv_splice_t is a subclass of uv_req_t.
+ *
+ * Forward everything that's read from `src` to `dst` without copying it to
+ * and from userspace. The data moves through a kernel pipe with splice(2).
+ * Reading from `src` pauses while `dst` can't keep up.
+ *
+ * The callback is called with status 0 once `src` reached EOF and all data
+ * has been written to `dst`, or with an error code when reading or writing
+ * failed. The streams are left open; a proxy will usually want to call
+ * uv_shutdown() on `dst` from the callback. `req->nbytes` is the number of
+ * bytes written to `dst` so far.
+ *
+ * `src` must not be reading. Writes that are queued on `dst` go out before
+ * the spliced data. uv_read_start() on `src` and uv_write() on `dst` return
+ * UV_EBUSY until the splice is done. Closing either stream cancels the splice
+ * with UV_ECANCELED.
+ *
+ * Linux only, returns UV_ENOSYS on other platforms.
+ */
+UV_EXTERN int uv_splice_start(uv_splice_t* req,
+                              uv_stream_t* src,
+                              uv_stream_t* dst,
+                              uv_splice_cb cb);
+
+/*
+ * Stop a splice without calling its callback. Data that was read from `src`
+ * but hasn't been written to `dst` yet is lost.
+ */
+UV_EXTERN int uv_splice_stop(uv_splice_t* req);
+
+struct uv_splice_s {
+  UV_REQ_FIELDS
+  uv_stream_t* src;
+  uv_stream_t* dst;
+  uint64_t nbytes;
+  uv_splice_cb cb;
+  UV_SPLICE_PRIVATE_FIELDS
+};
+
+
 /*
  * Used to determine whether a stream is readable or writable.
  */
@@ -784,6 +1017,21 @@ UV_EXTERN int uv_is_writable(const uv_stream_t* handle);
 UV_EXTERN int uv_stream_set_blocking(uv_stream_t* handle, int blocking);
 
 
+/*
+ * Enable or disable edge-triggered I/O for a stream.
+ *
+ * Edge-triggered streams stay registered with the kernel for both read and
+ * write readiness and keep track of it themselves, which saves a system call
+ * every time reading or writing is started or stopped. A stream that still
+ * has data to read after 32 reads gets another turn on the next loop
+ * iteration, the same as in level-triggered mode.
+ *
+ * Returns UV_ENOSYS on platforms other than Linux and UV_ENOTSUP when the
+ * loop uses the io_uring backend. Can be called at any time.
+ */
+UV_EXTERN int uv_stream_set_edge_triggered(uv_stream_t* handle, int enable);
+
+
 /*
  * Used to determine whether a stream is closing or closed.
  *
@@ -823,6 +1071,29 @@ UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle,
                                int enable,
                                unsigned int delay);
 
+/*
+ * Enable/disable zero-copy writes.
+ *
+ * When enabled, writes of at least `threshold` bytes are sent with
+ * MSG_ZEROCOPY: the kernel transmits straight from the user's buffers instead
+ * of copying them. The write callback is delayed until the kernel reports
+ * that it's done with the buffers, which usually means the peer acknowledged
+ * the data. A `threshold` of zero selects a default of 16 kB; below roughly
+ * that size the bookkeeping costs more than the copy saves.
+ *
+ * Closing the handle cancels zero-copy writes that the kernel hasn't reported
+ * as done yet, their callbacks run with UV_ECANCELED. The kernel may still
+ * send from those buffers after uv_close(), so they must stay untouched.
+ * Wait for the write callbacks before closing to get the buffers back.
+ *
+ * Linux 4.14 and up, returns UV_ENOSYS on other platforms. If the kernel
+ * turns out not to support it when the socket is created later on, writes
+ * silently fall back to copying.
+ */
+UV_EXTERN int uv_tcp_zerocopy(uv_tcp_t* handle,
+                              int enable,
+                              size_t threshold);
+
 /*
  * Enable/disable simultaneous asynchronous accept requests that are
  * queued by the operating system when listening for new tcp connections.
@@ -831,12 +1102,23 @@ UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle,
  * Having simultaneous accepts can significantly improve the rate of accepting
  * connections (which is why it is enabled by default) but may lead to uneven
  * load distribution in multi-process setups.
+ *
+ * On Linux, disabling simultaneous accepts registers the listen socket with
+ * EPOLLEXCLUSIVE so only one of the processes that share it is woken up per
+ * connection.
  */
 UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+  /*
+   * Set SO_REUSEPORT so that several sockets can listen on the same address
+   * and port, provided they all set the flag. Linux 3.9+ spreads incoming
+   * connections over them, which is how the loops of a uv_loop_group_t each
+   * get a listener of their own. UV_ENOTSUP where SO_REUSEPORT doesn't exist.
+   */
+  UV_TCP_REUSEPORT = 2
 };
 
 /*
@@ -901,7 +1183,19 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received by recvmmsg, so the buffer provided
+   * must not be freed by the recv_cb callback.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Set SO_REUSEPORT when binding the handle, on Linux too. Unlike
+   * UV_UDP_REUSEADDR, Linux 3.9+ then spreads incoming datagrams over all
+   * the sockets bound to the address. UV_ENOTSUP where SO_REUSEPORT doesn't
+   * exist.
+   */
+  UV_UDP_REUSEPORT = 16
 };
 
 /*
@@ -922,7 +1216,7 @@ typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
  *  addr    struct sockaddr* containing the address of the sender. Can be NULL.
  *          Valid for the duration of the callback only.
  *  flags   One or more OR'ed UV_UDP_* constants. Right now only UV_UDP_PARTIAL
- *          is used.
+ *          and UV_UDP_MMSG_CHUNK are used.
  *
  * NOTE:
  *  The receive callback will be called with nread == 0 and addr == NULL when
@@ -1091,6 +1385,92 @@ UV_EXTERN int uv_udp_set_broadcast(uv_udp_t* handle, int on);
  */
 UV_EXTERN int uv_udp_set_ttl(uv_udp_t* handle, int ttl);
 
+/*
+ * Enable or disable edge-triggered I/O for a UDP handle. See
+ * uv_stream_set_edge_triggered().
+ *
+ * Arguments:
+ *  handle              UDP handle. Should have been initialized with
+ *                      uv_udp_init().
+ *  enable              1 for edge-triggered, 0 for level-triggered.
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure.
+ */
+UV_EXTERN int uv_udp_set_edge_triggered(uv_udp_t* handle, int enable);
+
+/*
+ * Receive datagrams in batches with recvmmsg(2) instead of one recvmsg(2)
+ * call per datagram.
+ *
+ * The buffer that alloc_cb returns is carved up into slots of max_size bytes,
+ * one datagram per slot; alloc_cb is asked for room for a full batch. Longer
+ * datagrams are truncated and flagged with UV_UDP_PARTIAL. recv_cb is called
+ * for every datagram with UV_UDP_MMSG_CHUNK set and buf pointing into the
+ * slot; don't free it. When the batch is done, recv_cb is called once more
+ * with nread == 0, addr == NULL and the original buffer so it can be freed or
+ * reused. That last call is made even when the callback stopped receiving.
+ *
+ * Arguments:
+ *  handle              UDP handle. Should have been initialized with
+ *                      uv_udp_init().
+ *  max_size            Size of the largest expected datagram, at most 65536.
+ *                      0 turns batching off.
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure. UV_ENOSYS when the
+ *  platform doesn't support recvmmsg(2).
+ */
+UV_EXTERN int uv_udp_set_recvmmsg(uv_udp_t* handle, size_t max_size);
+
+/*
+ * Let the kernel split up large sends (UDP_SEGMENT, linux >= 4.18).
+ *
+ * Queued send requests of the same size to the same peer are passed to the
+ * kernel as one message of up to 64 datagrams; the last one can be shorter.
+ * Every request still gets its own send_cb. Without kernel or route support
+ * for it libuv quietly turns it off again and sends the datagrams one by one.
+ *
+ * Arguments:
+ *  handle              UDP handle. Should have been initialized with
+ *                      uv_udp_init().
+ *  enable              1 to coalesce sends, 0 to send every datagram by
+ *                      itself.
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure.
+ */
+UV_EXTERN int uv_udp_set_gso(uv_udp_t* handle, int enable);
+
+/*
+ * Associate the UDP handle with a remote peer. If the socket has not
+ * previously been bound with uv_udp_bind() it is bound to the "all
+ * interfaces" address and a random port number.
+ *
+ * Afterwards uv_udp_send() and uv_udp_try_send() must be called with a NULL
+ * address; they fail with UV_EISCONN otherwise. The kernel looks up the route
+ * once instead of for every datagram and drops datagrams from other peers
+ * before they reach the receive callback.
+ *
+ * Arguments:
+ *  handle    UDP handle. Should have been initialized with uv_udp_init().
+ *  addr      struct sockaddr_in or struct sockaddr_in6 with the address and
+ *            port of the remote peer, or NULL to disconnect the handle again.
+ *
+ * Returns:
+ *  0 on success, or an error code < 0 on failure. UV_EISCONN if the handle
+ *  is already connected, UV_ENOTCONN when disconnecting a handle that isn't.
+ */
+UV_EXTERN int uv_udp_connect(uv_udp_t* handle, const struct sockaddr* addr);
+
+/*
+ * Get the address of the peer a UDP handle has been connected to with
+ * uv_udp_connect(). Returns UV_ENOTCONN if the handle isn't connected.
+ */
+UV_EXTERN int uv_udp_getpeername(const uv_udp_t* handle,
+                                 struct sockaddr* name,
+                                 int* namelen);
+
 /*
  * Send data. If the socket has not previously been bound with uv_udp_bind() it
  * is bound to 0.0.0.0 (the "all interfaces" address) and a random port number.
@@ -1101,7 +1481,8 @@ UV_EXTERN int uv_udp_set_ttl(uv_udp_t* handle, int ttl);
  *  bufs      List of buffers to send.
  *  nbufs     Number of buffers in `bufs`.
  *  addr      struct sockaddr_in or struct sockaddr_in6 with the address and
- *            port of the remote peer.
+ *            port of the remote peer. Must be NULL if the handle has been
+ *            connected with uv_udp_connect().
  *  send_cb   Callback to invoke when the data has been sent out.
  *
  * Returns:
@@ -1442,6 +1823,42 @@ UV_EXTERN int uv_async_init(uv_loop_t*,
 UV_EXTERN int uv_async_send(uv_async_t* async);
 
 
+/*
+ * uv_channel_t is a subclass of uv_handle_t.
+ *
+ * A channel passes pointers from any number of threads to the loop that owns
+ * it. Messages are queued in a fixed-size lock-free ring and delivered to the
+ * channel's callback in batches, in the order in which they were queued. The
+ * loop is woken up through the same file descriptor as uv_async_t handles and
+ * a wakeup is only sent when the loop hasn't been told about pending messages
+ * yet.
+ *
+ * Like uv_async_t, a channel is active from the moment it is initialized
+ * until it's closed with uv_close(). Messages that are still queued when the
+ * channel is closed are dropped; stop the producers first.
+ */
+struct uv_channel_s {
+  UV_HANDLE_FIELDS
+  UV_CHANNEL_PRIVATE_FIELDS
+};
+
+/*
+ * Initialize a channel that can hold up to `capacity` messages, rounded up
+ * to a power of two. `cb` is called on the loop thread with up to 64
+ * messages at a time.
+ */
+UV_EXTERN int uv_channel_init(uv_loop_t* loop,
+                              uv_channel_t* channel,
+                              unsigned int capacity,
+                              uv_channel_cb cb);
+
+/*
+ * Queue `msg` for delivery to the loop. Can be called from any thread.
+ * Returns UV_EAGAIN when the channel is full.
+ */
+UV_EXTERN int uv_channel_send(uv_channel_t* channel, void* msg);
+
+
 /*
  * uv_timer_t is a subclass of uv_handle_t.
  *
@@ -1486,6 +1903,18 @@ UV_EXTERN void uv_timer_set_repeat(uv_timer_t* handle, uint64_t repeat);
 
 UV_EXTERN uint64_t uv_timer_get_repeat(const uv_timer_t* handle);
 
+/*
+ * Keep the loop's timers in a hierarchical timing wheel instead of a binary
+ * heap. Starting, stopping and restarting a timer becomes O(1) instead of
+ * O(log n), which pays off when there are many timers that are restarted
+ * often, like per-connection idle timeouts. Timers still run in the same
+ * order.
+ *
+ * Can only be changed when the loop has no active timers, returns UV_EBUSY
+ * otherwise. Returns UV_ENOSYS on Windows.
+ */
+UV_EXTERN int uv_loop_set_timer_wheel(uv_loop_t* loop, int enable);
+
 
 /*
  * uv_getaddrinfo_t is a subclass of uv_req_t.
@@ -1530,6 +1959,42 @@ UV_EXTERN int uv_getaddrinfo(uv_loop_t* loop,
  */
 UV_EXTERN void uv_freeaddrinfo(struct addrinfo* ai);
 
+/*
+ * Per-loop cache in front of uv_getaddrinfo(), off by default.
+ *
+ * Results are keyed on node, service and the flags, family, socktype and
+ * protocol of the hints. A hit is answered on the next loop iteration
+ * without going through the threadpool, and a lookup that is identical to
+ * one still in flight waits for that one instead of starting another. Every
+ * callback gets its own copy of the result, which must be freed with
+ * uv_freeaddrinfo() and not with freeaddrinfo(3).
+ *
+ * Requests answered from the cache or waiting for another lookup can't be
+ * cancelled, uv_cancel() returns UV_EBUSY for them.
+ */
+typedef struct {
+  unsigned int entries;
+  uint64_t hits;        /* Answered from the cache... */
+  uint64_t misses;      /* ...looked up with getaddrinfo()... */
+  uint64_t coalesced;   /* ...or joined an identical lookup in flight. */
+  uint64_t evictions;   /* Dropped because the cache was full. */
+} uv_dns_cache_stats_t;
+
+/*
+ * Successful lookups are cached for `ttl` milliseconds, lookups that failed
+ * with UV_EAI_NONAME or UV_EAI_NODATA for `negative_ttl` milliseconds; other
+ * errors are never cached. At most `max_entries` results are kept, 1024 when
+ * 0 is passed, the least recently used goes first. A `ttl` of 0 turns the
+ * cache off and drops what's cached. Returns UV_ENOSYS on platforms where
+ * it's not supported.
+ */
+UV_EXTERN int uv_loop_set_dns_cache(uv_loop_t* loop,
+                                    unsigned int ttl,
+                                    unsigned int negative_ttl,
+                                    unsigned int max_entries);
+UV_EXTERN int uv_dns_cache_stats(const uv_loop_t* loop,
+                                 uv_dns_cache_stats_t* stats);
+
 
 /*
 * uv_getnameinfo_t is a subclass of uv_req_t.
@@ -1558,6 +2023,105 @@ UV_EXTERN int uv_getnameinfo(uv_loop_t* loop,
                              int flags);
 
 
+/*
+ * uv_resolver_t is a subclass of uv_handle_t.
+ *
+ * A DNS stub resolver that runs on the event loop instead of the threadpool.
+ * Queries go out over UDP to the name servers from /etc/resolv.conf and are
+ * retried over TCP when the answer was truncated. Because nothing blocks, a
+ * single resolver can take thousands of queries at once. It sends at most
+ * 256 of them at a time, the others wait in line.
+ *
+ * The resolver reads /etc/resolv.conf and /etc/hosts once, when it's
+ * initialized. It honors the `nameserver`, `search`, `domain` and the
+ * `timeout`, `attempts` and `ndots` options. Names that are listed in
+ * /etc/hosts are answered from there for A and AAAA queries.
+ *
+ * The resolver doesn't keep the loop alive by itself, pending queries do.
+ * Closing the resolver cancels its queries; their callbacks run with
+ * UV_ECANCELED before the close callback.
+ *
+ * Unix only, uv_resolver_init() returns UV_ENOSYS on Windows.
+ */
+typedef enum {
+  UV_DNS_A = 1,
+  UV_DNS_AAAA = 28,
+  UV_DNS_SRV = 33
+} uv_dns_type;
+
+typedef struct {
+  uv_dns_type type;
+  unsigned int ttl;  /* In seconds. 0 for records from /etc/hosts. */
+  union {
+    struct sockaddr_in in;    /* UV_DNS_A, the port is 0. */
+    struct sockaddr_in6 in6;  /* UV_DNS_AAAA, the port is 0. */
+    struct {
+      unsigned short priority;
+      unsigned short weight;
+      unsigned short port;
+      char target[256];
+    } srv;                    /* UV_DNS_SRV */
+  } u;
+} uv_dns_record_t;
+
+/*
+ * `status` is 0 on success, UV_EAI_NONAME when the name doesn't exist,
+ * UV_EAI_NODATA when it exists but has no records of the requested type,
+ * UV_EAI_AGAIN when no server answered in time, UV_EAI_FAIL when the servers
+ * failed and UV_ECANCELED when the resolver was closed. `records` is only
+ * valid for the duration of the callback.
+ */
+typedef void (*uv_resolve_cb)(uv_resolve_t* req,
+                              int status,
+                              const uv_dns_record_t* records,
+                              unsigned int nrecords);
+
+struct uv_resolver_s {
+  UV_HANDLE_FIELDS
+  UV_RESOLVER_PRIVATE_FIELDS
+};
+
+struct uv_resolve_s {
+  UV_REQ_FIELDS
+  /* read-only */
+  uv_resolver_t* resolver;
+  UV_RESOLVE_PRIVATE_FIELDS
+};
+
+UV_EXTERN int uv_resolver_init(uv_loop_t* loop, uv_resolver_t* resolver);
+
+/*
+ * Replace the name servers from /etc/resolv.conf with `naddrs` addresses,
+ * at most 3. An address with port 0 means port 53. Returns UV_EBUSY while
+ * queries are in flight.
+ */
+UV_EXTERN int uv_resolver_set_servers(uv_resolver_t* resolver,
+                                      const struct sockaddr* addrs[],
+                                      unsigned int naddrs);
+
+/*
+ * How long to wait for an answer from a server, in milliseconds, and how
+ * many times to go through the list of servers before giving up. The
+ * defaults come from the `timeout` and `attempts` options in resolv.conf,
+ * 5000 ms and 2 attempts if it has none.
+ */
+UV_EXTERN int uv_resolver_set_timeout(uv_resolver_t* resolver,
+                                      unsigned int timeout,
+                                      unsigned int attempts);
+
+/*
+ * Look up the records of type `type` for `name`. The name is copied.
+ *
+ * Returns 0 on success or an error code < 0 on failure. The callback is
+ * always called from the event loop, never from within uv_resolve().
+ */
+UV_EXTERN int uv_resolve(uv_resolver_t* resolver,
+                         uv_resolve_t* req,
+                         const char* name,
+                         uv_dns_type type,
+                         uv_resolve_cb cb);
+
+
 /* uv_spawn() options. */
 typedef enum {
   UV_IGNORE         = 0x00,
@@ -2088,6 +2652,13 @@ UV_EXTERN int uv_fs_poll_getpath(uv_fs_poll_t* handle, char* buf, size_t* len);
  * signals will lead to unpredictable behavior and is strongly discouraged.
  * Future versions of libuv may simply reject them.
  *
+ * Also on Linux, a loop reads the signals it watches from a signalfd and
+ * blocks them in the thread that calls uv_signal_start() for as long as it
+ * watches them; they are unblocked again for child processes. Threads that
+ * keep a signal unblocked still receive it through a signal handler. Block
+ * watched signals in your other threads (threadpool threads already are) so
+ * that process-directed signals queue up for the loop and can't be lost.
+ *
  * Reception of some signals is emulated on Windows:
  *
  *   SIGINT is normally delivered when the user presses CTRL+C. However, like
@@ -2375,6 +2946,69 @@ UV_EXTERN int uv_thread_create(uv_thread_t* tid, uv_thread_cb entry, void* arg);
 UV_EXTERN unsigned long uv_thread_self(void);
 UV_EXTERN int uv_thread_join(uv_thread_t *tid);
 
+/*
+ * Callback for uv_loop_group_start() and uv_loop_group_post(). Runs on the
+ * thread of loop `index`.
+ */
+typedef void (*uv_loop_group_cb)(uv_loop_t* loop,
+                                 unsigned int index,
+                                 void* arg);
+
+/*
+ * A loop group runs `nloops` event loops, each on a thread of its own. The
+ * usual way to use it is to have every loop open its own listener for the
+ * same address with UV_TCP_REUSEPORT or UV_UDP_REUSEPORT and let the kernel
+ * balance connections or datagrams over them.
+ */
+struct uv_loop_group_s {
+  /* public */
+  void* data;
+  /* read-only */
+  unsigned int nloops;
+  /* private */
+  void* members;
+  uv_loop_group_cb start_cb;
+  void* start_arg;
+};
+
+/*
+ * Create `nloops` loops. Zero means one per CPU. The loops don't run until
+ * uv_loop_group_start() is called.
+ */
+UV_EXTERN int uv_loop_group_init(uv_loop_group_t* group, unsigned int nloops);
+
+/*
+ * Start a thread for every loop. `cb`, if not NULL, is called on each thread
+ * before its loop runs; that is the place to create the handles that live on
+ * that loop. On error, the group is released as with uv_loop_group_stop().
+ */
+UV_EXTERN int uv_loop_group_start(uv_loop_group_t* group,
+                                  uv_loop_group_cb cb,
+                                  void* arg);
+
+/*
+ * Run `cb` on the thread of loop `index`. Callbacks that are posted to the
+ * same loop run in order. Safe to call from any thread. Returns UV_ECANCELED
+ * once uv_loop_group_stop() has been called.
+ */
+UV_EXTERN int uv_loop_group_post(uv_loop_group_t* group,
+                                 unsigned int index,
+                                 uv_loop_group_cb cb,
+                                 void* arg);
+
+/*
+ * Stop the group: runs the callbacks that have been posted so far, closes
+ * all handles on the loops, waits for the threads to exit and releases the
+ * loops. Handles are closed without a close callback, close those that need
+ * one with uv_loop_group_post() first. Must not be called from one of the
+ * group's own threads.
+ */
+UV_EXTERN int uv_loop_group_stop(uv_loop_group_t* group);
+
+/* Returns loop `index`, or NULL if there is no such loop. */
+UV_EXTERN uv_loop_t* uv_loop_group_get_loop(const uv_loop_group_t* group,
+                                            unsigned int index);
+
 /* The presence of these unions force similar struct layout. */
 #define XX(_, name) uv_ ## name ## _t name;
 union uv_any_handle {
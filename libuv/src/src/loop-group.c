@@ -0,0 +1,302 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "uv-common.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct loop_group_member {
+  uv_loop_t loop;
+  uv_async_t async;
+  uv_mutex_t mutex;
+  uv_thread_t thread;
+  uv_loop_group_t* group;
+  unsigned int index;
+  int started;
+  int stopping;  /* Protected by mutex. */
+  QUEUE posted;  /* Protected by mutex. */
+};
+
+struct loop_group_post {
+  uv_loop_group_cb cb;
+  void* arg;
+  QUEUE member;
+};
+
+static void close_walk_cb(uv_handle_t* handle, void* arg);
+static void async_cb(uv_async_t* handle);
+static void run_thread(void* arg);
+static void release(uv_loop_group_t* group, unsigned int nloops);
+
+
+int uv_loop_group_init(uv_loop_group_t* group, unsigned int nloops) {
+  struct loop_group_member* members;
+  struct loop_group_member* m;
+  uv_cpu_info_t* cpu_infos;
+  unsigned int i;
+  int count;
+  int err;
+
+  if (nloops == 0) {
+    err = uv_cpu_info(&cpu_infos, &count);
+    if (err)
+      return err;
+
+    uv_free_cpu_info(cpu_infos, count);
+    nloops = count > 0 ? count : 1;
+  }
+
+  members = uv__calloc(nloops, sizeof(*members));
+  if (members == NULL)
+    return UV_ENOMEM;
+
+  group->nloops = 0;
+  group->members = members;
+  group->start_cb = NULL;
+  group->start_arg = NULL;
+
+  for (i = 0; i < nloops; i++) {
+    m = members + i;
+    m->group = group;
+    m->index = i;
+    QUEUE_INIT(&m->posted);
+
+    err = uv_mutex_init(&m->mutex);
+    if (err)
+      goto error;
+
+    err = uv_loop_init(&m->loop);
+    if (err) {
+      uv_mutex_destroy(&m->mutex);
+      goto error;
+    }
+
+    err = uv_async_init(&m->loop, &m->async, async_cb);
+    if (err) {
+      uv_loop_close(&m->loop);
+      uv_mutex_destroy(&m->mutex);
+      goto error;
+    }
+
+    group->nloops++;
+  }
+
+  return 0;
+
+error:
+  release(group, group->nloops);
+  return err;
+}
+
+
+int uv_loop_group_start(uv_loop_group_t* group,
+                        uv_loop_group_cb cb,
+                        void* arg) {
+  struct loop_group_member* members;
+  unsigned int i;
+  int err;
+
+  members = group->members;
+
+  /* The threads of a running group read start_cb and start_arg, don't touch
+   * them before we know that there are none.
+   */
+  for (i = 0; i < group->nloops; i++) {
+    if (members[i].started)
+      return UV_EBUSY;
+  }
+
+  group->start_cb = cb;
+  group->start_arg = arg;
+
+  for (i = 0; i < group->nloops; i++) {
+    err = uv_thread_create(&members[i].thread, run_thread, members + i);
+    if (err) {
+      uv_loop_group_stop(group);
+      return err;
+    }
+
+    members[i].started = 1;
+  }
+
+  return 0;
+}
+
+
+int uv_loop_group_post(uv_loop_group_t* group,
+                       unsigned int index,
+                       uv_loop_group_cb cb,
+                       void* arg) {
+  struct loop_group_member* m;
+  struct loop_group_post* p;
+
+  if (index >= group->nloops || cb == NULL)
+    return UV_EINVAL;
+
+  p = uv__malloc(sizeof(*p));
+  if (p == NULL)
+    return UV_ENOMEM;
+
+  p->cb = cb;
+  p->arg = arg;
+
+  m = (struct loop_group_member*) group->members + index;
+  uv_mutex_lock(&m->mutex);
+
+  if (m->stopping) {
+    uv_mutex_unlock(&m->mutex);
+    uv__free(p);
+    return UV_ECANCELED;
+  }
+
+  QUEUE_INSERT_TAIL(&m->posted, &p->member);
+  uv_mutex_unlock(&m->mutex);
+
+  return uv_async_send(&m->async);
+}
+
+
+int uv_loop_group_stop(uv_loop_group_t* group) {
+  struct loop_group_member* m;
+  unsigned int i;
+
+  for (i = 0; i < group->nloops; i++) {
+    m = (struct loop_group_member*) group->members + i;
+
+    uv_mutex_lock(&m->mutex);
+    m->stopping = 1;
+    uv_mutex_unlock(&m->mutex);
+
+    /* Loops that never ran are wound down on this thread. */
+    if (m->started)
+      uv_async_send(&m->async);
+    else
+      async_cb(&m->async);
+  }
+
+  for (i = 0; i < group->nloops; i++) {
+    m = (struct loop_group_member*) group->members + i;
+
+    if (m->started)
+      uv_thread_join(&m->thread);
+    else
+      uv_run(&m->loop, UV_RUN_DEFAULT);
+  }
+
+  release(group, group->nloops);
+
+  return 0;
+}
+
+
+uv_loop_t* uv_loop_group_get_loop(const uv_loop_group_t* group,
+                                  unsigned int index) {
+  if (index >= group->nloops)
+    return NULL;
+
+  return &((struct loop_group_member*) group->members)[index].loop;
+}
+
+
+static void close_walk_cb(uv_handle_t* handle, void* arg) {
+  if (!uv_is_closing(handle))
+    uv_close(handle, NULL);
+}
+
+
+static void async_cb(uv_async_t* handle) {
+  struct loop_group_member* m;
+  struct loop_group_post* p;
+  QUEUE posted;
+  QUEUE* q;
+  int stopping;
+
+  m = container_of(handle, struct loop_group_member, async);
+
+  uv_mutex_lock(&m->mutex);
+  stopping = m->stopping;
+  QUEUE_INIT(&posted);
+  if (!QUEUE_EMPTY(&m->posted)) {
+    q = QUEUE_HEAD(&m->posted);
+    QUEUE_SPLIT(&m->posted, q, &posted);
+  }
+  uv_mutex_unlock(&m->mutex);
+
+  while (!QUEUE_EMPTY(&posted)) {
+    q = QUEUE_HEAD(&posted);
+    QUEUE_REMOVE(q);
+
+    p = QUEUE_DATA(q, struct loop_group_post, member);
+    p->cb(&m->loop, m->index, p->arg);
+    uv__free(p);
+  }
+
+  /* Nothing can be posted anymore once the stop flag is set, everything that
+   * was got handled above. Closing the async handle along with the rest lets
+   * uv_run() return.
+   */
+  if (stopping)
+    uv_walk(&m->loop, close_walk_cb, NULL);
+}
+
+
+static void run_thread(void* arg) {
+  struct loop_group_member* m;
+  uv_loop_group_t* group;
+
+  m = arg;
+  group = m->group;
+
+  if (group->start_cb != NULL)
+    group->start_cb(&m->loop, m->index, group->start_arg);
+
+  uv_run(&m->loop, UV_RUN_DEFAULT);
+}
+
+
+static void release(uv_loop_group_t* group, unsigned int nloops) {
+  struct loop_group_member* m;
+  unsigned int i;
+  int err;
+
+  for (i = 0; i < nloops; i++) {
+    m = (struct loop_group_member*) group->members + i;
+
+    /* Handles are left open when uv_loop_group_init() fails half way or
+     * when a callback called uv_stop().
+     */
+    uv_walk(&m->loop, close_walk_cb, NULL);
+    uv_run(&m->loop, UV_RUN_DEFAULT);
+
+    err = uv_loop_close(&m->loop);
+    assert(err == 0);
+    (void) err;
+
+    uv_mutex_destroy(&m->mutex);
+  }
+
+  uv__free(group->members);
+  group->members = NULL;
+  group->nloops = 0;
+}
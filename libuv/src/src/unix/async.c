@@ -19,70 +19,373 @@
  */
 
 /* This file contains both the uv__async internal infrastructure and the
- * user-facing uv_async_t functions.
+ * user-facing uv_async_t and uv_channel_t functions.
  */
 
 #include "uv.h"
 #include "internal.h"
+#include "atomic-ops.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>  /* snprintf() */
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sched.h>  /* sched_yield() */
 #include <unistd.h>
 
 static void uv__async_event(uv_loop_t* loop,
                             struct uv__async* w,
                             unsigned int nevents);
-static int uv__async_make_pending(int* pending);
+static void uv__async_busy_add(int* busy, int delta);
+static void uv__async_spin(uv_async_t* handle);
+static void uv__async_push(uv_async_t* handle);
+static void uv__async_spill(uv_loop_t* loop);
 static int uv__async_eventfd(void);
+static void uv__channel_drain(uv_async_t* handle);
 
+/* Upper bound on the number of messages per uv_channel_cb call. */
+#define UV__CHANNEL_BATCH 64
 
-int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
+struct uv__channel_cell {
+  unsigned long seq;
+  void* msg;
+};
+
+
+static int uv__async_handle_init(uv_loop_t* loop,
+                                 uv_async_t* handle,
+                                 uv_handle_type type,
+                                 uv_async_cb async_cb) {
   int err;
 
   err = uv__async_start(loop, &loop->async_watcher, uv__async_event);
   if (err)
     return err;
 
-  uv__handle_init(loop, (uv_handle_t*)handle, UV_ASYNC);
+  uv__handle_init(loop, (uv_handle_t*)handle, type);
   handle->async_cb = async_cb;
   handle->pending = 0;
+  handle->pending_next = NULL;
+  handle->busy = 0;
 
-  QUEUE_INSERT_TAIL(&loop->async_handles, &handle->queue);
+  QUEUE_INIT(&handle->queue);
   uv__handle_start(handle);
 
   return 0;
 }
 
 
+int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
+  return uv__async_handle_init(loop, handle, UV_ASYNC, async_cb);
+}
+
+
+/* `pending` is 0 when the handle is idle, 1 when it's on the stack or the
+ * loop's queue and 2 once uv_close() has been called. The last value sticks,
+ * a send to a closing handle is a no-op.
+ *
+ * A sender that won the 0 -> 1 race still has to push the handle. It holds
+ * `busy` while it does that so uv__async_close() can wait it out, otherwise
+ * the handle could end up on the stack after it has been closed and freed.
+ */
 int uv_async_send(uv_async_t* handle) {
-  if (uv__async_make_pending(&handle->pending) == 0)
-    uv__async_send(&handle->loop->async_watcher);
+  /* Do a cheap read first. */
+  if (ACCESS_ONCE(int, handle->pending) != 0)
+    return 0;
+
+  /* The locked add orders it before the flag flip. If uv__async_close() sets
+   * the flag first our compare-and-swap fails, if it comes after it sees the
+   * busy count.
+   */
+  uv__async_busy_add(&handle->busy, 1);
+
+  if (cmpxchgi(&handle->pending, 0, 1) == 0)
+    uv__async_push(handle);
+
+  uv__async_busy_add(&handle->busy, -1);
 
   return 0;
 }
 
 
 void uv__async_close(uv_async_t* handle) {
+  int pending;
+
+  /* Turn away new senders. */
+  do
+    pending = ACCESS_ONCE(int, handle->pending);
+  while (cmpxchgi(&handle->pending, pending, 2) != pending);
+
+  /* Wait for the ones that got in before us to finish their push. */
+  uv__async_spin(handle);
+
+  /* A pending handle may still be on the stack, where it can't be unlinked.
+   * Move everything over to the loop's queue first.
+   */
+  if (pending != 0)
+    uv__async_spill(handle->loop);
+
   QUEUE_REMOVE(&handle->queue);
+  QUEUE_INIT(&handle->queue);
   uv__handle_stop(handle);
 }
 
 
+static void uv__async_busy_add(int* busy, int delta) {
+  int val;
+
+  do
+    val = ACCESS_ONCE(int, *busy);
+  while (cmpxchgi(busy, val, val + delta) != val);
+}
+
+
+static void uv__async_spin(uv_async_t* handle) {
+  int i;
+
+  /* A sender holds `busy` for a compare-and-swap and at most one write(2),
+   * spinning is cheaper than anything that involves the kernel. Yield now and
+   * then in case the sender got preempted.
+   */
+  for (;;) {
+    for (i = 0; i < 997; i++) {
+      if (ACCESS_ONCE(int, handle->busy) == 0)
+        return;
+      cpu_relax();
+    }
+
+    sched_yield();
+  }
+}
+
+
+/* Signalled handles are pushed onto loop->async_stack, a lock-free stack
+ * linked through pending_next. The pending flag guarantees that a handle is
+ * on the stack at most once. The loop thread takes the whole stack at once,
+ * that sidesteps the ABA problem of lock-free pops.
+ *
+ * Only the sender that finds the stack empty writes to the eventfd, the
+ * others know that the loop is going to take their handle along.
+ */
+static void uv__async_push(uv_async_t* handle) {
+  uv_loop_t* loop;
+  void* head;
+  void* prev;
+
+  loop = handle->loop;
+  head = loop->async_stack;  /* A stale value just costs a retry. */
+
+  for (;;) {
+    handle->pending_next = head;
+    prev = cmpxchgp(&loop->async_stack, head, handle);
+    if (prev == head)
+      break;
+    head = prev;
+  }
+
+  if (head == NULL)
+    uv__async_send(&loop->async_watcher);
+}
+
+
+/* Move the handles on the stack to loop->async_pending, oldest first. */
+static void uv__async_spill(uv_loop_t* loop) {
+  uv_async_t* h;
+  void* head;
+  void* prev;
+  QUEUE queue;
+
+  head = loop->async_stack;
+  while (head != NULL) {
+    prev = cmpxchgp(&loop->async_stack, head, NULL);
+    if (prev == head)
+      break;
+    head = prev;
+  }
+
+  if (head == NULL)
+    return;
+
+  QUEUE_INIT(&queue);
+  for (h = head; h != NULL; h = h->pending_next)
+    QUEUE_INSERT_HEAD(&queue, &h->queue);
+
+  QUEUE_ADD(&loop->async_pending, &queue);
+}
+
+
+/* The ring is a bounded multi-producer queue after Dmitry Vyukov's design.
+ * Every cell carries a sequence number that tells whose turn it is: a
+ * producer may fill the cell at position `pos` when seq == pos, the consumer
+ * may take it when seq == pos + 1. Producers claim a position by bumping the
+ * head with a compare-and-swap, the loop thread is the only consumer and
+ * doesn't need atomic operations for the tail.
+ */
+int uv_channel_init(uv_loop_t* loop,
+                    uv_channel_t* channel,
+                    unsigned int capacity,
+                    uv_channel_cb cb) {
+  struct uv__channel_cell* cells;
+  unsigned long size;
+  unsigned long i;
+  int err;
+
+  if (capacity == 0 || capacity > (UINT_MAX >> 1) + 1 || cb == NULL)
+    return -EINVAL;
+
+  for (size = 1; size < capacity; size <<= 1);
+
+  if (size > (size_t) -1 / sizeof(*cells))
+    return -ENOMEM;
+
+  cells = uv__malloc(size * sizeof(*cells));
+  if (cells == NULL)
+    return -ENOMEM;
+
+  for (i = 0; i < size; i++)
+    cells[i].seq = i;
+
+  err = uv__async_handle_init(loop,
+                              (uv_async_t*) channel,
+                              UV_CHANNEL,
+                              uv__channel_drain);
+  if (err) {
+    uv__free(cells);
+    return err;
+  }
+
+  channel->channel_cb = cb;
+  channel->cells = cells;
+  channel->mask = size - 1;
+  channel->head = 0;
+  channel->tail = 0;
+
+  return 0;
+}
+
+
+int uv_channel_send(uv_channel_t* channel, void* msg) {
+  struct uv__channel_cell* cells;
+  struct uv__channel_cell* cell;
+  unsigned long pos;
+  unsigned long seq;
+  long diff;
+
+  cells = channel->cells;
+  pos = ACCESS_ONCE(unsigned long, channel->head);
+
+  for (;;) {
+    cell = cells + (pos & channel->mask);
+    seq = load_acquire(&cell->seq);
+    diff = (long) (seq - pos);
+
+    if (diff == 0) {
+      seq = (unsigned long) cmpxchgl((long*) &channel->head,
+                                     (long) pos,
+                                     (long) (pos + 1));
+      if (seq == pos)
+        break;
+      pos = seq;
+    } else if (diff < 0) {
+      return -EAGAIN;  /* Full, the consumer hasn't caught up yet. */
+    } else {
+      pos = ACCESS_ONCE(unsigned long, channel->head);
+    }
+  }
+
+  cell->msg = msg;
+  store_release(&cell->seq, pos + 1);
+
+  /* The loop clears the pending flag before it drains the ring. Make sure
+   * that either it sees the message or we see the cleared flag.
+   */
+  memory_barrier();
+  uv_async_send((uv_async_t*) channel);
+
+  return 0;
+}
+
+
+void uv__channel_close(uv_channel_t* channel) {
+  uv__async_close((uv_async_t*) channel);
+  uv__free(channel->cells);
+  channel->cells = NULL;
+}
+
+
+static void uv__channel_drain(uv_async_t* handle) {
+  struct uv__channel_cell* cells;
+  struct uv__channel_cell* cell;
+  uv_channel_t* channel;
+  void* msgs[UV__CHANNEL_BATCH];
+  unsigned long budget;
+  unsigned long pos;
+  unsigned int n;
+
+  channel = (uv_channel_t*) handle;
+  cells = channel->cells;
+
+  /* Pairs with the barrier in uv_channel_send(). */
+  memory_barrier();
+
+  /* Take at most one ring's worth of messages per wakeup so busy producers
+   * can't starve the rest of the loop.
+   */
+  budget = channel->mask + 1;
+
+  while (budget > 0) {
+    pos = channel->tail;
+
+    for (n = 0; n < ARRAY_SIZE(msgs) && n < budget; n++) {
+      cell = cells + (pos & channel->mask);
+      if (load_acquire(&cell->seq) != pos + 1)
+        break;
+      msgs[n] = cell->msg;
+      store_release(&cell->seq, pos + channel->mask + 1);
+      pos++;
+    }
+
+    channel->tail = pos;
+
+    if (n == 0)
+      return;
+
+    budget -= n;
+    channel->channel_cb(channel, msgs, n);
+
+    if (uv__is_closing(channel))
+      return;
+  }
+
+  /* Out of budget. Come back for the rest on the next loop iteration. */
+  uv_async_send(handle);
+}
+
+
 static void uv__async_event(uv_loop_t* loop,
                             struct uv__async* w,
                             unsigned int nevents) {
   QUEUE* q;
   uv_async_t* h;
 
-  QUEUE_FOREACH(q, &loop->async_handles) {
+  /* Handles that are signalled while we're running callbacks go onto the
+   * stack and are picked up on the next loop iteration.
+   */
+  uv__async_spill(loop);
+
+  while (!QUEUE_EMPTY(&loop->async_pending)) {
+    q = QUEUE_HEAD(&loop->async_pending);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
     h = QUEUE_DATA(q, uv_async_t, queue);
 
-    if (h->pending == 0)
-      continue;
-    h->pending = 0;
+    /* Clear the flag with a locked instruction, it orders the flag before
+     * whatever the callback is going to read. A send that comes after this
+     * pushes the handle again.
+     */
+    cmpxchgi(&h->pending, 1, 0);
 
     if (h->async_cb == NULL)
       continue;
@@ -91,37 +394,6 @@ static void uv__async_event(uv_loop_t* loop,
 }
 
 
-static int uv__async_make_pending(int* pending) {
-  /* Do a cheap read first. */
-  if (ACCESS_ONCE(int, *pending) != 0)
-    return 1;
-
-  /* Micro-optimization: use atomic memory operations to detect if we've been
-   * preempted by another thread and don't have to make an expensive syscall.
-   * This speeds up the heavily contended case by about 1-2% and has little
-   * if any impact on the non-contended case.
-   *
-   * Use XCHG instead of the CMPXCHG that __sync_val_compare_and_swap() emits
-   * on x86, it's about 4x faster. It probably makes zero difference in the
-   * grand scheme of things but I'm OCD enough not to let this one pass.
-   */
-#if defined(__i386__) || defined(__x86_64__)
-  {
-    unsigned int val = 1;
-    __asm__ __volatile__ ("xchgl %0, %1"
-                         : "+r" (val)
-                         : "m"  (*pending));
-    return val != 0;
-  }
-#elif defined(__GNUC__) && (__GNUC__ > 4 || __GNUC__ == 4 && __GNUC_MINOR__ > 0)
-  return __sync_val_compare_and_swap(pending, 0, 1) != 0;
-#else
-  ACCESS_ONCE(int, *pending) = 1;
-  return 0;
-#endif
-}
-
-
 static void uv__async_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   struct uv__async* wa;
   char buf[1024];
@@ -20,7 +20,11 @@
 
 UV_UNUSED(static int cmpxchgi(int* ptr, int oldval, int newval));
 UV_UNUSED(static long cmpxchgl(long* ptr, long oldval, long newval));
+UV_UNUSED(static void* cmpxchgp(void** ptr, void* oldval, void* newval));
 UV_UNUSED(static void cpu_relax(void));
+UV_UNUSED(static void memory_barrier(void));
+UV_UNUSED(static unsigned long load_acquire(unsigned long* ptr));
+UV_UNUSED(static void store_release(unsigned long* ptr, unsigned long val));
 
 /* Prefer hand-rolled assembly over the gcc builtins because the latter also
  * issue full memory barriers.
@@ -51,10 +55,59 @@ UV_UNUSED(static long cmpxchgl(long* ptr, long oldval, long newval)) {
 #endif
 }
 
+UV_UNUSED(static void* cmpxchgp(void** ptr, void* oldval, void* newval)) {
+#if defined(__i386__) || defined(__x86_64__)
+  void* out;
+  __asm__ __volatile__ ("lock; cmpxchg %2, %1;"
+                        : "=a" (out), "+m" (*(void* volatile*) ptr)
+                        : "r" (newval), "0" (oldval)
+                        : "memory");
+  return out;
+#else
+  return __sync_val_compare_and_swap(ptr, oldval, newval);
+#endif
+}
+
 UV_UNUSED(static void cpu_relax(void)) {
 #if defined(__i386__) || defined(__x86_64__)
   __asm__ __volatile__ ("rep; nop");  /* a.k.a. PAUSE */
 #endif
 }
 
+/* Orders earlier stores before later loads, which is the one reordering that
+ * x86 does.
+ */
+UV_UNUSED(static void memory_barrier(void)) {
+#if defined(__x86_64__)
+  __asm__ __volatile__ ("lock; orq $0, (%%rsp)" ::: "memory");
+#elif defined(__i386__)
+  __asm__ __volatile__ ("lock; orl $0, (%%esp)" ::: "memory");
+#else
+  __sync_synchronize();
+#endif
+}
+
+/* x86 doesn't reorder loads with other loads or stores with other stores,
+ * a compiler barrier is enough there.
+ */
+UV_UNUSED(static unsigned long load_acquire(unsigned long* ptr)) {
+  unsigned long val;
+  val = *(volatile unsigned long*) ptr;
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__ ("" ::: "memory");
+#else
+  __sync_synchronize();
+#endif
+  return val;
+}
+
+UV_UNUSED(static void store_release(unsigned long* ptr, unsigned long val)) {
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__ ("" ::: "memory");
+#else
+  __sync_synchronize();
+#endif
+  *(volatile unsigned long*) ptr = val;
+}
+
 #endif  /* UV_ATOMIC_OPS_H_ */
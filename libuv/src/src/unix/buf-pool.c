@@ -0,0 +1,243 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define UV__BUF_POOL_SIZE (64 * 1024)
+#define UV__BUF_POOL_MAX_FREE 16
+
+struct uv__buf_pool;
+
+/* Sits in front of the bytes that are handed out. The union keeps the data
+ * suitably aligned for any type.
+ */
+union uv__pool_buf {
+  struct {
+    struct uv__buf_pool* pool;
+    union uv__pool_buf* next;
+    unsigned int refcount;
+  } h;
+  double d;
+  void* p;
+  long l;
+};
+
+struct uv__buf_pool {
+  union uv__pool_buf* free_list;
+  size_t buf_size;
+  unsigned int max_free;
+  unsigned int nfree;
+  unsigned int nused;
+  uint64_t nallocs;
+  uint64_t nmisses;
+  int closed;
+};
+
+
+static union uv__pool_buf* uv__pool_buf_get(const uv_buf_t* buf) {
+  assert(buf->base != NULL);
+  return (union uv__pool_buf*) buf->base - 1;
+}
+
+
+static void uv__buf_pool_trim(struct uv__buf_pool* pool) {
+  union uv__pool_buf* b;
+
+  while (pool->nfree > pool->max_free) {
+    b = pool->free_list;
+    pool->free_list = b->h.next;
+    pool->nfree--;
+    uv__free(b);
+  }
+}
+
+
+static struct uv__buf_pool* uv__buf_pool_get(uv_loop_t* loop) {
+  struct uv__buf_pool* pool;
+
+  pool = loop->buf_pool;
+  if (pool != NULL)
+    return pool;
+
+  pool = uv__calloc(1, sizeof(*pool));
+  if (pool == NULL)
+    return NULL;
+
+  pool->buf_size = UV__BUF_POOL_SIZE;
+  pool->max_free = UV__BUF_POOL_MAX_FREE;
+  loop->buf_pool = pool;
+
+  return pool;
+}
+
+
+int uv_loop_set_buf_pool(uv_loop_t* loop, size_t buf_size, unsigned int max_free) {
+  struct uv__buf_pool* pool;
+
+  if (buf_size == 0)
+    buf_size = UV__BUF_POOL_SIZE;
+
+  /* uv_buf_t.len is an unsigned int on some platforms. */
+  if (buf_size > (unsigned int) -1)
+    return -EINVAL;
+
+  pool = uv__buf_pool_get(loop);
+  if (pool == NULL)
+    return -ENOMEM;
+
+  if (buf_size != pool->buf_size) {
+    if (pool->nused != 0)
+      return -EBUSY;
+
+    pool->max_free = 0;
+    uv__buf_pool_trim(pool);
+    pool->buf_size = buf_size;
+  }
+
+  pool->max_free = max_free;
+  uv__buf_pool_trim(pool);
+
+  return 0;
+}
+
+
+void uv_buf_pool_alloc(uv_handle_t* handle,
+                       size_t suggested_size,
+                       uv_buf_t* buf) {
+  struct uv__buf_pool* pool;
+  union uv__pool_buf* b;
+
+  *buf = uv_buf_init(NULL, 0);
+
+  pool = uv__buf_pool_get(handle->loop);
+  if (pool == NULL)
+    return;
+
+  pool->nallocs++;
+  b = pool->free_list;
+
+  if (b != NULL) {
+    pool->free_list = b->h.next;
+    pool->nfree--;
+  } else {
+    pool->nmisses++;
+    b = uv__malloc(sizeof(*b) + pool->buf_size);
+    if (b == NULL)
+      return;  /* Zero-length buffer, read_cb gets UV_ENOBUFS. */
+    b->h.pool = pool;
+  }
+
+  b->h.next = NULL;
+  b->h.refcount = 1;
+  pool->nused++;
+
+  *buf = uv_buf_init((char*) (b + 1), pool->buf_size);
+}
+
+
+void uv_buf_pool_ref(const uv_buf_t* buf) {
+  union uv__pool_buf* b;
+
+  b = uv__pool_buf_get(buf);
+  assert(b->h.refcount > 0);
+  b->h.refcount++;
+}
+
+
+void uv_buf_pool_unref(const uv_buf_t* buf) {
+  struct uv__buf_pool* pool;
+  union uv__pool_buf* b;
+
+  if (buf->base == NULL)
+    return;
+
+  b = uv__pool_buf_get(buf);
+  assert(b->h.refcount > 0);
+  if (--b->h.refcount > 0)
+    return;
+
+  pool = b->h.pool;
+  assert(pool->nused > 0);
+  pool->nused--;
+
+  if (pool->closed) {
+    /* The loop is gone, the last buffer takes the pool with it. */
+    uv__free(b);
+    if (pool->nused == 0)
+      uv__free(pool);
+    return;
+  }
+
+  if (pool->nfree >= pool->max_free) {
+    uv__free(b);
+    return;
+  }
+
+  b->h.next = pool->free_list;
+  pool->free_list = b;
+  pool->nfree++;
+}
+
+
+int uv_buf_pool_stats(const uv_loop_t* loop, uv_buf_pool_stats_t* stats) {
+  const struct uv__buf_pool* pool;
+
+  pool = loop->buf_pool;
+  if (pool == NULL) {
+    stats->buf_size = UV__BUF_POOL_SIZE;
+    stats->in_use = 0;
+    stats->free = 0;
+    stats->allocs = 0;
+    stats->misses = 0;
+    return 0;
+  }
+
+  stats->buf_size = pool->buf_size;
+  stats->in_use = pool->nused;
+  stats->free = pool->nfree;
+  stats->allocs = pool->nallocs;
+  stats->misses = pool->nmisses;
+
+  return 0;
+}
+
+
+void uv__buf_pool_close(uv_loop_t* loop) {
+  struct uv__buf_pool* pool;
+
+  pool = loop->buf_pool;
+  if (pool == NULL)
+    return;
+
+  loop->buf_pool = NULL;
+  pool->max_free = 0;
+  uv__buf_pool_trim(pool);
+
+  /* Buffers the user still holds on to free the pool when they're let go. */
+  if (pool->nused == 0)
+    uv__free(pool);
+  else
+    pool->closed = 1;
+}
@@ -130,6 +130,10 @@ void uv_close(uv_handle_t* handle, uv_close_cb close_cb) {
     uv__async_close((uv_async_t*)handle);
     break;
 
+  case UV_CHANNEL:
+    uv__channel_close((uv_channel_t*)handle);
+    break;
+
   case UV_TIMER:
     uv__timer_close((uv_timer_t*)handle);
     break;
@@ -150,6 +154,10 @@ void uv_close(uv_handle_t* handle, uv_close_cb close_cb) {
     uv__fs_poll_close((uv_fs_poll_t*)handle);
     break;
 
+  case UV_RESOLVER:
+    uv__resolver_close((uv_resolver_t*)handle);
+    break;
+
   case UV_SIGNAL:
     uv__signal_close((uv_signal_t*) handle);
     /* Signal handles may not be closed immediately. The signal code will */
@@ -215,6 +223,7 @@ static void uv__finish_close(uv_handle_t* handle) {
     case UV_CHECK:
     case UV_IDLE:
     case UV_ASYNC:
+    case UV_CHANNEL:
     case UV_TIMER:
     case UV_PROCESS:
     case UV_FS_EVENT:
@@ -233,6 +242,10 @@ static void uv__finish_close(uv_handle_t* handle) {
       uv__udp_finish_close((uv_udp_t*)handle);
       break;
 
+    case UV_RESOLVER:
+      uv__resolver_destroy((uv_resolver_t*)handle);
+      break;
+
     default:
       assert(0);
       break;
@@ -282,6 +295,9 @@ int uv_backend_timeout(const uv_loop_t* loop) {
   if (!QUEUE_EMPTY(&loop->idle_handles))
     return 0;
 
+  if (!QUEUE_EMPTY(&loop->pending_queue))
+    return 0;
+
   if (loop->closing_handles)
     return 0;
 
@@ -311,20 +327,33 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
 
   while (r != 0 && loop->stop_flag == 0) {
     UV_TICK_START(loop, mode);
+    uv__metrics_iteration(loop);
 
     uv__update_time(loop);
+    UV_TIMERS_START(loop);
     uv__run_timers(loop);
+    UV_TIMERS_STOP(loop);
+    UV_PENDING_START(loop);
     uv__run_pending(loop);
+    UV_PENDING_STOP(loop);
+    UV_IDLE_START(loop);
     uv__run_idle(loop);
+    UV_IDLE_STOP(loop);
+    UV_PREPARE_START(loop);
     uv__run_prepare(loop);
+    UV_PREPARE_STOP(loop);
 
     timeout = 0;
     if ((mode & UV_RUN_NOWAIT) == 0)
       timeout = uv_backend_timeout(loop);
 
     uv__io_poll(loop, timeout);
+    UV_CHECK_START(loop);
     uv__run_check(loop);
+    UV_CHECK_STOP(loop);
+    UV_CLOSING_START(loop);
     uv__run_closing_handles(loop);
+    UV_CLOSING_STOP(loop);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progess: at least one callback must have
@@ -336,7 +365,9 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        * the check.
        */
       uv__update_time(loop);
+      UV_TIMERS_START(loop);
       uv__run_timers(loop);
+      UV_TIMERS_STOP(loop);
     }
 
     r = uv__loop_alive(loop);
@@ -352,6 +383,8 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
   if (loop->stop_flag != 0)
     loop->stop_flag = 0;
 
+  uv__metrics_run_stop(loop);
+
   return r;
 }
 
@@ -664,11 +697,22 @@ void uv_disable_stdio_inheritance(void) {
 
 
 static void uv__run_pending(uv_loop_t* loop) {
+  QUEUE pq;
   QUEUE* q;
   uv__io_t* w;
 
-  while (!QUEUE_EMPTY(&loop->pending_queue)) {
-    q = QUEUE_HEAD(&loop->pending_queue);
+  if (QUEUE_EMPTY(&loop->pending_queue))
+    return;
+
+  /* Watchers that feed themselves again from their callback, like a UDP
+   * handle whose send callback queues the next datagram, run on the next
+   * loop iteration. Otherwise they'd starve timers and I/O.
+   */
+  q = QUEUE_HEAD(&loop->pending_queue);
+  QUEUE_SPLIT(&loop->pending_queue, q, &pq);
+
+  while (!QUEUE_EMPTY(&pq)) {
+    q = QUEUE_HEAD(&pq);
     QUEUE_REMOVE(q);
     QUEUE_INIT(q);
 
@@ -709,8 +753,8 @@ static void maybe_resize(uv_loop_t* loop, unsigned int len) {
   }
 
   nwatchers = next_power_of_two(len + 2) - 2;
-  watchers = realloc(loop->watchers,
-                     (nwatchers + 2) * sizeof(loop->watchers[0]));
+  watchers = uv__realloc(loop->watchers,
+                         (nwatchers + 2) * sizeof(loop->watchers[0]));
 
   if (watchers == NULL)
     abort();
@@ -737,12 +781,21 @@ void uv__io_init(uv__io_t* w, uv__io_cb cb, int fd) {
 #if defined(UV_HAVE_KQUEUE)
   w->rcount = 0;
   w->wcount = 0;
+#elif defined(__linux__)
+  QUEUE_INIT(&w->edge_queue);
+  w->edge = 0;
+  w->ready = 0;
+  w->exclusive = 0;
 #endif /* defined(UV_HAVE_KQUEUE) */
 }
 
 
+/* Besides UV__POLLIN and UV__POLLOUT, a watcher can ask for UV__POLLERR to
+ * stay registered while it only waits for messages on the socket's error
+ * queue. Only the linux backends support that.
+ */
 void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
-  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT)));
+  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT | UV__POLLERR)));
   assert(0 != events);
   assert(w->fd >= 0);
   assert(w->fd < INT_MAX);
@@ -754,8 +807,12 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   /* The event ports backend needs to rearm all file descriptors on each and
    * every tick of the event loop but the other backends allow us to
    * short-circuit here if the event mask is unchanged.
+   *
+   * A watcher that is being restarted still has to go through the watcher
+   * queue, the epoll backend keeps its old registration around after the
+   * watcher was stopped, see uv__io_stop().
    */
-  if (w->events == w->pevents) {
+  if (w->events == w->pevents && loop->watchers[w->fd] == w) {
     if (w->events == 0 && !QUEUE_EMPTY(&w->watcher_queue)) {
       QUEUE_REMOVE(&w->watcher_queue);
       QUEUE_INIT(&w->watcher_queue);
@@ -775,7 +832,7 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
 
 void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
-  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT)));
+  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT | UV__POLLERR)));
   assert(0 != events);
 
   if (w->fd == -1)
@@ -798,7 +855,22 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
       assert(loop->nfds > 0);
       loop->watchers[w->fd] = NULL;
       loop->nfds--;
+#if defined(__linux__)
+      /* The epoll backend updates the kernel's interest set lazily. Leave the
+       * file descriptor registered so a subsequent uv__io_start() with the
+       * same events doesn't need a system call. Spurious events are squelched
+       * in uv__io_poll().
+       */
+      if (loop->iou != NULL) {
+        uv__iou_io_stop(loop, w->fd);
+        w->events = 0;
+      } else if (w->exclusive) {
+        uv__epoll_io_stop(loop, w->fd);
+        w->events = 0;
+      }
+#else
       w->events = 0;
+#endif
     }
   }
   else if (QUEUE_EMPTY(&w->watcher_queue))
@@ -807,11 +879,17 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
 
 void uv__io_close(uv_loop_t* loop, uv__io_t* w) {
-  uv__io_stop(loop, w, UV__POLLIN | UV__POLLOUT);
+  uv__io_stop(loop, w, UV__POLLIN | UV__POLLOUT | UV__POLLERR);
   QUEUE_REMOVE(&w->pending_queue);
+#if defined(__linux__)
+  QUEUE_REMOVE(&w->edge_queue);
+  QUEUE_INIT(&w->edge_queue);
+  w->ready = 0;
+#endif
 
   /* Remove stale events for this file descriptor */
   uv__platform_invalidate_fd(loop, w->fd);
+  w->events = 0;
 }
 
 
@@ -822,7 +900,7 @@ void uv__io_feed(uv_loop_t* loop, uv__io_t* w) {
 
 
 int uv__io_active(const uv__io_t* w, unsigned int events) {
-  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT)));
+  assert(0 == (events & ~(UV__POLLIN | UV__POLLOUT | UV__POLLERR)));
   assert(0 != events);
   return 0 != (w->pevents & events);
 }
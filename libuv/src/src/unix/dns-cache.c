@@ -0,0 +1,587 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UV__DNS_CACHE_MAX_ENTRIES 1024
+#define UV__DNS_CACHE_MIN_BUCKETS 64
+
+/* Every caller gets its own copy of a cached result, in a layout of our own
+ * that uv_freeaddrinfo() recognizes. The address of a node sits behind a tag
+ * at an offset where no libc puts it, so telling a copy from a getaddrinfo()
+ * result takes a pointer comparison before anything is read.
+ */
+struct uv__dns_node {
+  struct addrinfo ai;
+  const void* tag;
+  struct sockaddr_storage addr;
+};
+
+static const char uv__dns_tag;
+
+struct uv__dns_entry {
+  struct uv__dns_entry* next;  /* Hash chain. */
+  void* lru_queue[2];
+  void* waiters[2];
+  /* Non-NULL while the lookup runs on the threadpool. */
+  uv_getaddrinfo_t* leader;
+  struct addrinfo* res;
+  uint64_t expires;
+  unsigned int hash;
+  int status;
+  int nohints;
+  int flags;
+  int family;
+  int socktype;
+  int protocol;
+  char* hostname;
+  char* service;
+};
+
+struct uv__dns_cache {
+  struct uv__dns_entry** buckets;
+  unsigned int nbuckets;
+  unsigned int nentries;
+  unsigned int max_entries;
+  uint64_t ttl;
+  uint64_t negative_ttl;
+  void* lru_queue[2];
+  /* Requests answered from the cache, run from the pending queue. */
+  void* ready_queue[2];
+  unsigned int nready;
+  uv__io_t ready_watcher;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t coalesced;
+  uint64_t evictions;
+};
+
+
+static unsigned int uv__dns_hash_str(unsigned int h, const char* s) {
+  if (s == NULL)
+    return h * 16777619;
+
+  for (; *s != '\0'; s++)
+    h = (h ^ (unsigned char) *s) * 16777619;
+
+  return (h ^ 0xff) * 16777619;
+}
+
+
+static unsigned int uv__dns_hash(const uv_getaddrinfo_t* req) {
+  unsigned int h;
+
+  h = 2166136261u;
+  h = uv__dns_hash_str(h, req->hostname);
+  h = uv__dns_hash_str(h, req->service);
+
+  if (req->hints != NULL) {
+    h = (h ^ req->hints->ai_flags) * 16777619;
+    h = (h ^ req->hints->ai_family) * 16777619;
+    h = (h ^ req->hints->ai_socktype) * 16777619;
+    h = (h ^ req->hints->ai_protocol) * 16777619;
+  }
+
+  return h;
+}
+
+
+static int uv__dns_str_equal(const char* a, const char* b) {
+  if (a == NULL || b == NULL)
+    return a == b;
+  return strcmp(a, b) == 0;
+}
+
+
+static int uv__dns_entry_match(const struct uv__dns_entry* e,
+                               const uv_getaddrinfo_t* req,
+                               unsigned int hash) {
+  const struct addrinfo* hints;
+
+  if (e->hash != hash)
+    return 0;
+
+  hints = req->hints;
+
+  if (hints == NULL) {
+    if (!e->nohints)
+      return 0;
+  } else if (e->nohints ||
+             e->flags != hints->ai_flags ||
+             e->family != hints->ai_family ||
+             e->socktype != hints->ai_socktype ||
+             e->protocol != hints->ai_protocol) {
+    return 0;
+  }
+
+  return uv__dns_str_equal(e->hostname, req->hostname) &&
+         uv__dns_str_equal(e->service, req->service);
+}
+
+
+static struct uv__dns_entry* uv__dns_entry_new(const uv_getaddrinfo_t* req,
+                                               unsigned int hash) {
+  struct uv__dns_entry* e;
+  size_t hostname_len;
+  size_t service_len;
+  char* p;
+
+  hostname_len = req->hostname ? strlen(req->hostname) + 1 : 0;
+  service_len = req->service ? strlen(req->service) + 1 : 0;
+
+  e = uv__malloc(sizeof(*e) + hostname_len + service_len);
+  if (e == NULL)
+    return NULL;
+
+  memset(e, 0, sizeof(*e));
+  QUEUE_INIT(&e->lru_queue);
+  QUEUE_INIT(&e->waiters);
+  e->hash = hash;
+  e->nohints = req->hints == NULL;
+
+  if (req->hints != NULL) {
+    e->flags = req->hints->ai_flags;
+    e->family = req->hints->ai_family;
+    e->socktype = req->hints->ai_socktype;
+    e->protocol = req->hints->ai_protocol;
+  }
+
+  p = (char*) (e + 1);
+
+  if (req->hostname != NULL) {
+    e->hostname = memcpy(p, req->hostname, hostname_len);
+    p += hostname_len;
+  }
+
+  if (req->service != NULL)
+    e->service = memcpy(p, req->service, service_len);
+
+  return e;
+}
+
+
+
+/* One block per copy: the nodes, then the canonical names. */
+static struct addrinfo* uv__dns_copy(const struct addrinfo* ai, int* err) {
+  const struct addrinfo* p;
+  struct uv__dns_node* nodes;
+  struct uv__dns_node* node;
+  size_t count;
+  size_t len;
+  char* s;
+
+  count = 0;
+  len = 0;
+
+  for (p = ai; p != NULL; p = p->ai_next) {
+    assert(p->ai_addrlen <= sizeof(nodes->addr));
+    count++;
+    if (p->ai_canonname != NULL)
+      len += strlen(p->ai_canonname) + 1;
+  }
+
+  nodes = uv__malloc(count * sizeof(*nodes) + len);
+  if (nodes == NULL) {
+    *err = UV_EAI_MEMORY;
+    return NULL;
+  }
+
+  s = (char*) (nodes + count);
+
+  for (p = ai, node = nodes; p != NULL; p = p->ai_next, node++) {
+    node->ai = *p;
+    node->ai.ai_next = p->ai_next != NULL ? &node[1].ai : NULL;
+    node->ai.ai_addr = (struct sockaddr*) &node->addr;
+    node->tag = &uv__dns_tag;
+    memcpy(&node->addr, p->ai_addr, p->ai_addrlen);
+
+    if (p->ai_canonname != NULL) {
+      len = strlen(p->ai_canonname) + 1;
+      node->ai.ai_canonname = memcpy(s, p->ai_canonname, len);
+      s += len;
+    }
+  }
+
+  return &nodes->ai;
+}
+
+
+int uv__dns_cache_freeaddrinfo(struct addrinfo* ai) {
+  struct uv__dns_node* node;
+
+  node = (struct uv__dns_node*) ai;
+
+  if ((char*) ai->ai_addr != (char*) ai + offsetof(struct uv__dns_node, addr))
+    return 0;
+
+  if (node->tag != &uv__dns_tag)
+    return 0;
+
+  uv__free(node);
+  return 1;
+}
+
+
+static void uv__dns_entry_remove(struct uv__dns_cache* cache,
+                                 struct uv__dns_entry* e) {
+  struct uv__dns_entry** pp;
+
+  assert(e->leader == NULL);
+  assert(QUEUE_EMPTY(&e->waiters));
+
+  pp = cache->buckets + (e->hash & (cache->nbuckets - 1));
+  while (*pp != e)
+    pp = &(*pp)->next;
+  *pp = e->next;
+
+  QUEUE_REMOVE(&e->lru_queue);
+  cache->nentries--;
+
+  if (e->res != NULL)
+    freeaddrinfo(e->res);
+
+  uv__free(e);
+}
+
+
+/* Only completed entries are on the LRU list; in-flight ones can't go. */
+static void uv__dns_cache_trim(struct uv__dns_cache* cache,
+                               unsigned int max_entries) {
+  struct uv__dns_entry* e;
+  QUEUE* q;
+
+  while (cache->nentries > max_entries && !QUEUE_EMPTY(&cache->lru_queue)) {
+    q = QUEUE_HEAD(&cache->lru_queue);
+    e = QUEUE_DATA(q, struct uv__dns_entry, lru_queue);
+    uv__dns_entry_remove(cache, e);
+    cache->evictions++;
+  }
+}
+
+
+static void uv__dns_cache_grow(struct uv__dns_cache* cache) {
+  struct uv__dns_entry** buckets;
+  struct uv__dns_entry* e;
+  unsigned int nbuckets;
+  unsigned int i;
+
+  nbuckets = cache->nbuckets * 2;
+  buckets = uv__calloc(nbuckets, sizeof(buckets[0]));
+  if (buckets == NULL)
+    return;  /* Longer chains, still correct. */
+
+  for (i = 0; i < cache->nbuckets; i++) {
+    while (cache->buckets[i] != NULL) {
+      e = cache->buckets[i];
+      cache->buckets[i] = e->next;
+      e->next = buckets[e->hash & (nbuckets - 1)];
+      buckets[e->hash & (nbuckets - 1)] = e;
+    }
+  }
+
+  uv__free(cache->buckets);
+  cache->buckets = buckets;
+  cache->nbuckets = nbuckets;
+}
+
+
+static void uv__dns_cache_ready(uv_loop_t* loop,
+                                uv__io_t* w,
+                                unsigned int events) {
+  struct uv__dns_cache* cache;
+  uv_getaddrinfo_t* req;
+  struct addrinfo* res;
+  unsigned int n;
+  QUEUE* q;
+
+  cache = container_of(w, struct uv__dns_cache, ready_watcher);
+
+  /* Requests that callbacks add run on the next loop iteration. */
+  for (n = cache->nready; n > 0; n--) {
+    q = QUEUE_HEAD(&cache->ready_queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
+    cache->nready--;
+
+    req = QUEUE_DATA(q, uv_getaddrinfo_t, work_req.wq);
+    res = req->res;
+    req->res = NULL;
+    uv__getaddrinfo_finish(req, req->retcode, res);
+  }
+}
+
+
+/* Requests held by the cache aren't on the threadpool. Their work_req.wq
+ * links them into the cache's lists, work_req.work stays NULL so that
+ * uv_cancel() returns UV_EBUSY for them.
+ */
+static void uv__dns_cache_hold(uv_getaddrinfo_t* req, QUEUE* queue) {
+  req->work_req.loop = req->loop;
+  req->work_req.work = NULL;
+  QUEUE_INSERT_TAIL(queue, &req->work_req.wq);
+}
+
+
+int uv__dns_cache_start(uv_getaddrinfo_t* req) {
+  struct uv__dns_cache* cache;
+  struct uv__dns_entry* e;
+  struct uv__dns_entry** bucket;
+  unsigned int hash;
+  uv_loop_t* loop;
+
+  loop = req->loop;
+  cache = loop->dns_cache;
+
+  if (cache == NULL || cache->ttl == 0)
+    return 0;
+
+  hash = uv__dns_hash(req);
+  bucket = cache->buckets + (hash & (cache->nbuckets - 1));
+
+  for (e = *bucket; e != NULL; e = e->next)
+    if (uv__dns_entry_match(e, req, hash))
+      break;
+
+  if (e != NULL && e->leader == NULL && e->expires <= uv_now(loop)) {
+    uv__dns_entry_remove(cache, e);
+    e = NULL;
+  }
+
+  if (e != NULL && e->leader != NULL) {
+    cache->coalesced++;
+    req->cache_entry = e;
+    uv__dns_cache_hold(req, &e->waiters);
+    return 1;
+  }
+
+  if (e != NULL) {
+    cache->hits++;
+    QUEUE_REMOVE(&e->lru_queue);
+    QUEUE_INSERT_TAIL(&cache->lru_queue, &e->lru_queue);
+
+    req->retcode = e->status;
+    if (e->res != NULL)
+      req->res = uv__dns_copy(e->res, &req->retcode);
+
+    uv__dns_cache_hold(req, &cache->ready_queue);
+    cache->nready++;
+    uv__io_feed(loop, &cache->ready_watcher);
+    return 1;
+  }
+
+  cache->misses++;
+
+  e = uv__dns_entry_new(req, hash);
+  if (e == NULL)
+    return 0;  /* Do an uncached lookup. */
+
+  e->leader = req;
+  req->cache_entry = e;
+
+  if (cache->nentries >= cache->nbuckets)
+    uv__dns_cache_grow(cache);
+
+  bucket = cache->buckets + (hash & (cache->nbuckets - 1));
+  e->next = *bucket;
+  *bucket = e;
+  cache->nentries++;
+
+  uv__dns_cache_trim(cache, cache->max_entries);
+
+  return 0;
+}
+
+
+int uv__dns_cache_done(uv_getaddrinfo_t* req,
+                       int status,
+                       struct addrinfo* res) {
+  struct uv__dns_cache* cache;
+  struct uv__dns_entry* e;
+  uv_getaddrinfo_t* waiter;
+  uv_loop_t* loop;
+  uint64_t ttl;
+  QUEUE queue;
+  QUEUE* q;
+  int retcode;
+
+  e = req->cache_entry;
+  req->cache_entry = NULL;
+
+  /* Not cached, or a waiter that was cancelled. */
+  if (e == NULL || e->leader != req)
+    return 0;
+
+  loop = req->loop;
+  cache = loop->dns_cache;
+  e->leader = NULL;
+
+  /* The waiters didn't ask to be cancelled. The first one takes over. */
+  if (status == -ECANCELED) {
+    if (QUEUE_EMPTY(&e->waiters)) {
+      uv__dns_entry_remove(cache, e);
+    } else {
+      q = QUEUE_HEAD(&e->waiters);
+      QUEUE_REMOVE(q);
+      QUEUE_INIT(q);
+      e->leader = QUEUE_DATA(q, uv_getaddrinfo_t, work_req.wq);
+      uv__getaddrinfo_submit(e->leader);
+    }
+    return 0;
+  }
+
+  retcode = req->retcode;
+
+  ttl = 0;
+  if (retcode == 0)
+    ttl = cache->ttl;
+  else if (retcode == UV_EAI_NONAME || retcode == UV_EAI_NODATA)
+    ttl = cache->negative_ttl;
+
+  QUEUE_INIT(&queue);
+  if (!QUEUE_EMPTY(&e->waiters)) {
+    q = QUEUE_HEAD(&e->waiters);
+    QUEUE_SPLIT(&e->waiters, q, &queue);
+  }
+
+  /* Hand out all copies before running any callback, those may evict the
+   * entry.
+   */
+  QUEUE_FOREACH(q, &queue) {
+    waiter = QUEUE_DATA(q, uv_getaddrinfo_t, work_req.wq);
+    waiter->cache_entry = NULL;
+    waiter->retcode = retcode;
+    if (res != NULL)
+      waiter->res = uv__dns_copy(res, &waiter->retcode);
+  }
+
+  if (cache->ttl != 0 && ttl != 0) {
+    e->status = retcode;
+    e->res = res;
+    e->expires = uv_now(loop) + ttl;
+    QUEUE_INSERT_TAIL(&cache->lru_queue, &e->lru_queue);
+    uv__dns_cache_trim(cache, cache->max_entries);
+
+    if (res != NULL)
+      res = uv__dns_copy(res, &retcode);
+  } else {
+    uv__dns_entry_remove(cache, e);
+  }
+
+  uv__getaddrinfo_finish(req, retcode, res);
+
+  while (!QUEUE_EMPTY(&queue)) {
+    q = QUEUE_HEAD(&queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
+
+    waiter = QUEUE_DATA(q, uv_getaddrinfo_t, work_req.wq);
+    res = waiter->res;
+    waiter->res = NULL;
+    uv__getaddrinfo_finish(waiter, waiter->retcode, res);
+  }
+
+  return 1;
+}
+
+
+int uv_loop_set_dns_cache(uv_loop_t* loop,
+                          unsigned int ttl,
+                          unsigned int negative_ttl,
+                          unsigned int max_entries) {
+  struct uv__dns_cache* cache;
+
+  if (max_entries == 0)
+    max_entries = UV__DNS_CACHE_MAX_ENTRIES;
+
+  cache = loop->dns_cache;
+
+  if (cache == NULL) {
+    if (ttl == 0)
+      return 0;
+
+    cache = uv__calloc(1, sizeof(*cache));
+    if (cache == NULL)
+      return -ENOMEM;
+
+    cache->nbuckets = UV__DNS_CACHE_MIN_BUCKETS;
+    cache->buckets = uv__calloc(cache->nbuckets, sizeof(cache->buckets[0]));
+    if (cache->buckets == NULL) {
+      uv__free(cache);
+      return -ENOMEM;
+    }
+
+    QUEUE_INIT(&cache->lru_queue);
+    QUEUE_INIT(&cache->ready_queue);
+    uv__io_init(&cache->ready_watcher, uv__dns_cache_ready, -1);
+    loop->dns_cache = cache;
+  }
+
+  cache->ttl = ttl;
+  cache->negative_ttl = negative_ttl;
+  cache->max_entries = max_entries;
+
+  /* Turning the cache off drops what's cached. Lookups in flight finish
+   * normally.
+   */
+  uv__dns_cache_trim(cache, ttl == 0 ? 0 : max_entries);
+
+  return 0;
+}
+
+
+int uv_dns_cache_stats(const uv_loop_t* loop, uv_dns_cache_stats_t* stats) {
+  const struct uv__dns_cache* cache;
+
+  memset(stats, 0, sizeof(*stats));
+
+  cache = loop->dns_cache;
+  if (cache == NULL)
+    return 0;
+
+  stats->entries = cache->nentries;
+  stats->hits = cache->hits;
+  stats->misses = cache->misses;
+  stats->coalesced = cache->coalesced;
+  stats->evictions = cache->evictions;
+
+  return 0;
+}
+
+
+void uv__dns_cache_close(uv_loop_t* loop) {
+  struct uv__dns_cache* cache;
+
+  cache = loop->dns_cache;
+  if (cache == NULL)
+    return;
+
+  uv__dns_cache_trim(cache, 0);
+  assert(cache->nentries == 0);  /* No lookups in flight. */
+
+  uv__free(cache->buckets);
+  uv__free(cache);
+  loop->dns_cache = NULL;
+}
@@ -94,23 +94,18 @@ static void uv__getaddrinfo_work(struct uv__work* w) {
 }
 
 
-static void uv__getaddrinfo_done(struct uv__work* w, int status) {
-  uv_getaddrinfo_t* req;
-  struct addrinfo *res;
-
-  req = container_of(w, uv_getaddrinfo_t, work_req);
+void uv__getaddrinfo_finish(uv_getaddrinfo_t* req,
+                            int status,
+                            struct addrinfo* res) {
   uv__req_unregister(req->loop, req);
 
-  res = req->res;
-  req->res = NULL;
-
   /* See initialization in uv_getaddrinfo(). */
   if (req->hints)
-    free(req->hints);
+    uv__free(req->hints);
   else if (req->service)
-    free(req->service);
+    uv__free(req->service);
   else if (req->hostname)
-    free(req->hostname);
+    uv__free(req->hostname);
   else
     assert(0);
 
@@ -118,12 +113,36 @@ static void uv__getaddrinfo_done(struct uv__work* w, int status) {
   req->service = NULL;
   req->hostname = NULL;
 
+  req->cb(req, status, res);
+}
+
+
+static void uv__getaddrinfo_done(struct uv__work* w, int status) {
+  uv_getaddrinfo_t* req;
+  struct addrinfo *res;
+
+  req = container_of(w, uv_getaddrinfo_t, work_req);
+
+  res = req->res;
+  req->res = NULL;
+
   if (status == -ECANCELED) {
     assert(req->retcode == 0);
     req->retcode = UV_EAI_CANCELED;
   }
 
-  req->cb(req, req->retcode, res);
+  if (req->cache_entry != NULL && uv__dns_cache_done(req, status, res))
+    return;
+
+  uv__getaddrinfo_finish(req, req->retcode, res);
+}
+
+
+void uv__getaddrinfo_submit(uv_getaddrinfo_t* req) {
+  uv__work_submit(req->loop,
+                  &req->work_req,
+                  uv__getaddrinfo_work,
+                  uv__getaddrinfo_done);
 }
 
 
@@ -145,7 +164,7 @@ int uv_getaddrinfo(uv_loop_t* loop,
   hostname_len = hostname ? strlen(hostname) + 1 : 0;
   service_len = service ? strlen(service) + 1 : 0;
   hints_len = hints ? sizeof(*hints) : 0;
-  buf = malloc(hostname_len + service_len + hints_len);
+  buf = uv__malloc(hostname_len + service_len + hints_len);
 
   if (buf == NULL)
     return -ENOMEM;
@@ -158,6 +177,7 @@ int uv_getaddrinfo(uv_loop_t* loop,
   req->service = NULL;
   req->hostname = NULL;
   req->retcode = 0;
+  req->cache_entry = NULL;
 
   /* order matters, see uv_getaddrinfo_done() */
   len = 0;
@@ -177,16 +197,17 @@ int uv_getaddrinfo(uv_loop_t* loop,
     len += hostname_len;
   }
 
-  uv__work_submit(loop,
-                  &req->work_req,
-                  uv__getaddrinfo_work,
-                  uv__getaddrinfo_done);
+  if (uv__dns_cache_start(req))
+    return 0;
+
+  uv__getaddrinfo_submit(req);
 
   return 0;
 }
 
 
 void uv_freeaddrinfo(struct addrinfo* ai) {
-  if (ai)
+  /* Results from the DNS cache aren't getaddrinfo()'s to free. */
+  if (ai && !uv__dns_cache_freeaddrinfo(ai))
     freeaddrinfo(ai);
 }
@@ -126,6 +126,12 @@
 # define O_CLOEXEC 0x00100000
 #endif
 
+/* Default for the threshold of uv_tcp_zerocopy(). */
+#define UV__ZEROCOPY_THRESHOLD (16 * 1024)
+
+/* Upper bound on the connections uv_listen_batch() reports per wakeup. */
+#define UV__ACCEPT_BATCH 64
+
 typedef struct uv__stream_queued_fds_s uv__stream_queued_fds_t;
 
 /* handle flags */
@@ -145,6 +151,10 @@ enum {
   UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
   UV_HANDLE_IPV6          = 0x10000, /* Handle is bound to a IPv6 socket. */
   UV_HANDLE_NETLINK		  = 0x20000, /**/
+  UV_HANDLE_UDP_GSO       = 0x40000, /* Coalesce sends with UDP_SEGMENT. */
+  UV_HANDLE_UDP_CONNECTED = 0x80000, /* uv_udp_connect() has a peer set. */
+  UV_HANDLE_UDP_PROCESSING = 0x100000, /* Running send callbacks. */
+  UV_TCP_ZEROCOPY         = 0x200000, /* Send large writes with MSG_ZEROCOPY. */
 };
 
 typedef enum {
@@ -182,6 +192,64 @@ void uv__async_init(struct uv__async* wa);
 int uv__async_start(uv_loop_t* loop, struct uv__async* wa, uv__async_cb cb);
 void uv__async_stop(uv_loop_t* loop, struct uv__async* wa);
 
+/* buf-pool */
+void uv__buf_pool_close(uv_loop_t* loop);
+
+/* dns-cache */
+int uv__dns_cache_start(uv_getaddrinfo_t* req);
+int uv__dns_cache_done(uv_getaddrinfo_t* req,
+                       int status,
+                       struct addrinfo* res);
+void uv__dns_cache_close(uv_loop_t* loop);
+int uv__dns_cache_freeaddrinfo(struct addrinfo* ai);
+
+/* metrics */
+void uv__metrics_record_iteration(uv_loop_t* loop);
+void uv__metrics_record_run_stop(uv_loop_t* loop);
+void uv__metrics_record_poll_start(uv_loop_t* loop);
+void uv__metrics_record_poll_end(uv_loop_t* loop, int nevents);
+uint64_t uv__metrics_record_work_submit(uv_loop_t* loop);
+void uv__metrics_record_work(uv_loop_t* loop, uint64_t wait, uint64_t run);
+void uv__metrics_record_work_done(uv_loop_t* loop, unsigned int n);
+void uv__metrics_histogram_add(uv_metrics_histogram_t* h, uint64_t value);
+
+/* The loop calls these unconditionally, they only cost a test when metrics
+ * are off.
+ */
+#define uv__metrics_iteration(loop)                                           \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_record_iteration(loop);                                     \
+  }                                                                           \
+  while (0)
+
+#define uv__metrics_run_stop(loop)                                            \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_record_run_stop(loop);                                      \
+  }                                                                           \
+  while (0)
+
+#define uv__metrics_poll_start(loop)                                          \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_record_poll_start(loop);                                    \
+  }                                                                           \
+  while (0)
+
+#define uv__metrics_poll_end(loop, nevents)                                   \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_record_poll_end((loop), (nevents));                         \
+  }                                                                           \
+  while (0)
+
+/* getaddrinfo */
+void uv__getaddrinfo_submit(uv_getaddrinfo_t* req);
+void uv__getaddrinfo_finish(uv_getaddrinfo_t* req,
+                            int status,
+                            struct addrinfo* res);
+
 /* loop */
 void uv__run_idle(uv_loop_t* loop);
 void uv__run_check(uv_loop_t* loop);
@@ -204,6 +272,7 @@ int uv__open_cloexec(const char* path, int flags);
 int uv_tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb);
 int uv__tcp_nodelay(int fd, int on);
 int uv__tcp_keepalive(int fd, int on, unsigned int delay);
+int uv__tcp_zerocopy(int fd, int on);
 
 /* pipe */
 int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
@@ -211,11 +280,15 @@ int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
 /* timer */
 void uv__run_timers(uv_loop_t* loop);
 int uv__next_timeout(const uv_loop_t* loop);
+unsigned int uv__timer_count(const uv_loop_t* loop);
 
 /* signal */
 void uv__signal_close(uv_signal_t* handle);
 void uv__signal_global_once_init(void);
 void uv__signal_loop_cleanup(uv_loop_t* loop);
+#if defined(__linux__)
+void uv__signal_blocked_set(const uv_loop_t* loop, sigset_t* set);
+#endif
 
 /* platform specific */
 uint64_t uv__hrtime(uv_clocktype_t type);
@@ -224,8 +297,37 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop);
 void uv__platform_loop_delete(uv_loop_t* loop);
 void uv__platform_invalidate_fd(uv_loop_t* loop, int fd);
 
+#if defined(__linux__)
+int uv__iou_init(uv_loop_t* loop);
+void uv__iou_delete(uv_loop_t* loop);
+void uv__iou_io_stop(uv_loop_t* loop, int fd);
+void uv__iou_poll(uv_loop_t* loop, int timeout);
+int uv__io_set_edge(uv_loop_t* loop, uv__io_t* w, int on);
+int uv__io_set_exclusive(uv_loop_t* loop, uv__io_t* w, int on);
+void uv__epoll_io_stop(uv_loop_t* loop, int fd);
+#endif /* __linux__ */
+
+/* Edge-triggered watchers remember readiness until the consumer has seen
+ * EAGAIN. Everyone else can ignore this.
+ */
+#if defined(__linux__)
+# define uv__io_drained(w, ev) ((w)->ready &= ~(ev))
+#else
+# define uv__io_drained(w, ev) ((void) 0)
+#endif
+
+/* Exclusive watchers share their wakeups with the other processes that wait
+ * on the same file descriptor, only one of them is woken up per event.
+ */
+#if defined(__linux__)
+# define uv__io_exclusive(w) ((w)->exclusive)
+#else
+# define uv__io_exclusive(w) 0
+#endif
+
 /* various */
 void uv__async_close(uv_async_t* handle);
+void uv__channel_close(uv_channel_t* handle);
 void uv__check_close(uv_check_t* handle);
 void uv__fs_event_close(uv_fs_event_t* handle);
 void uv__idle_close(uv_idle_t* handle);
@@ -233,6 +335,8 @@ void uv__pipe_close(uv_pipe_t* handle);
 void uv__poll_close(uv_poll_t* handle);
 void uv__prepare_close(uv_prepare_t* handle);
 void uv__process_close(uv_process_t* handle);
+void uv__resolver_close(uv_resolver_t* handle);
+void uv__resolver_destroy(uv_resolver_t* handle);
 void uv__stream_close(uv_stream_t* handle);
 void uv__tcp_close(uv_tcp_t* handle);
 void uv__timer_close(uv_timer_t* handle);
@@ -308,11 +412,63 @@ UV_UNUSED(static char* uv__basename_r(const char* path)) {
 }
 
 
-#ifdef HAVE_DTRACE
+#if defined(HAVE_DTRACE)
 #include "uv-dtrace.h"
+#elif defined(HAVE_SYS_SDT_H)
+/* The probes from uv-dtrace.d as USDT probes. Each one is a nop and an ELF
+ * note until perf, bpftrace or systemtap attaches to it.
+ */
+#include <sys/sdt.h>
+#define UV_TICK_START(arg0, arg1) DTRACE_PROBE2(uv, tick__start, arg0, arg1)
+#define UV_TICK_STOP(arg0, arg1) DTRACE_PROBE2(uv, tick__stop, arg0, arg1)
+#define UV_TIMERS_START(arg0) DTRACE_PROBE1(uv, timers__start, arg0)
+#define UV_TIMERS_STOP(arg0) DTRACE_PROBE1(uv, timers__stop, arg0)
+#define UV_PENDING_START(arg0) DTRACE_PROBE1(uv, pending__start, arg0)
+#define UV_PENDING_STOP(arg0) DTRACE_PROBE1(uv, pending__stop, arg0)
+#define UV_IDLE_START(arg0) DTRACE_PROBE1(uv, idle__start, arg0)
+#define UV_IDLE_STOP(arg0) DTRACE_PROBE1(uv, idle__stop, arg0)
+#define UV_PREPARE_START(arg0) DTRACE_PROBE1(uv, prepare__start, arg0)
+#define UV_PREPARE_STOP(arg0) DTRACE_PROBE1(uv, prepare__stop, arg0)
+#define UV_POLL_START(arg0, arg1) DTRACE_PROBE2(uv, poll__start, arg0, arg1)
+#define UV_POLL_STOP(arg0, arg1) DTRACE_PROBE2(uv, poll__stop, arg0, arg1)
+#define UV_IO_START(arg0, arg1, arg2, arg3)                                   \
+  DTRACE_PROBE4(uv, io__start, arg0, arg1, arg2, arg3)
+#define UV_IO_STOP(arg0, arg1) DTRACE_PROBE2(uv, io__stop, arg0, arg1)
+#define UV_CHECK_START(arg0) DTRACE_PROBE1(uv, check__start, arg0)
+#define UV_CHECK_STOP(arg0) DTRACE_PROBE1(uv, check__stop, arg0)
+#define UV_CLOSING_START(arg0) DTRACE_PROBE1(uv, closing__start, arg0)
+#define UV_CLOSING_STOP(arg0) DTRACE_PROBE1(uv, closing__stop, arg0)
+#define UV_WORK_SUBMIT(arg0, arg1) DTRACE_PROBE2(uv, work__submit, arg0, arg1)
+#define UV_WORK_START(arg0, arg1) DTRACE_PROBE2(uv, work__start, arg0, arg1)
+#define UV_WORK_DONE(arg0, arg1, arg2)                                        \
+  DTRACE_PROBE3(uv, work__done, arg0, arg1, arg2)
+#define UV_STREAM_READ(arg0, arg1) DTRACE_PROBE2(uv, stream__read, arg0, arg1)
+#define UV_STREAM_WRITE(arg0, arg1, arg2)                                     \
+  DTRACE_PROBE3(uv, stream__write, arg0, arg1, arg2)
 #else
 #define UV_TICK_START(arg0, arg1)
 #define UV_TICK_STOP(arg0, arg1)
+#define UV_TIMERS_START(arg0)
+#define UV_TIMERS_STOP(arg0)
+#define UV_PENDING_START(arg0)
+#define UV_PENDING_STOP(arg0)
+#define UV_IDLE_START(arg0)
+#define UV_IDLE_STOP(arg0)
+#define UV_PREPARE_START(arg0)
+#define UV_PREPARE_STOP(arg0)
+#define UV_POLL_START(arg0, arg1)
+#define UV_POLL_STOP(arg0, arg1)
+#define UV_IO_START(arg0, arg1, arg2, arg3)
+#define UV_IO_STOP(arg0, arg1)
+#define UV_CHECK_START(arg0)
+#define UV_CHECK_STOP(arg0)
+#define UV_CLOSING_START(arg0)
+#define UV_CLOSING_STOP(arg0)
+#define UV_WORK_SUBMIT(arg0, arg1)
+#define UV_WORK_START(arg0, arg1)
+#define UV_WORK_DONE(arg0, arg1, arg2)
+#define UV_STREAM_READ(arg0, arg1)
+#define UV_STREAM_WRITE(arg0, arg1, arg2)
 #endif
 
 #endif /* UV_UNIX_INTERNAL_H_ */
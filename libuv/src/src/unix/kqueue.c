@@ -127,6 +127,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       spec.tv_nsec = (timeout % 1000) * 1000000;
     }
 
+    UV_POLL_START(loop, timeout);
+    uv__metrics_poll_start(loop);
+
     nfds = kevent(loop->backend_fd,
                   events,
                   nevents,
@@ -134,6 +137,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
                   ARRAY_SIZE(events),
                   timeout == -1 ? NULL : &spec);
 
+    SAVE_ERRNO(uv__metrics_poll_end(loop, nfds));
+    UV_POLL_STOP(loop, nfds);
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
@@ -188,7 +194,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       if (ev->filter == EVFILT_VNODE) {
         assert(w->events == UV__POLLIN);
         assert(w->pevents == UV__POLLIN);
+        UV_IO_START(loop, w, fd, ev->fflags);
         w->cb(loop, w, ev->fflags); /* XXX always uv__fs_event() */
+        UV_IO_STOP(loop, w);
         nevents++;
         continue;
       }
@@ -229,7 +237,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       if (revents == 0)
         continue;
 
+      UV_IO_START(loop, w, fd, revents);
       w->cb(loop, w, revents);
+      UV_IO_STOP(loop, w);
       nevents++;
     }
     loop->watchers[loop->nwatchers] = NULL;
@@ -348,7 +358,7 @@ int uv_fs_event_start(uv_fs_event_t* handle,
 
   uv__handle_start(handle);
   uv__io_init(&handle->event_watcher, uv__fs_event, fd);
-  handle->path = strdup(path);
+  handle->path = uv__strdup(path);
   handle->cb = cb;
 
 #if defined(__APPLE__)
@@ -388,7 +398,7 @@ int uv_fs_event_stop(uv_fs_event_t* handle) {
     uv__io_close(handle->loop, &handle->event_watcher);
   }
 
-  free(handle->path);
+  uv__free(handle->path);
   handle->path = NULL;
 
   uv__close(handle->event_watcher.fd);
@@ -77,6 +77,18 @@ static unsigned long read_cpufreq(unsigned int cpunum);
 int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
   int fd;
 
+  loop->inotify_fd = -1;
+  loop->inotify_watchers = NULL;
+  loop->epoll_masks = NULL;
+  loop->nepoll_masks = 0;
+  QUEUE_INIT(&loop->edge_queue);
+
+  /* Prefer the io_uring backend when it's been asked for and the kernel
+   * supports it, epoll otherwise.
+   */
+  if (uv__iou_init(loop) == 0)
+    return 0;
+
   fd = uv__epoll_create1(UV__EPOLL_CLOEXEC);
 
   /* epoll_create1() can fail either because it's not implemented (old kernel)
@@ -90,8 +102,6 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
   }
 
   loop->backend_fd = fd;
-  loop->inotify_fd = -1;
-  loop->inotify_watchers = NULL;
 
   if (fd == -1)
     return -errno;
@@ -101,6 +111,10 @@ int uv__platform_loop_init(uv_loop_t* loop, int default_loop) {
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  uv__iou_delete(loop);
+  uv__free(loop->epoll_masks);
+  loop->epoll_masks = NULL;
+  loop->nepoll_masks = 0;
   if (loop->inotify_fd == -1) return;
   uv__io_stop(loop, &loop->inotify_read_watcher, UV__POLLIN);
   uv__close(loop->inotify_fd);
@@ -116,6 +130,11 @@ void uv__platform_invalidate_fd(uv_loop_t* loop, int fd) {
 
   assert(loop->watchers != NULL);
 
+  if (loop->iou != NULL) {
+    uv__iou_io_stop(loop, fd);
+    return;
+  }
+
   events = (struct uv__epoll_event*) loop->watchers[loop->nwatchers];
   nfds = (uintptr_t) loop->watchers[loop->nwatchers + 1];
   if (events != NULL)
@@ -132,6 +151,130 @@ void uv__platform_invalidate_fd(uv_loop_t* loop, int fd) {
    */
   if (loop->backend_fd >= 0)
     uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, &dummy);
+
+  if ((unsigned) fd < loop->nepoll_masks)
+    loop->epoll_masks[fd] = 0;
+}
+
+
+static void uv__epoll_maybe_resize(uv_loop_t* loop) {
+  unsigned int* masks;
+
+  if (loop->nwatchers <= loop->nepoll_masks)
+    return;
+
+  masks = uv__realloc(loop->epoll_masks, loop->nwatchers * sizeof(*masks));
+  if (masks == NULL)
+    abort();
+
+  memset(masks + loop->nepoll_masks,
+         0,
+         (loop->nwatchers - loop->nepoll_masks) * sizeof(*masks));
+  loop->epoll_masks = masks;
+  loop->nepoll_masks = loop->nwatchers;
+}
+
+
+int uv__io_set_edge(uv_loop_t* loop, uv__io_t* w, int on) {
+  /* The io_uring backend uses one-shot polls, there are no edges. */
+  if (loop->iou != NULL)
+    return -ENOTSUP;
+
+  on = !!on;
+  if (w->edge == (unsigned int) on)
+    return 0;
+
+  w->edge = on;
+  w->ready = 0;
+  QUEUE_REMOVE(&w->edge_queue);
+  QUEUE_INIT(&w->edge_queue);
+
+  /* Make uv__io_poll() update the registration. It reports the current
+   * readiness state when it does so we don't have to guess it here.
+   */
+  w->events = 0;
+  if (w->pevents != 0 && QUEUE_EMPTY(&w->watcher_queue))
+    QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+
+  return 0;
+}
+
+
+/* EPOLLEXCLUSIVE makes the kernel wake up only one of the epoll instances
+ * that wait on the file descriptor, which is what a listen socket that is
+ * shared between processes wants. The flag can only be passed to
+ * EPOLL_CTL_ADD, uv__io_poll() deletes and re-adds the registration when
+ * it needs to change it.
+ */
+int uv__io_set_exclusive(uv_loop_t* loop, uv__io_t* w, int on) {
+  if (loop->iou != NULL)
+    return -ENOTSUP;
+
+  on = !!on;
+  if (w->exclusive == (unsigned int) on)
+    return 0;
+
+  if (w->fd >= 0)
+    uv__epoll_io_stop(loop, w->fd);
+
+  w->exclusive = on;
+  w->events = 0;
+  if (w->pevents != 0 && QUEUE_EMPTY(&w->watcher_queue))
+    QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+
+  return 0;
+}
+
+
+/* Stopped watchers normally stay registered, see uv__io_stop(). Exclusive
+ * watchers don't: a wakeup that goes to a stopped watcher is a wakeup that
+ * another process doesn't get.
+ */
+void uv__epoll_io_stop(uv_loop_t* loop, int fd) {
+  struct uv__epoll_event dummy;
+
+  if ((unsigned) fd >= loop->nepoll_masks || loop->epoll_masks[fd] == 0)
+    return;
+
+  /* ENOENT means it was closed behind our back, which is fine. */
+  memset(&dummy, 0, sizeof(dummy));
+  uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, &dummy);
+  loop->epoll_masks[fd] = 0;
+}
+
+
+/* Edge-triggered watchers that are still ready when their callback returns,
+ * for example because uv__read() ran out of budget, won't be reported by the
+ * kernel again. Queue them up for the next call to uv__io_poll().
+ */
+static void uv__epoll_edge_requeue(uv_loop_t* loop, uv__io_t* w) {
+  if ((w->ready & w->pevents) != 0 && QUEUE_EMPTY(&w->edge_queue))
+    QUEUE_INSERT_TAIL(&loop->edge_queue, &w->edge_queue);
+}
+
+
+static void uv__epoll_run_edges(uv_loop_t* loop, QUEUE* queue) {
+  QUEUE* q;
+  uv__io_t* w;
+  unsigned int events;
+
+  while (!QUEUE_EMPTY(queue)) {
+    q = QUEUE_HEAD(queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
+
+    w = QUEUE_DATA(q, uv__io_t, edge_queue);
+    events = w->ready & w->pevents;
+
+    /* Stopped in the mean time, uv__io_poll() requeues it when restarted. */
+    if (events == 0)
+      continue;
+
+    UV_IO_START(loop, w, w->fd, events);
+    w->cb(loop, w, events);
+    UV_IO_STOP(loop, w);
+    uv__epoll_edge_requeue(loop, w);
+  }
 }
 
 
@@ -139,6 +282,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct uv__epoll_event events[1024];
   struct uv__epoll_event* pe;
   struct uv__epoll_event e;
+  QUEUE edges;
   QUEUE* q;
   uv__io_t* w;
   uint64_t base;
@@ -155,6 +299,14 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     return;
   }
 
+  if (loop->iou != NULL) {
+    uv__iou_poll(loop, timeout);
+    return;
+  }
+
+  loop->epoll_ctl_saved = 0;
+  uv__epoll_maybe_resize(loop);
+
   while (!QUEUE_EMPTY(&loop->watcher_queue)) {
     q = QUEUE_HEAD(&loop->watcher_queue);
     QUEUE_REMOVE(q);
@@ -165,29 +317,81 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     assert(w->fd >= 0);
     assert(w->fd < (int) loop->nwatchers);
 
-    e.events = w->pevents;
+    /* w->events is the event mask the kernel is watching, which can be wider
+     * than what the user is interested in. Only update the registration when
+     * interest widens. Events we're no longer interested in are squelched
+     * after epoll_wait() and the registration is narrowed when one of them
+     * actually fires.
+     *
+     * epoll_masks[] tells us whether the registration still exists; it's
+     * cleared when the file descriptor is removed from the epoll set.
+     *
+     * Edge-triggered watchers are registered for everything once and filter
+     * in userspace. Readiness that was reported while the watcher was
+     * stopped is delivered now.
+     */
+    if (w->edge) {
+      e.events = UV__EPOLLIN | UV__EPOLLOUT | UV__EPOLLET;
+      uv__epoll_edge_requeue(loop, w);
+    } else {
+      e.events = w->pevents;
+    }
+    if (w->exclusive)
+      e.events |= UV__EPOLLEXCLUSIVE;
     e.data = w->fd;
 
-    if (w->events == 0)
+    if (w->events != 0 &&
+        w->events == loop->epoll_masks[w->fd] &&
+        (e.events & ~w->events) == 0) {
+      loop->epoll_ctl_saved++;
+      continue;
+    }
+
+    /* EPOLL_CTL_MOD doesn't take EPOLLEXCLUSIVE. */
+    if (w->exclusive)
+      uv__epoll_io_stop(loop, w->fd);
+
+    if (loop->epoll_masks[w->fd] == 0)
       op = UV__EPOLL_CTL_ADD;
     else
       op = UV__EPOLL_CTL_MOD;
 
-    /* XXX Future optimization: do EPOLL_CTL_MOD lazily if we stop watching
-     * events, skip the syscall and squelch the events after epoll_wait().
-     */
     if (uv__epoll_ctl(loop->backend_fd, op, w->fd, &e)) {
-      if (errno != EEXIST)
+      if (errno != EEXIST && errno != ENOENT)
         abort();
 
-      assert(op == UV__EPOLL_CTL_ADD);
+      /* EEXIST: we've reactivated a file descriptor that's been watched
+       * before. ENOENT: the file descriptor has been closed and reused since
+       * it was registered, which removed it from the epoll set.
+       */
+      if (errno == EEXIST) {
+        assert(op == UV__EPOLL_CTL_ADD);
+        op = UV__EPOLL_CTL_MOD;
+      } else {
+        assert(op == UV__EPOLL_CTL_MOD);
+        op = UV__EPOLL_CTL_ADD;
+      }
 
-      /* We've reactivated a file descriptor that's been watched before. */
-      if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, w->fd, &e))
+      if (uv__epoll_ctl(loop->backend_fd, op, w->fd, &e))
         abort();
     }
 
-    w->events = w->pevents;
+    w->events = e.events;
+    loop->epoll_masks[w->fd] = e.events;
+  }
+
+  loop->epoll_ctl_saved_total += loop->epoll_ctl_saved;
+
+  /* Edge-triggered watchers that are waiting for a turn get it after the
+   * watchers with new events. Watchers that get requeued in the mean time
+   * go to the back of the line, i.e. the next call to uv__io_poll(). Don't
+   * block when there's someone waiting.
+   */
+  QUEUE_INIT(&edges);
+  if (!QUEUE_EMPTY(&loop->edge_queue)) {
+    q = QUEUE_HEAD(&loop->edge_queue);
+    QUEUE_SPLIT(&loop->edge_queue, q, &edges);
+    timeout = 0;
   }
 
   assert(timeout >= -1);
@@ -195,11 +399,17 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
 
   for (;;) {
+    UV_POLL_START(loop, timeout);
+    uv__metrics_poll_start(loop);
+
     nfds = uv__epoll_wait(loop->backend_fd,
                           events,
                           ARRAY_SIZE(events),
                           timeout);
 
+    SAVE_ERRNO(uv__metrics_poll_end(loop, nfds));
+    UV_POLL_STOP(loop, nfds);
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
@@ -208,7 +418,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
 
     if (nfds == 0) {
       assert(timeout != -1);
-      return;
+      break;
     }
 
     if (nfds == -1) {
@@ -219,7 +429,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         continue;
 
       if (timeout == 0)
-        return;
+        break;
 
       /* Interrupted by a signal. Update timeout and poll again. */
       goto update_timeout;
@@ -250,9 +460,56 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
          * when the file descriptor is closed.
          */
         uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, pe);
+        loop->epoll_masks[fd] = 0;
         continue;
       }
 
+      if (w->edge) {
+        w->ready |= pe->events & (UV__EPOLLIN | UV__EPOLLOUT);
+
+        /* Errors and hangups are reported once. Whatever the watcher tries
+         * next is going to run into them, no need to remember them.
+         */
+        if (pe->events & (UV__EPOLLERR | UV__EPOLLHUP))
+          w->ready |= UV__EPOLLIN | UV__EPOLLOUT;
+
+        /* Already waiting for its turn, don't let it jump the queue. */
+        if (!QUEUE_EMPTY(&w->edge_queue))
+          continue;
+
+        pe->events &= UV__EPOLLERR | UV__EPOLLHUP;
+        pe->events |= w->ready & w->pevents;
+
+        if (pe->events != 0) {
+          UV_IO_START(loop, w, fd, pe->events);
+          w->cb(loop, w, pe->events);
+          UV_IO_STOP(loop, w);
+          uv__epoll_edge_requeue(loop, w);
+          nevents++;
+        }
+        continue;
+      }
+
+      /* The kernel reported an event we've lost interest in since the last
+       * time the registration was updated. Narrow it now, otherwise level
+       * triggered epoll keeps waking us up for it.
+       */
+      if (pe->events & w->events & ~w->pevents) {
+        if (w->exclusive) {
+          uv__epoll_io_stop(loop, fd);
+          w->events = 0;
+          if (QUEUE_EMPTY(&w->watcher_queue))
+            QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+        } else {
+          e.events = w->pevents;
+          e.data = fd;
+          if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, fd, &e))
+            abort();
+          w->events = w->pevents;
+          loop->epoll_masks[fd] = w->pevents;
+        }
+      }
+
       /* Give users only events they're interested in. Prevents spurious
        * callbacks when previous callback invocation in this loop has stopped
        * the current watcher. Also, filters out events that users has not
@@ -279,7 +536,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         pe->events |= w->pevents & (UV__EPOLLIN | UV__EPOLLOUT);
 
       if (pe->events != 0) {
+        UV_IO_START(loop, w, fd, pe->events);
         w->cb(loop, w, pe->events);
+        UV_IO_STOP(loop, w);
         nevents++;
       }
     }
@@ -292,11 +551,11 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         timeout = 0;
         continue;
       }
-      return;
+      break;
     }
 
     if (timeout == 0)
-      return;
+      break;
 
     if (timeout == -1)
       continue;
@@ -306,10 +565,12 @@ update_timeout:
 
     diff = loop->time - base;
     if (diff >= (uint64_t) timeout)
-      return;
+      break;
 
     timeout -= diff;
   }
+
+  uv__epoll_run_edges(loop, &edges);
 }
 
 
@@ -478,7 +739,7 @@ int uv_cpu_info(uv_cpu_info_t** cpu_infos, int* count) {
   assert(numcpus != (unsigned int) -1);
   assert(numcpus != 0);
 
-  ci = calloc(numcpus, sizeof(*ci));
+  ci = uv__calloc(numcpus, sizeof(*ci));
   if (ci == NULL)
     return -ENOMEM;
 
@@ -550,7 +811,7 @@ static int read_models(unsigned int numcpus, uv_cpu_info_t* ci) {
     if (model_idx < numcpus) {
       if (strncmp(buf, model_marker, sizeof(model_marker) - 1) == 0) {
         model = buf + sizeof(model_marker) - 1;
-        model = strndup(model, strlen(model) - 1);  /* Strip newline. */
+        model = uv__strndup(model, strlen(model) - 1);  /* Strip newline. */
         if (model == NULL) {
           fclose(fp);
           return -ENOMEM;
@@ -569,7 +830,7 @@ static int read_models(unsigned int numcpus, uv_cpu_info_t* ci) {
 #endif
       if (strncmp(buf, model_marker, sizeof(model_marker) - 1) == 0) {
         model = buf + sizeof(model_marker) - 1;
-        model = strndup(model, strlen(model) - 1);  /* Strip newline. */
+        model = uv__strndup(model, strlen(model) - 1);  /* Strip newline. */
         if (model == NULL) {
           fclose(fp);
           return -ENOMEM;
@@ -600,7 +861,7 @@ static int read_models(unsigned int numcpus, uv_cpu_info_t* ci) {
     inferred_model = ci[model_idx - 1].model;
 
   while (model_idx < numcpus) {
-    model = strndup(inferred_model, strlen(inferred_model));
+    model = uv__strndup(inferred_model, strlen(inferred_model));
     if (model == NULL)
       return -ENOMEM;
     ci[model_idx++].model = model;
@@ -710,10 +971,10 @@ void uv_free_cpu_info(uv_cpu_info_t* cpu_infos, int count) {
   int i;
 
   for (i = 0; i < count; i++) {
-    free(cpu_infos[i].model);
+    uv__free(cpu_infos[i].model);
   }
 
-  free(cpu_infos);
+  uv__free(cpu_infos);
 }
 
 
@@ -743,7 +1004,7 @@ int uv_interface_addresses(uv_interface_address_t** addresses,
     (*count)++;
   }
 
-  *addresses = malloc(*count * sizeof(**addresses));
+  *addresses = uv__malloc(*count * sizeof(**addresses));
   if (!(*addresses))
     return -ENOMEM;
 
@@ -763,7 +1024,7 @@ int uv_interface_addresses(uv_interface_address_t** addresses,
     if (ent->ifa_addr->sa_family == PF_PACKET)
       continue;
 
-    address->name = strdup(ent->ifa_name);
+    address->name = uv__strdup(ent->ifa_name);
 
     if (ent->ifa_addr->sa_family == AF_INET6) {
       address->address.address6 = *((struct sockaddr_in6*) ent->ifa_addr);
@@ -813,10 +1074,10 @@ void uv_free_interface_addresses(uv_interface_address_t* addresses,
   int i;
 
   for (i = 0; i < count; i++) {
-    free(addresses[i].name);
+    uv__free(addresses[i].name);
   }
 
-  free(addresses);
+  uv__free(addresses);
 }
 
 
@@ -0,0 +1,470 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* io_uring polling backend.
+ *
+ * Every watched file descriptor has one IORING_OP_POLL_ADD request in flight.
+ * Poll requests are one-shot: when one completes, the watcher is put back on
+ * the watcher queue and re-armed at the start of the next uv__io_poll() call.
+ * All interest changes for an iteration (new watchers, re-arms, mask changes
+ * and removals) are written to the submission ring and handed to the kernel
+ * together with the wait in a single io_uring_enter() call.
+ *
+ * The user_data of a poll request encodes the file descriptor in the low 32
+ * bits and a per-fd generation counter in the high 32 bits.  The generation
+ * is bumped whenever the fd is re-armed with a different mask, stopped or
+ * closed so completions of superseded requests can be told apart and dropped.
+ *
+ * The backend is opt-in: it is selected at uv_loop_init() time when the
+ * UV_USE_IO_URING environment variable is set to a non-zero value and the
+ * kernel supports IORING_FEAT_NODROP and IORING_FEAT_EXT_ARG (linux >= 5.11).
+ * Otherwise the loop falls back to epoll.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <endian.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define UV__IOU_ENTRIES   256
+#define UV__IOU_IGNORE    0xFFFFFFFFu
+
+struct uv__iou_fd {
+  uint32_t gen;
+  uint32_t armed;  /* Event mask of the in-flight poll request, if any. */
+};
+
+struct uv__iou {
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t sqmask;
+  uint32_t sqentries;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_cqe* cqes;
+  struct uv__io_uring_sqe* sqes;
+  void* ring;
+  size_t ringlen;
+  size_t sqelen;
+  struct uv__iou_fd* fds;
+  unsigned int nfds;
+};
+
+
+int uv__iou_init(uv_loop_t* loop) {
+  struct uv__io_uring_params params;
+  struct uv__iou* iou;
+  const char* val;
+  size_t sqlen;
+  size_t cqlen;
+  uint32_t i;
+  char* ring;
+  void* sqes;
+  int fd;
+
+  loop->iou = NULL;
+
+  val = getenv("UV_USE_IO_URING");
+  if (val == NULL || atoi(val) == 0)
+    return -ENOSYS;
+
+  memset(&params, 0, sizeof(params));
+  params.flags = UV__IORING_SETUP_CQSIZE;
+  params.cq_entries = 4 * UV__IOU_ENTRIES;
+
+  fd = uv__io_uring_setup(UV__IOU_ENTRIES, &params);
+  if (fd == -1)
+    return -errno;
+
+  if (!(params.features & UV__IORING_FEAT_SINGLE_MMAP) ||
+      !(params.features & UV__IORING_FEAT_NODROP) ||
+      !(params.features & UV__IORING_FEAT_EXT_ARG)) {
+    uv__close(fd);
+    return -ENOSYS;
+  }
+
+  sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqlen = params.cq_off.cqes +
+          params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  if (cqlen > sqlen)
+    sqlen = cqlen;
+
+  ring = mmap(NULL,
+              sqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED) {
+    uv__close(fd);
+    return -ENOMEM;
+  }
+
+  cqlen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+  sqes = mmap(NULL,
+              cqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    munmap(ring, sqlen);
+    uv__close(fd);
+    return -ENOMEM;
+  }
+
+  iou = uv__malloc(sizeof(*iou));
+  if (iou == NULL) {
+    munmap(sqes, cqlen);
+    munmap(ring, sqlen);
+    uv__close(fd);
+    return -ENOMEM;
+  }
+
+  iou->ring = ring;
+  iou->ringlen = sqlen;
+  iou->sqes = sqes;
+  iou->sqelen = cqlen;
+  iou->sqhead = (uint32_t*) (ring + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (ring + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) (ring + params.sq_off.array);
+  iou->sqmask = *(uint32_t*) (ring + params.sq_off.ring_mask);
+  iou->sqentries = params.sq_entries;
+  iou->cqhead = (uint32_t*) (ring + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (ring + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (ring + params.cq_off.ring_mask);
+  iou->cqes = (struct uv__io_uring_cqe*) (ring + params.cq_off.cqes);
+  iou->fds = NULL;
+  iou->nfds = 0;
+
+  /* Identity mapping, SQEs are consumed in ring order. */
+  for (i = 0; i <= iou->sqmask; i++)
+    iou->sqarray[i] = i;
+
+  loop->backend_fd = fd;
+  loop->iou = iou;
+
+  return 0;
+}
+
+
+void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = loop->iou;
+  if (iou == NULL)
+    return;
+
+  /* The ring fd itself is closed by uv__loop_close(), that also cancels any
+   * outstanding poll requests.
+   */
+  munmap(iou->sqes, iou->sqelen);
+  munmap(iou->ring, iou->ringlen);
+  uv__free(iou->fds);
+  uv__free(iou);
+  loop->iou = NULL;
+}
+
+
+static void uv__iou_submit(uv_loop_t* loop, struct uv__iou* iou) {
+  uint32_t pending;
+  int rc;
+
+  for (;;) {
+    pending = *iou->sqtail - __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+    if (pending == 0)
+      return;
+
+    rc = uv__io_uring_enter(loop->backend_fd, pending, 0, 0, NULL, 0);
+    if (rc == -1 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+      abort();
+  }
+}
+
+
+static struct uv__io_uring_sqe* uv__iou_get_sqe(uv_loop_t* loop,
+                                               struct uv__iou* iou) {
+  struct uv__io_uring_sqe* sqe;
+  uint32_t head;
+  uint32_t tail;
+
+  tail = *iou->sqtail;
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+
+  /* Submission ring is full, hand what we have to the kernel first. */
+  if (tail - head >= iou->sqentries) {
+    uv__iou_submit(loop, iou);
+    tail = *iou->sqtail;
+  }
+
+  sqe = iou->sqes + (tail & iou->sqmask);
+  memset(sqe, 0, sizeof(*sqe));
+
+  return sqe;
+}
+
+
+static void uv__iou_sqe_done(struct uv__iou* iou) {
+  __atomic_store_n(iou->sqtail, *iou->sqtail + 1, __ATOMIC_RELEASE);
+}
+
+
+static void uv__iou_poll_add(uv_loop_t* loop,
+                             struct uv__iou* iou,
+                             int fd,
+                             uint32_t events) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou_fd* st;
+
+  st = iou->fds + fd;
+  st->gen++;
+  st->armed = events;
+
+  sqe = uv__iou_get_sqe(loop, iou);
+  sqe->opcode = UV__IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+#if __BYTE_ORDER == __BIG_ENDIAN
+  /* The kernel reads poll32_events with the 16 bit halves swapped. */
+  events = (events << 16) | (events >> 16);
+#endif
+  sqe->rw_flags = events;
+  sqe->user_data = (uint64_t) st->gen << 32 | (uint32_t) fd;
+  uv__iou_sqe_done(iou);
+}
+
+
+static void uv__iou_poll_remove(uv_loop_t* loop,
+                                struct uv__iou* iou,
+                                int fd) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou_fd* st;
+
+  st = iou->fds + fd;
+  if (st->armed != 0) {
+    sqe = uv__iou_get_sqe(loop, iou);
+    sqe->opcode = UV__IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t) st->gen << 32 | (uint32_t) fd;
+    sqe->user_data = UV__IOU_IGNORE;
+    uv__iou_sqe_done(iou);
+  }
+
+  st->gen++;
+  st->armed = 0;
+}
+
+
+static void uv__iou_maybe_resize(struct uv__iou* iou, unsigned int len) {
+  struct uv__iou_fd* fds;
+
+  if (len <= iou->nfds)
+    return;
+
+  fds = uv__realloc(iou->fds, len * sizeof(fds[0]));
+  if (fds == NULL)
+    abort();
+
+  memset(fds + iou->nfds, 0, (len - iou->nfds) * sizeof(fds[0]));
+  iou->fds = fds;
+  iou->nfds = len;
+}
+
+
+void uv__iou_io_stop(uv_loop_t* loop, int fd) {
+  struct uv__iou* iou;
+
+  iou = loop->iou;
+  if ((unsigned) fd >= iou->nfds)
+    return;
+
+  /* Cancel the in-flight request right away, otherwise the ring keeps a
+   * reference to the file and a close() by the user wouldn't release it.
+   */
+  uv__iou_poll_remove(loop, iou, fd);
+}
+
+
+void uv__iou_poll(uv_loop_t* loop, int timeout) {
+  struct uv__io_uring_getevents_arg arg;
+  struct uv__kernel_timespec ts;
+  struct uv__io_uring_cqe cqe;
+  struct uv__iou_fd* st;
+  struct uv__iou* iou;
+  QUEUE* q;
+  uv__io_t* w;
+  uint64_t base;
+  uint64_t diff;
+  uint32_t head;
+  uint32_t tail;
+  unsigned int events;
+  unsigned int flags;
+  unsigned int min;
+  uint32_t fd;
+  int nevents;
+  int rc;
+
+  iou = loop->iou;
+  base = loop->time;
+
+  for (;;) {
+    uv__iou_maybe_resize(iou, loop->nwatchers);
+
+    while (!QUEUE_EMPTY(&loop->watcher_queue)) {
+      q = QUEUE_HEAD(&loop->watcher_queue);
+      QUEUE_REMOVE(q);
+      QUEUE_INIT(q);
+
+      w = QUEUE_DATA(q, uv__io_t, watcher_queue);
+      assert(w->pevents != 0);
+      assert(w->fd >= 0);
+      assert(w->fd < (int) loop->nwatchers);
+
+      st = iou->fds + w->fd;
+      if (st->armed != w->pevents) {
+        uv__iou_poll_remove(loop, iou, w->fd);
+        uv__iou_poll_add(loop, iou, w->fd, w->pevents);
+      }
+
+      w->events = w->pevents;
+    }
+
+    memset(&arg, 0, sizeof(arg));
+    flags = UV__IORING_ENTER_GETEVENTS | UV__IORING_ENTER_EXT_ARG;
+    min = 1;
+
+    if (timeout == 0) {
+      min = 0;
+    } else if (timeout > 0) {
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000;
+      arg.ts = (uint64_t) (uintptr_t) &ts;
+    }
+
+    /* Don't block when there are completions left over from a previous
+     * iteration, for example because the CQ ring overflowed.
+     */
+    head = *iou->cqhead;
+    tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+    if (head != tail)
+      min = 0;
+
+    UV_POLL_START(loop, timeout);
+    uv__metrics_poll_start(loop);
+
+    rc = uv__io_uring_enter(loop->backend_fd,
+                            *iou->sqtail -
+                                __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE),
+                            min,
+                            flags,
+                            &arg,
+                            sizeof(arg));
+
+    /* See the comment in uv__io_poll() about updating loop->time. */
+    SAVE_ERRNO(uv__update_time(loop));
+
+    if (rc == -1 && errno != ETIME && errno != EINTR && errno != EBUSY)
+      abort();
+
+    nevents = 0;
+    head = *iou->cqhead;
+    tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+    uv__metrics_poll_end(loop, tail - head);
+    UV_POLL_STOP(loop, (int) (tail - head));
+
+    while (head != tail) {
+      cqe = iou->cqes[head & iou->cqmask];
+      head++;
+      __atomic_store_n(iou->cqhead, head, __ATOMIC_RELEASE);
+
+      fd = (uint32_t) cqe.user_data;
+      if (fd == UV__IOU_IGNORE || fd >= iou->nfds)
+        continue;
+
+      /* Skip completions of superseded or cancelled requests. */
+      st = iou->fds + fd;
+      if (st->gen != (uint32_t) (cqe.user_data >> 32))
+        continue;
+
+      st->armed = 0;
+
+      w = loop->watchers[fd];
+      if (w == NULL)
+        continue;
+
+      /* The request is gone, the watcher needs to be re-armed. */
+      w->events = 0;
+
+      if (cqe.res < 0)
+        events = UV__POLLERR;
+      else
+        events = cqe.res;
+
+      /* Same filtering and EPOLLERR/EPOLLHUP quirk handling as the epoll
+       * backend, see uv__io_poll().
+       */
+      events &= w->pevents | UV__POLLERR | UV__POLLHUP;
+      if (events == UV__POLLERR || events == UV__POLLHUP)
+        events |= w->pevents & (UV__POLLIN | UV__POLLOUT);
+
+      if (events != 0) {
+        UV_IO_START(loop, w, fd, events);
+        w->cb(loop, w, events);
+        UV_IO_STOP(loop, w);
+        nevents++;
+      }
+
+      if (loop->watchers[fd] == w &&
+          w->pevents != 0 &&
+          w->events == 0 &&
+          QUEUE_EMPTY(&w->watcher_queue)) {
+        QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+      }
+
+      tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+    }
+
+    if (nevents != 0)
+      return;
+
+    if (timeout == 0)
+      return;
+
+    if (timeout == -1)
+      continue;
+
+    assert(timeout > 0);
+
+    diff = loop->time - base;
+    if (diff >= (uint64_t) timeout)
+      return;
+
+    timeout -= diff;
+  }
+}
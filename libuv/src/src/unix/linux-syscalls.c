@@ -229,6 +229,56 @@
 # endif
 #endif /* __NR_pwritev */
 
+#ifndef __NR_io_uring_setup
+# if defined(__x86_64__)
+#  define __NR_io_uring_setup 425
+# elif defined(__i386__)
+#  define __NR_io_uring_setup 425
+# elif defined(__arm__)
+#  define __NR_io_uring_setup (UV_SYSCALL_BASE + 425)
+# endif
+#endif /* __NR_io_uring_setup */
+
+#ifndef __NR_io_uring_enter
+# if defined(__x86_64__)
+#  define __NR_io_uring_enter 426
+# elif defined(__i386__)
+#  define __NR_io_uring_enter 426
+# elif defined(__arm__)
+#  define __NR_io_uring_enter (UV_SYSCALL_BASE + 426)
+# endif
+#endif /* __NR_io_uring_enter */
+
+#ifndef __NR_pidfd_open
+# if defined(__x86_64__)
+#  define __NR_pidfd_open 434
+# elif defined(__i386__)
+#  define __NR_pidfd_open 434
+# elif defined(__arm__)
+#  define __NR_pidfd_open (UV_SYSCALL_BASE + 434)
+# endif
+#endif /* __NR_pidfd_open */
+
+#ifndef __NR_signalfd4
+# if defined(__x86_64__)
+#  define __NR_signalfd4 289
+# elif defined(__i386__)
+#  define __NR_signalfd4 327
+# elif defined(__arm__)
+#  define __NR_signalfd4 (UV_SYSCALL_BASE + 355)
+# endif
+#endif /* __NR_signalfd4 */
+
+#ifndef __NR_getrandom
+# if defined(__x86_64__)
+#  define __NR_getrandom 318
+# elif defined(__i386__)
+#  define __NR_getrandom 355
+# elif defined(__arm__)
+#  define __NR_getrandom (UV_SYSCALL_BASE + 384)
+# endif
+#endif /* __NR_getrandom */
+
 
 int uv__accept4(int fd, struct sockaddr* addr, socklen_t* addrlen, int flags) {
 #if defined(__i386__)
@@ -335,6 +385,64 @@ int uv__epoll_pwait(int epfd,
 }
 
 
+int uv__io_uring_setup(unsigned int entries,
+                       struct uv__io_uring_params* params) {
+#if defined(__NR_io_uring_setup)
+  return syscall(__NR_io_uring_setup, entries, params);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__io_uring_enter(int fd,
+                       unsigned int to_submit,
+                       unsigned int min_complete,
+                       unsigned int flags,
+                       const void* arg,
+                       size_t argsz) {
+#if defined(__NR_io_uring_enter)
+  return syscall(__NR_io_uring_enter,
+                 fd,
+                 to_submit,
+                 min_complete,
+                 flags,
+                 arg,
+                 argsz);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__pidfd_open(int pid, unsigned int flags) {
+#if defined(__NR_pidfd_open)
+  return syscall(__NR_pidfd_open, pid, flags);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__signalfd4(int fd, const sigset_t* mask, int flags) {
+#if defined(__NR_signalfd4)
+  /* The kernel's sigset_t is 64 bits, glibc's is a lot bigger. */
+  return syscall(__NR_signalfd4, fd, mask, 8, flags);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+ssize_t uv__getrandom(void* buf, size_t len, unsigned int flags) {
+#if defined(__NR_getrandom)
+  return syscall(__NR_getrandom, buf, len, flags);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
 int uv__inotify_init(void) {
 #if defined(__NR_inotify_init)
   return syscall(__NR_inotify_init);
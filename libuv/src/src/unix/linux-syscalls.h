@@ -59,9 +59,14 @@
 #define UV__IN_CLOEXEC        UV__O_CLOEXEC
 #define UV__IN_NONBLOCK       UV__O_NONBLOCK
 
+#define UV__SFD_CLOEXEC       UV__O_CLOEXEC
+#define UV__SFD_NONBLOCK      UV__O_NONBLOCK
+
 #define UV__SOCK_CLOEXEC      UV__O_CLOEXEC
 #define UV__SOCK_NONBLOCK     UV__O_NONBLOCK
 
+#define UV__GRND_NONBLOCK     0x1
+
 /* epoll flags */
 #define UV__EPOLL_CLOEXEC     UV__O_CLOEXEC
 #define UV__EPOLL_CTL_ADD     1
@@ -72,6 +77,7 @@
 #define UV__EPOLLOUT          4
 #define UV__EPOLLERR          8
 #define UV__EPOLLHUP          16
+#define UV__EPOLLEXCLUSIVE    0x10000000
 #define UV__EPOLLONESHOT      0x40000000
 #define UV__EPOLLET           0x80000000
 
@@ -89,6 +95,18 @@
 #define UV__IN_DELETE_SELF    0x400
 #define UV__IN_MOVE_SELF      0x800
 
+/* io_uring flags */
+#define UV__IORING_SETUP_CQSIZE       0x8
+#define UV__IORING_FEAT_SINGLE_MMAP   0x1
+#define UV__IORING_FEAT_NODROP        0x2
+#define UV__IORING_FEAT_EXT_ARG       0x100
+#define UV__IORING_ENTER_GETEVENTS    0x1
+#define UV__IORING_ENTER_EXT_ARG      0x8
+#define UV__IORING_OFF_SQ_RING        0x0
+#define UV__IORING_OFF_SQES           0x10000000
+#define UV__IORING_OP_POLL_ADD        6
+#define UV__IORING_OP_POLL_REMOVE     7
+
 #if defined(__x86_64__)
 struct uv__epoll_event {
   uint32_t events;
@@ -109,6 +127,85 @@ struct uv__inotify_event {
   /* char name[0]; */
 };
 
+struct uv__io_sqring_offsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t flags;
+  uint32_t dropped;
+  uint32_t array;
+  uint32_t reserved0;
+  uint64_t reserved1;
+};
+
+struct uv__io_cqring_offsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t overflow;
+  uint32_t cqes;
+  uint32_t flags;
+  uint32_t reserved0;
+  uint64_t reserved1;
+};
+
+struct uv__io_uring_params {
+  uint32_t sq_entries;
+  uint32_t cq_entries;
+  uint32_t flags;
+  uint32_t sq_thread_cpu;
+  uint32_t sq_thread_idle;
+  uint32_t features;
+  uint32_t wq_fd;
+  uint32_t reserved[3];
+  struct uv__io_sqring_offsets sq_off;
+  struct uv__io_cqring_offsets cq_off;
+};
+
+struct uv__io_uring_sqe {
+  uint8_t opcode;
+  uint8_t flags;
+  uint16_t ioprio;
+  int32_t fd;
+  uint64_t off;
+  uint64_t addr;
+  uint32_t len;
+  uint32_t rw_flags;  /* Also poll32_events for IORING_OP_POLL_ADD. */
+  uint64_t user_data;
+  uint16_t buf_index;
+  uint16_t personality;
+  int32_t splice_fd_in;
+  uint64_t pad[2];
+};
+
+struct uv__io_uring_cqe {
+  uint64_t user_data;
+  int32_t res;
+  uint32_t flags;
+};
+
+struct uv__io_uring_getevents_arg {
+  uint64_t sigmask;
+  uint32_t sigmask_sz;
+  uint32_t pad;
+  uint64_t ts;
+};
+
+struct uv__kernel_timespec {
+  int64_t tv_sec;
+  int64_t tv_nsec;
+};
+
+struct uv__signalfd_siginfo {
+  uint32_t ssi_signo;
+  int32_t ssi_errno;
+  int32_t ssi_code;
+  uint32_t ssi_pid;
+  unsigned char pad[112];
+};
+
 struct uv__mmsghdr {
   struct msghdr msg_hdr;
   unsigned int msg_len;
@@ -129,6 +226,17 @@ int uv__epoll_pwait(int epfd,
                     int timeout,
                     const sigset_t* sigmask);
 int uv__eventfd2(unsigned int count, int flags);
+int uv__io_uring_setup(unsigned int entries,
+                       struct uv__io_uring_params* params);
+int uv__io_uring_enter(int fd,
+                       unsigned int to_submit,
+                       unsigned int min_complete,
+                       unsigned int flags,
+                       const void* arg,
+                       size_t argsz);
+int uv__pidfd_open(int pid, unsigned int flags);
+int uv__signalfd4(int fd, const sigset_t* mask, int flags);
+ssize_t uv__getrandom(void* buf, size_t len, unsigned int flags);
 int uv__inotify_init(void);
 int uv__inotify_init1(int flags);
 int uv__inotify_add_watch(int fd, const char* path, uint32_t mask);
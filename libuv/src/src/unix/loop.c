@@ -74,12 +74,12 @@ int uv_loop_close(uv_loop_t* loop) {
 uv_loop_t* uv_loop_new(void) {
   uv_loop_t* loop;
 
-  loop = malloc(sizeof(*loop));
+  loop = uv__malloc(sizeof(*loop));
   if (loop == NULL)
     return NULL;
 
   if (uv_loop_init(loop)) {
-    free(loop);
+    uv__free(loop);
     return NULL;
   }
 
@@ -94,7 +94,7 @@ void uv_loop_delete(uv_loop_t* loop) {
   err = uv_loop_close(loop);
   assert(err == 0);
   if (loop != default_loop)
-    free(loop);
+    uv__free(loop);
 }
 
 
@@ -109,7 +109,8 @@ static int uv__loop_init(uv_loop_t* loop, int default_loop) {
   QUEUE_INIT(&loop->wq);
   QUEUE_INIT(&loop->active_reqs);
   QUEUE_INIT(&loop->idle_handles);
-  QUEUE_INIT(&loop->async_handles);
+  QUEUE_INIT(&loop->async_pending);
+  loop->async_stack = NULL;
   QUEUE_INIT(&loop->check_handles);
   QUEUE_INIT(&loop->prepare_handles);
   QUEUE_INIT(&loop->handle_queue);
@@ -191,7 +192,16 @@ static void uv__loop_close(uv_loop_t* loop) {
   assert(loop->nfds == 0);
 #endif
 
-  free(loop->watchers);
+  uv__free(loop->watchers);
   loop->watchers = NULL;
   loop->nwatchers = 0;
+
+  uv__free(loop->timer_wheel);
+  loop->timer_wheel = NULL;
+
+  uv__free(loop->metrics);
+  loop->metrics = NULL;
+
+  uv__buf_pool_close(loop);
+  uv__dns_cache_close(loop);
 }
@@ -0,0 +1,190 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct uv__metrics {
+  /* The work histograms are written by the threadpool and guarded by the
+   * loop's wq_mutex, everything else belongs to the loop thread.
+   */
+  uv_loop_metrics_t m;
+  uint64_t poll_start;
+  uint64_t poll_end;  /* 0 when the loop isn't running. */
+};
+
+
+void uv__metrics_histogram_add(uv_metrics_histogram_t* h, uint64_t value) {
+  unsigned int i;
+  uint64_t v;
+
+  for (i = 0, v = value; v != 0 && i < UV_METRICS_HISTOGRAM_BUCKETS - 1; i++)
+    v >>= 1;
+
+  h->counts[i]++;
+  h->samples++;
+  h->sum += value;
+  if (h->max < value)
+    h->max = value;
+}
+
+
+void uv__metrics_record_iteration(uv_loop_t* loop) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  metrics->m.iterations++;
+}
+
+
+void uv__metrics_record_run_stop(uv_loop_t* loop) {
+  struct uv__metrics* metrics;
+
+  /* Time spent outside uv_run() isn't time the loop was busy. */
+  metrics = loop->metrics;
+  metrics->poll_end = 0;
+}
+
+
+void uv__metrics_record_poll_start(uv_loop_t* loop) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  metrics->poll_start = uv__hrtime(UV_CLOCK_PRECISE);
+
+  if (metrics->poll_end != 0)
+    uv__metrics_histogram_add(&metrics->m.busy,
+                              (metrics->poll_start - metrics->poll_end) / 1000);
+}
+
+
+void uv__metrics_record_poll_end(uv_loop_t* loop, int nevents) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  metrics->poll_end = uv__hrtime(UV_CLOCK_PRECISE);
+
+  if (nevents < 0)
+    nevents = 0;
+
+  metrics->m.polls++;
+  metrics->m.poll_time += metrics->poll_end - metrics->poll_start;
+  metrics->m.events += nevents;
+  uv__metrics_histogram_add(&metrics->m.poll_events, nevents);
+}
+
+
+uint64_t uv__metrics_record_work_submit(uv_loop_t* loop) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  metrics->m.work_submitted++;
+
+  return uv__hrtime(UV_CLOCK_PRECISE);
+}
+
+
+/* Called by a worker with loop->wq_mutex held. */
+void uv__metrics_record_work(uv_loop_t* loop, uint64_t wait, uint64_t run) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  uv__metrics_histogram_add(&metrics->m.work_wait, wait / 1000);
+  uv__metrics_histogram_add(&metrics->m.work_run, run / 1000);
+}
+
+
+void uv__metrics_record_work_done(uv_loop_t* loop, unsigned int n) {
+  struct uv__metrics* metrics;
+
+  metrics = loop->metrics;
+  metrics->m.work_completed += n;
+}
+
+
+int uv_loop_set_metrics(uv_loop_t* loop, int enable) {
+  struct uv__metrics* metrics;
+
+  if ((loop->metrics != NULL) == (enable != 0))
+    return 0;
+
+  metrics = NULL;
+  if (enable) {
+    metrics = uv__calloc(1, sizeof(*metrics));
+    if (metrics == NULL)
+      return -ENOMEM;
+  }
+
+  /* Workers look at loop->metrics under the mutex. */
+  uv_mutex_lock(&loop->wq_mutex);
+  if (enable == 0) {
+    metrics = loop->metrics;
+    loop->metrics = NULL;
+  } else {
+    loop->metrics = metrics;
+    metrics = NULL;
+  }
+  uv_mutex_unlock(&loop->wq_mutex);
+
+  uv__free(metrics);
+
+  return 0;
+}
+
+
+int uv_loop_metrics(const uv_loop_t* cloop, uv_loop_metrics_t* metrics) {
+  uv_loop_t* loop;
+  unsigned int n;
+  QUEUE* q;
+
+  /* Only for the mutex and the queue macros, nothing is changed. */
+  loop = (uv_loop_t*) cloop;
+  memset(metrics, 0, sizeof(*metrics));
+
+  if (loop->metrics != NULL) {
+    uv_mutex_lock(&loop->wq_mutex);
+    *metrics = ((struct uv__metrics*) loop->metrics)->m;
+    uv_mutex_unlock(&loop->wq_mutex);
+  }
+
+  n = 0;
+  QUEUE_FOREACH(q, &loop->pending_queue)
+    n++;
+  metrics->pending = n;
+
+  n = 0;
+  QUEUE_FOREACH(q, &loop->active_reqs)
+    n++;
+  metrics->active_reqs = n;
+
+  metrics->timers = uv__timer_count(loop);
+  metrics->active_handles = loop->active_handles;
+
+#if defined(__linux__)
+  metrics->poll_ctl_saved = loop->epoll_ctl_saved;
+  metrics->poll_ctl_saved_total = loop->epoll_ctl_saved_total;
+#endif
+
+  return 0;
+}
@@ -44,6 +44,19 @@ extern char **environ;
 # include <grp.h>
 #endif
 
+/* posix_spawn() in glibc 2.29+ and musl 1.1.24+ goes through
+ * clone(CLONE_VM | CLONE_VFORK), reports exec errors back to the caller and
+ * has posix_spawn_file_actions_addchdir_np. Together with clearing
+ * FD_CLOEXEC for dup2(fd, fd) file actions, which CMake checks for
+ * separately, that's everything uv__process_child_init() does short of
+ * changing the uid or gid, without copying the parent's page tables.
+ */
+#if defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP)
+# include <spawn.h>
+# include <string.h>
+# define UV__POSIX_SPAWN 1
+#endif
+
 
 static QUEUE* uv__process_queue(uv_loop_t* loop, int pid) {
   assert(pid > 0);
@@ -51,11 +64,30 @@ static QUEUE* uv__process_queue(uv_loop_t* loop, int pid) {
 }
 
 
+static void uv__process_exit(uv_process_t* process) {
+  int exit_status;
+  int term_signal;
+
+  uv__handle_stop(process);
+
+  if (process->exit_cb == NULL)
+    return;
+
+  exit_status = 0;
+  if (WIFEXITED(process->status))
+    exit_status = WEXITSTATUS(process->status);
+
+  term_signal = 0;
+  if (WIFSIGNALED(process->status))
+    term_signal = WTERMSIG(process->status);
+
+  process->exit_cb(process, exit_status, term_signal);
+}
+
+
 static void uv__chld(uv_signal_t* handle, int signum) {
   uv_process_t* process;
   uv_loop_t* loop;
-  int exit_status;
-  int term_signal;
   unsigned int i;
   int status;
   pid_t pid;
@@ -100,22 +132,115 @@ static void uv__chld(uv_signal_t* handle, int signum) {
       QUEUE_INIT(q);
 
       process = QUEUE_DATA(q, uv_process_t, queue);
-      uv__handle_stop(process);
+      uv__process_exit(process);
+    }
+  }
+}
 
-      if (process->exit_cb == NULL)
-        continue;
 
-      exit_status = 0;
-      if (WIFEXITED(process->status))
-        exit_status = WEXITSTATUS(process->status);
+#if defined(__linux__)
+/* A pidfd becomes readable when the process exits, which lets the loop reap
+ * children one at a time instead of scanning all of them on every SIGCHLD.
+ * -1 means unknown, the first successful pidfd_open() settles it.
+ */
+static int uv__pidfd_works = -1;
+
+
+static void uv__process_pidfd_io(uv_loop_t* loop,
+                                 uv__io_t* w,
+                                 unsigned int events) {
+  uv_process_t* process;
+  int status;
+  pid_t pid;
+
+  process = container_of(w, uv_process_t, pidfd_watcher);
+
+  do
+    pid = waitpid(process->pid, &status, WNOHANG);
+  while (pid == -1 && errno == EINTR);
+
+  if (pid == 0)
+    return;
+
+  if (pid == -1) {
+    if (errno != ECHILD)
+      abort();
+
+    /* Fed by uv__process_watch(), the SIGCHLD handler takes it from here. */
+    if (w->fd == -1)
+      return;
 
-      term_signal = 0;
-      if (WIFSIGNALED(process->status))
-        term_signal = WTERMSIG(process->status);
+    /* Reaped by someone else, e.g. because SIGCHLD is ignored. The pidfd
+     * won't become unreadable again, report the exit rather than spin.
+     */
+    status = 0;
+  }
 
-      process->exit_cb(process, exit_status, term_signal);
+  if (w->fd != -1) {
+    uv__io_close(loop, w);
+    uv__close(w->fd);
+    w->fd = -1;
+  }
+
+  QUEUE_REMOVE(&process->queue);
+  QUEUE_INIT(&process->queue);
+
+  process->status = status;
+  uv__process_exit(process);
+}
+
+
+static int uv__process_queues_empty(uv_loop_t* loop) {
+  unsigned int i;
+
+  for (i = 0; i < ARRAY_SIZE(loop->process_handles); i++)
+    if (!QUEUE_EMPTY(loop->process_handles + i))
+      return 0;
+
+  return 1;
+}
+#endif  /* defined(__linux__) */
+
+
+/* Start watching a child process that has successfully exec'd. */
+static void uv__process_watch(uv_loop_t* loop, uv_process_t* process) {
+#if defined(__linux__)
+  int fd;
+
+  if (uv__pidfd_works != 0) {
+    fd = uv__pidfd_open(process->pid, 0);
+
+    if (fd != -1) {
+      uv__pidfd_works = 1;
+      process->pidfd_watcher.fd = fd;
+      uv__io_start(loop, &process->pidfd_watcher, UV__POLLIN);
+      uv__handle_start(process);
+
+      /* The SIGCHLD handler was only there for the first spawn. */
+      if (uv__is_active(&loop->child_watcher) && uv__process_queues_empty(loop))
+        uv_signal_stop(&loop->child_watcher);
+
+      return;
     }
+
+    if (errno == ENOSYS || errno == EINVAL)
+      uv__pidfd_works = 0;
+  }
+#endif
+
+  QUEUE_INSERT_TAIL(uv__process_queue(loop, process->pid), &process->queue);
+  uv__handle_start(process);
+
+#if defined(__linux__)
+  /* uv_spawn() skipped the SIGCHLD watcher because pidfds were known to
+   * work. The child may have exited before the handler was installed, check
+   * once on the next loop iteration.
+   */
+  if (!uv__is_active(&loop->child_watcher)) {
+    uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+    uv__io_feed(loop, &process->pidfd_watcher);
   }
+#endif
 }
 
 
@@ -363,49 +488,166 @@ static void uv__process_child_init(const uv_process_options_t* options,
 }
 
 
-int uv_spawn(uv_loop_t* loop,
-             uv_process_t* process,
-             const uv_process_options_t* options) {
-  int signal_pipe[2] = { -1, -1 };
-  int (*pipes)[2];
-  int stdio_count;
-  QUEUE* q;
-  ssize_t r;
-  pid_t pid;
+#if defined(UV__POSIX_SPAWN)
+/* posix_spawnp() looks up the file in the parent's PATH while execvp() in
+ * the fork path sees options->env. Only take the fast path when they agree.
+ */
+static int uv__process_same_path(const uv_process_options_t* options) {
+  const char* path;
+  char** env;
+
+  if (options->env == NULL || strchr(options->file, '/') != NULL)
+    return 1;
+
+  path = getenv("PATH");
+
+  for (env = options->env; *env != NULL; env++)
+    if (strncmp(*env, "PATH=", 5) == 0)
+      return path != NULL && strcmp(*env + 5, path) == 0;
+
+  return path == NULL;
+}
+
+
+/* A descriptor that is inherited at its own number is passed on with a
+ * dup2(fd, fd) file action. Where that doesn't clear FD_CLOEXEC, take the
+ * fork path for descriptors that have it set.
+ */
+static int uv__process_same_fds(int stdio_count, int (*pipes)[2]) {
+#if !defined(HAVE_POSIX_SPAWN_DUP2_CLOEXEC)
+  int flags;
+  int fd;
+
+  for (fd = 0; fd < stdio_count; fd++) {
+    if (pipes[fd][1] != fd)
+      continue;
+
+    flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || (flags & FD_CLOEXEC))
+      return 0;
+  }
+#endif
+
+  return 1;
+}
+
+
+static int uv__process_posix_spawn(uv_loop_t* loop,
+                                   const uv_process_options_t* options,
+                                   int stdio_count,
+                                   int (*pipes)[2],
+                                   pid_t* pid,
+                                   int* exec_errorno) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+#if defined(__linux__)
+  sigset_t blocked;
+  sigset_t sigmask;
+  int signum;
+#endif
+  char** env;
+  short flags;
+  int use_fd;
   int err;
-  int exec_errorno;
-  int i;
+  int fd;
 
-  assert(options->file != NULL);
-  assert(!(options->flags & ~(UV_PROCESS_DETACHED |
-                              UV_PROCESS_SETGID |
-                              UV_PROCESS_SETUID |
-                              UV_PROCESS_WINDOWS_HIDE |
-                              UV_PROCESS_WINDOWS_VERBATIM_ARGUMENTS)));
+  err = posix_spawn_file_actions_init(&actions);
+  if (err)
+    return -err;
 
-  uv__handle_init(loop, (uv_handle_t*)process, UV_PROCESS);
-  QUEUE_INIT(&process->queue);
+  err = posix_spawnattr_init(&attr);
+  if (err) {
+    posix_spawn_file_actions_destroy(&actions);
+    return -err;
+  }
 
-  stdio_count = options->stdio_count;
-  if (stdio_count < 3)
-    stdio_count = 3;
+  flags = 0;
 
-  err = -ENOMEM;
-  pipes = malloc(stdio_count * sizeof(*pipes));
-  if (pipes == NULL)
-    goto error;
+  if (options->flags & UV_PROCESS_DETACHED)
+    flags |= POSIX_SPAWN_SETSID;
 
-  for (i = 0; i < stdio_count; i++) {
-    pipes[i][0] = -1;
-    pipes[i][1] = -1;
+#if defined(__linux__)
+  /* Don't pass on the signals the loop blocked for its signalfd. */
+  if (loop->signalfd_blocked != 0) {
+    uv__signal_blocked_set(loop, &blocked);
+    pthread_sigmask(SIG_SETMASK, NULL, &sigmask);
+
+    for (signum = 1; signum < NSIG; signum++)
+      if (sigismember(&blocked, signum))
+        sigdelset(&sigmask, signum);
+
+    err = posix_spawnattr_setsigmask(&attr, &sigmask);
+    flags |= POSIX_SPAWN_SETSIGMASK;
   }
+#endif
 
-  for (i = 0; i < options->stdio_count; i++) {
-    err = uv__process_init_stdio(options->stdio + i, pipes[i]);
-    if (err)
-      goto error;
+  if (flags != 0 && err == 0)
+    err = posix_spawnattr_setflags(&attr, flags);
+
+  /* Same sequence of operations as uv__process_child_init(). O_NONBLOCK
+   * lives in the open file description, which the child shares with us, so
+   * it's cleared here rather than in the child.
+   */
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+
+    if (use_fd < 0) {
+      if (fd < 3)
+        err = posix_spawn_file_actions_addopen(&actions,
+                                               fd,
+                                               "/dev/null",
+                                               fd == 0 ? O_RDONLY : O_RDWR,
+                                               0);
+      continue;
+    }
+
+    if (fd <= 2)
+      uv__nonblock(use_fd, 0);
+
+    err = posix_spawn_file_actions_adddup2(&actions, use_fd, fd);
+  }
+
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+
+    if (use_fd >= 0 && fd != use_fd)
+      err = posix_spawn_file_actions_addclose(&actions, use_fd);
+  }
+
+  if (options->cwd != NULL && err == 0)
+    err = posix_spawn_file_actions_addchdir_np(&actions, options->cwd);
+
+  if (err == 0) {
+    env = options->env != NULL ? options->env : environ;
+    *exec_errorno = -posix_spawnp(pid,
+                                  options->file,
+                                  &actions,
+                                  &attr,
+                                  options->args,
+                                  env);
   }
 
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+
+  return -err;
+}
+#endif
+
+
+static int uv__process_fork(uv_loop_t* loop,
+                            const uv_process_options_t* options,
+                            int stdio_count,
+                            int (*pipes)[2],
+                            pid_t* pid,
+                            int* exec_errorno) {
+  int signal_pipe[2] = { -1, -1 };
+#if defined(__linux__)
+  sigset_t blocked;
+#endif
+  ssize_t r;
+  int err;
+
   /* This pipe is used by the parent to wait until
    * the child has called `execve()`. We need this
    * to avoid the following race condition:
@@ -428,23 +670,30 @@ int uv_spawn(uv_loop_t* loop,
    */
   err = uv__make_pipe(signal_pipe, 0);
   if (err)
-    goto error;
+    return err;
 
-  uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+#if defined(__linux__)
+  uv__signal_blocked_set(loop, &blocked);
+#endif
 
   /* Acquire write lock to prevent opening new fds in worker threads */
   uv_rwlock_wrlock(&loop->cloexec_lock);
-  pid = fork();
+  *pid = fork();
 
-  if (pid == -1) {
+  if (*pid == -1) {
     err = -errno;
     uv_rwlock_wrunlock(&loop->cloexec_lock);
     uv__close(signal_pipe[0]);
     uv__close(signal_pipe[1]);
-    goto error;
+    return err;
   }
 
-  if (pid == 0) {
+  if (*pid == 0) {
+#if defined(__linux__)
+    /* Don't pass on the signals the loop blocked for its signalfd. */
+    if (loop->signalfd_blocked != 0)
+      sigprocmask(SIG_UNBLOCK, &blocked, NULL);
+#endif
     uv__process_child_init(options, stdio_count, pipes, signal_pipe[1]);
     abort();
   }
@@ -453,15 +702,14 @@ int uv_spawn(uv_loop_t* loop,
   uv_rwlock_wrunlock(&loop->cloexec_lock);
   uv__close(signal_pipe[1]);
 
-  process->status = 0;
-  exec_errorno = 0;
+  *exec_errorno = 0;
   do
-    r = read(signal_pipe[0], &exec_errorno, sizeof(exec_errorno));
+    r = read(signal_pipe[0], exec_errorno, sizeof(*exec_errorno));
   while (r == -1 && errno == EINTR);
 
   if (r == 0)
     ; /* okay, EOF */
-  else if (r == sizeof(exec_errorno))
+  else if (r == sizeof(*exec_errorno))
     ; /* okay, read errorno */
   else if (r == -1 && errno == EPIPE)
     ; /* okay, got EPIPE */
@@ -470,6 +718,94 @@ int uv_spawn(uv_loop_t* loop,
 
   uv__close(signal_pipe[0]);
 
+  return 0;
+}
+
+
+int uv_spawn(uv_loop_t* loop,
+             uv_process_t* process,
+             const uv_process_options_t* options) {
+  int (*pipes)[2];
+  int stdio_count;
+  pid_t pid;
+  int err;
+  int exec_errorno;
+  int i;
+
+  assert(options->file != NULL);
+  assert(!(options->flags & ~(UV_PROCESS_DETACHED |
+                              UV_PROCESS_SETGID |
+                              UV_PROCESS_SETUID |
+                              UV_PROCESS_WINDOWS_HIDE |
+                              UV_PROCESS_WINDOWS_VERBATIM_ARGUMENTS)));
+
+  uv__handle_init(loop, (uv_handle_t*)process, UV_PROCESS);
+  QUEUE_INIT(&process->queue);
+#if defined(__linux__)
+  uv__io_init(&process->pidfd_watcher, uv__process_pidfd_io, -1);
+#endif
+
+  stdio_count = options->stdio_count;
+  if (stdio_count < 3)
+    stdio_count = 3;
+
+  err = -ENOMEM;
+  pipes = uv__malloc(stdio_count * sizeof(*pipes));
+  if (pipes == NULL)
+    goto error;
+
+  for (i = 0; i < stdio_count; i++) {
+    pipes[i][0] = -1;
+    pipes[i][1] = -1;
+  }
+
+  for (i = 0; i < options->stdio_count; i++) {
+    err = uv__process_init_stdio(options->stdio + i, pipes[i]);
+    if (err)
+      goto error;
+  }
+
+  /* Children are reaped through their pidfd when the kernel supports it.
+   * Until that's known, install the SIGCHLD handler before forking so an
+   * early exit isn't missed.
+   */
+#if defined(__linux__)
+  if (uv__pidfd_works != 1)
+#endif
+    uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+
+  /* fork() copies the page tables of the parent, which gets slow for big
+   * processes. Changing the uid or gid still needs it, everything else can
+   * go through posix_spawn().
+   */
+  pid = 0;
+#if defined(UV__POSIX_SPAWN)
+  if (!(options->flags & (UV_PROCESS_SETUID | UV_PROCESS_SETGID)) &&
+      uv__process_same_path(options) &&
+      uv__process_same_fds(stdio_count, pipes)) {
+    /* Acquire write lock to prevent opening new fds in worker threads */
+    uv_rwlock_wrlock(&loop->cloexec_lock);
+    err = uv__process_posix_spawn(loop,
+                                  options,
+                                  stdio_count,
+                                  pipes,
+                                  &pid,
+                                  &exec_errorno);
+    uv_rwlock_wrunlock(&loop->cloexec_lock);
+  } else
+#endif
+    err = uv__process_fork(loop,
+                           options,
+                           stdio_count,
+                           pipes,
+                           &pid,
+                           &exec_errorno);
+
+  if (err)
+    goto error;
+
+  process->status = 0;
+
   for (i = 0; i < options->stdio_count; i++) {
     err = uv__process_open_stream(options->stdio + i, pipes[i], i == 0);
     if (err == 0)
@@ -481,17 +817,14 @@ int uv_spawn(uv_loop_t* loop,
     goto error;
   }
 
-  /* Only activate this handle if exec() happened successfully */
-  if (exec_errorno == 0) {
-    q = uv__process_queue(loop, pid);
-    QUEUE_INSERT_TAIL(q, &process->queue);
-    uv__handle_start(process);
-  }
-
   process->pid = pid;
   process->exit_cb = options->exit_cb;
 
-  free(pipes);
+  /* Only activate this handle if exec() happened successfully */
+  if (exec_errorno == 0)
+    uv__process_watch(loop, process);
+
+  uv__free(pipes);
   return exec_errorno;
 
 error:
@@ -505,7 +838,7 @@ error:
       if (pipes[i][1] != -1)
         close(pipes[i][1]);
     }
-    free(pipes);
+    uv__free(pipes);
   }
 
   return err;
@@ -528,5 +861,14 @@ int uv_kill(int pid, int signum) {
 void uv__process_close(uv_process_t* handle) {
   /* TODO stop signal watcher when this is the last handle */
   QUEUE_REMOVE(&handle->queue);
+#if defined(__linux__)
+  QUEUE_REMOVE(&handle->pidfd_watcher.pending_queue);
+  QUEUE_INIT(&handle->pidfd_watcher.pending_queue);
+  if (handle->pidfd_watcher.fd != -1) {
+    uv__io_close(handle->loop, &handle->pidfd_watcher);
+    uv__close(handle->pidfd_watcher.fd);
+    handle->pidfd_watcher.fd = -1;
+  }
+#endif
   uv__handle_stop(handle);
 }
@@ -0,0 +1,1677 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UV__RESOLV_CONF "/etc/resolv.conf"
+#define UV__HOSTS "/etc/hosts"
+
+/* The limits that the libc resolvers apply to resolv.conf. */
+#define UV__RESOLVER_MAXNS 3
+#define UV__RESOLVER_MAXSEARCH 6
+#define UV__RESOLVER_MAXNDOTS 15
+#define UV__RESOLVER_MAXATTEMPTS 5
+#define UV__RESOLVER_MAXTIMEOUT 30
+
+#define UV__DNS_PORT 53
+#define UV__DNS_NAME_MAX 253  /* Presentation format, without trailing dot. */
+#define UV__DNS_HEADER_SIZE 12
+#define UV__DNS_QUESTION_MAX (UV__DNS_HEADER_SIZE + UV__DNS_NAME_MAX + 2 + 4)
+/* Queries don't carry an EDNS0 option so servers truncate their answers at
+ * 512 bytes and set the TC bit. Anything longer is retried over TCP.
+ */
+#define UV__DNS_UDP_SIZE 512
+#define UV__DNS_RECV_SLOTS 16
+
+#define UV__DNS_CLASS_IN 1
+#define UV__DNS_TYPE_CNAME 5
+
+#define UV__DNS_FLAG_QR 0x8000
+#define UV__DNS_FLAG_TC 0x0200
+#define UV__DNS_FLAG_RD 0x0100
+
+#define UV__DNS_RCODE_NOERROR 0
+#define UV__DNS_RCODE_NXDOMAIN 3
+
+#define UV__RESOLVER_BUCKETS 1024
+
+/* Queries past this many wait for a slot. When thousands of datagrams go out
+ * at once the answers would overflow the socket's receive buffer before the
+ * loop gets to read them; the answers would be lost and the queries time out.
+ */
+#define UV__RESOLVER_MAX_ACTIVE 256
+
+/* Queries that go out over one UDP socket before it's replaced by a new one,
+ * which gets a new source port from the kernel.
+ */
+#define UV__RESOLVER_ROTATE 64
+
+struct uv__resolver_ctx;
+struct uv__resolver_server;
+
+/* A socket that has been replaced is retired. It stays open until the
+ * queries whose last datagram went out on it are done.
+ */
+struct uv__resolver_socket {
+  uv_udp_t handle;
+  struct uv__resolver_ctx* ctx;
+  struct uv__resolver_server* server;
+  void* retired_queue[2];
+  unsigned int nqueries;
+  unsigned int nsends;
+  int retired;
+};
+
+struct uv__resolver_server {
+  struct uv__resolver_socket* socket;
+  struct sockaddr_storage addr;
+};
+
+/* Queries that got a truncated answer retry over TCP. The connection lives
+ * in its own allocation because the query may be done before the handle has
+ * been closed.
+ */
+struct uv__resolver_tcp {
+  uv_tcp_t handle;
+  uv_connect_t connect_req;
+  uv_write_t write_req;
+  struct uv__resolver_query* query;  /* NULL once the query moved on. */
+  unsigned char* buf;
+  size_t len;
+  unsigned char packet[2 + UV__DNS_QUESTION_MAX];
+};
+
+struct uv__resolver_host {
+  struct uv__resolver_host* next;
+  uv_dns_type type;
+  union {
+    struct in_addr in;
+    struct in6_addr in6;
+  } addr;
+  char name[1];  /* Variable length. */
+};
+
+struct uv__resolver_query {
+  void* queue[2];     /* Waiting, in flight ordered by deadline, or done. */
+  void* id_queue[2];  /* Hash bucket of the query ID. */
+  uv_resolve_t* req;
+  struct uv__resolver_ctx* ctx;
+  struct uv__resolver_tcp* tcp;
+  struct uv__resolver_socket* socket;  /* Of the last UDP send. */
+  uv_dns_record_t* records;
+  unsigned int nrecords;
+  uint64_t deadline;
+  unsigned int candidate;  /* Next name from the search list. */
+  unsigned int tries;      /* Sends for the current name. */
+  unsigned int maxtries;
+  unsigned int server;     /* Server of the last send. */
+  int active;              /* Holds one of the UV__RESOLVER_MAX_ACTIVE slots. */
+  int use_tcp;
+  int failed;              /* A server answered with an error. */
+  int status;
+  unsigned short id;
+  uv_dns_type type;
+  size_t len;
+  /* The question with room for the length prefix of DNS over TCP. */
+  unsigned char packet[2 + UV__DNS_QUESTION_MAX];
+  char qname[UV__DNS_NAME_MAX + 1];
+  char name[1];  /* Variable length, as passed to uv_resolve(). */
+};
+
+struct uv__resolver_ctx {
+  uv_loop_t* loop;
+  uv_resolver_t* resolver;  /* NULL once the resolver has been closed. */
+  struct uv__resolver_server* servers[UV__RESOLVER_MAXNS];
+  unsigned int nservers;
+  unsigned int timeout;  /* In milliseconds. */
+  unsigned int attempts;
+  unsigned int ndots;
+  unsigned int nsearch;
+  char search[UV__RESOLVER_MAXSEARCH][UV__DNS_NAME_MAX + 1];
+  struct uv__resolver_host* hosts;
+  uv_timer_t timer;
+  uint64_t timer_deadline;
+  unsigned int nhandles;  /* Internal handles that haven't been closed. */
+  unsigned int nqueries;
+  unsigned int nactive;
+  int closing;
+  unsigned int nrandom;
+  unsigned char random[256];  /* Query IDs, taken from the end. */
+  void* retired[2];
+  void* waiting[2];
+  void* inflight[2];
+  /* Queries answered from /etc/hosts, run from the pending queue. */
+  void* done_queue[2];
+  unsigned int ndone;
+  uv__io_t done_watcher;
+  void* buckets[UV__RESOLVER_BUCKETS][2];
+  unsigned char recvbuf[UV__DNS_UDP_SIZE * UV__DNS_RECV_SLOTS];
+};
+
+static void uv__resolver_send(struct uv__resolver_query* q);
+static struct uv__resolver_socket* uv__resolver_socket_get(
+    struct uv__resolver_server* server);
+static void uv__resolver_dequeue(struct uv__resolver_ctx* ctx);
+static int uv__resolver_process(struct uv__resolver_query* q,
+                                const unsigned char* msg,
+                                size_t len,
+                                unsigned int server,
+                                int truncated);
+
+
+static int uv__dns_tolower(int c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A' + 'a';
+  return c;
+}
+
+
+static int uv__dns_name_eq(const char* a, const char* b) {
+  while (*a != '\0' && uv__dns_tolower(*a) == uv__dns_tolower(*b))
+    a++, b++;
+  return *a == *b;
+}
+
+
+/* Labels of 1 to 63 bytes, at most 253 bytes in all. A trailing dot makes
+ * the name absolute.
+ */
+static int uv__dns_name_valid(const char* name) {
+  size_t label;
+  size_t len;
+
+  len = strlen(name);
+  if (len > 0 && name[len - 1] == '.')
+    len--;
+
+  if (len == 0 || len > UV__DNS_NAME_MAX)
+    return 0;
+
+  for (label = 0; len > 0; name++, len--) {
+    if (*name != '.')
+      label++;
+    else if (label == 0)
+      return 0;
+    else
+      label = 0;
+
+    if (label > 63)
+      return 0;
+  }
+
+  return label > 0;
+}
+
+
+/* Read the possibly compressed name at `off` into `name`. Returns the offset
+ * right after the name, or -1 when the message is malformed.
+ */
+static int uv__dns_read_name(const unsigned char* msg,
+                             size_t len,
+                             size_t off,
+                             char* name) {
+  unsigned int jumps;
+  size_t end;
+  size_t n;
+  size_t c;
+
+  jumps = 0;
+  end = 0;
+  n = 0;
+
+  for (;;) {
+    if (off >= len)
+      return -1;
+
+    c = msg[off];
+    if (c == 0)
+      break;
+
+    if ((c & 0xC0) == 0xC0) {
+      if (off + 1 >= len || ++jumps > 32)
+        return -1;
+      if (end == 0)
+        end = off + 2;
+      off = ((c & 0x3F) << 8) | msg[off + 1];
+      continue;
+    }
+
+    if ((c & 0xC0) != 0 || off + 1 + c > len)
+      return -1;
+
+    if (n + (n > 0) + c > UV__DNS_NAME_MAX)
+      return -1;
+
+    if (n > 0)
+      name[n++] = '.';
+    memcpy(name + n, msg + off + 1, c);
+    n += c;
+    off += 1 + c;
+  }
+
+  name[n] = '\0';
+  return end != 0 ? end : off + 1;
+}
+
+
+static unsigned int uv__dns_get16(const unsigned char* p) {
+  return (p[0] << 8) | p[1];
+}
+
+
+static int uv__resolver_random_bytes(void* buf, size_t len) {
+  ssize_t n;
+  int fd;
+
+#if defined(__linux__)
+  /* Don't wait for the entropy pool at boot, /dev/urandom doesn't either. */
+  n = uv__getrandom(buf, len, UV__GRND_NONBLOCK);
+  if (n == (ssize_t) len)
+    return 0;
+#endif
+
+  fd = uv__open_cloexec("/dev/urandom", O_RDONLY);
+  if (fd < 0)
+    return fd;
+
+  do
+    n = read(fd, buf, len);
+  while (n == -1 && errno == EINTR);
+
+  uv__close(fd);
+
+  return n == (ssize_t) len ? 0 : -EIO;
+}
+
+
+/* Query IDs are all that keeps an attacker who can't see the traffic from
+ * answering in the server's place, they come from the kernel's CSPRNG.
+ */
+static int uv__resolver_random_id(struct uv__resolver_ctx* ctx,
+                                  unsigned short* id) {
+  unsigned char* p;
+  int err;
+
+  if (ctx->nrandom < 2) {
+    err = uv__resolver_random_bytes(ctx->random, sizeof(ctx->random));
+    if (err)
+      return err;
+    ctx->nrandom = sizeof(ctx->random);
+  }
+
+  ctx->nrandom -= 2;
+  p = ctx->random + ctx->nrandom;
+  *id = (p[0] << 8) | p[1];
+
+  return 0;
+}
+
+
+static int uv__resolver_add_record(struct uv__resolver_query* q,
+                                   const uv_dns_record_t* record) {
+  uv_dns_record_t* records;
+  unsigned int n;
+
+  n = q->nrecords;
+
+  /* Grow when n is 0 or a power of two. */
+  if ((n & (n - 1)) == 0) {
+    records = uv__realloc(q->records, (n != 0 ? 2 * n : 4) * sizeof(*records));
+    if (records == NULL)
+      return -ENOMEM;
+    q->records = records;
+  }
+
+  q->records[n] = *record;
+  q->nrecords = n + 1;
+
+  return 0;
+}
+
+
+static void uv__resolver_read_resolv_conf(struct uv__resolver_ctx* ctx,
+                                          struct sockaddr_storage* addrs,
+                                          unsigned int* naddrs) {
+  char line[1024];
+  char* save;
+  char* tok;
+  char* p;
+  unsigned int n;
+  int have_search;
+  FILE* fp;
+
+  have_search = 0;
+
+  fp = fopen(UV__RESOLV_CONF, "r");
+  if (fp != NULL) {
+    while (fgets(line, sizeof(line), fp) != NULL) {
+      tok = strtok_r(line, " \t\r\n", &save);
+      if (tok == NULL || tok[0] == '#' || tok[0] == ';')
+        continue;
+
+      if (strcmp(tok, "nameserver") == 0) {
+        tok = strtok_r(NULL, " \t\r\n", &save);
+        if (tok == NULL || *naddrs == UV__RESOLVER_MAXNS)
+          continue;
+        if (uv_ip4_addr(tok,
+                        UV__DNS_PORT,
+                        (struct sockaddr_in*) (addrs + *naddrs)) == 0 ||
+            uv_ip6_addr(tok,
+                        UV__DNS_PORT,
+                        (struct sockaddr_in6*) (addrs + *naddrs)) == 0) {
+          (*naddrs)++;
+        }
+      } else if (strcmp(tok, "domain") == 0 || strcmp(tok, "search") == 0) {
+        /* The last one wins. */
+        have_search = 1;
+        ctx->nsearch = 0;
+        n = strcmp(tok, "domain") == 0 ? 1 : UV__RESOLVER_MAXSEARCH;
+        while (ctx->nsearch < n) {
+          tok = strtok_r(NULL, " \t\r\n", &save);
+          if (tok == NULL || tok[0] == '#' || tok[0] == ';')
+            break;
+          if (!uv__dns_name_valid(tok))
+            continue;
+          strcpy(ctx->search[ctx->nsearch], tok);
+          p = ctx->search[ctx->nsearch] + strlen(tok) - 1;
+          if (*p == '.')
+            *p = '\0';
+          ctx->nsearch++;
+        }
+      } else if (strcmp(tok, "options") == 0) {
+        while ((tok = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+          if (strncmp(tok, "ndots:", 6) == 0) {
+            n = atoi(tok + 6);
+            ctx->ndots = n < UV__RESOLVER_MAXNDOTS ? n : UV__RESOLVER_MAXNDOTS;
+          } else if (strncmp(tok, "timeout:", 8) == 0) {
+            n = atoi(tok + 8);
+            if (n > UV__RESOLVER_MAXTIMEOUT)
+              n = UV__RESOLVER_MAXTIMEOUT;
+            if (n > 0)
+              ctx->timeout = n * 1000;
+          } else if (strncmp(tok, "attempts:", 9) == 0) {
+            n = atoi(tok + 9);
+            if (n > UV__RESOLVER_MAXATTEMPTS)
+              n = UV__RESOLVER_MAXATTEMPTS;
+            if (n > 0)
+              ctx->attempts = n;
+          }
+        }
+      }
+    }
+
+    fclose(fp);
+  }
+
+  /* Like the libc resolvers, fall back to the domain of the host name. */
+  if (!have_search && gethostname(line, sizeof(line)) == 0) {
+    line[sizeof(line) - 1] = '\0';
+    p = strchr(line, '.');
+    if (p != NULL && uv__dns_name_valid(p + 1)) {
+      strcpy(ctx->search[0], p + 1);
+      ctx->nsearch = 1;
+    }
+  }
+
+  if (*naddrs == 0) {
+    uv_ip4_addr("127.0.0.1", UV__DNS_PORT, (struct sockaddr_in*) addrs);
+    *naddrs = 1;
+  }
+}
+
+
+static int uv__resolver_read_hosts(struct uv__resolver_ctx* ctx) {
+  struct uv__resolver_host** tail;
+  struct uv__resolver_host* host;
+  struct in6_addr in6;
+  struct in_addr in;
+  uv_dns_type type;
+  char line[1024];
+  char* save;
+  char* tok;
+  char* p;
+  size_t len;
+  FILE* fp;
+
+  fp = fopen(UV__HOSTS, "r");
+  if (fp == NULL)
+    return 0;
+
+  tail = &ctx->hosts;
+
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    p = strchr(line, '#');
+    if (p != NULL)
+      *p = '\0';
+
+    tok = strtok_r(line, " \t\r\n", &save);
+    if (tok == NULL)
+      continue;
+
+    /* Scoped addresses like fe80::1%eth0 are of no use in a DNS answer. */
+    p = strchr(tok, '%');
+    if (p != NULL)
+      *p = '\0';
+
+    if (uv_inet_pton(AF_INET, tok, &in) == 0)
+      type = UV_DNS_A;
+    else if (uv_inet_pton(AF_INET6, tok, &in6) == 0)
+      type = UV_DNS_AAAA;
+    else
+      continue;
+
+    while ((tok = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+      len = strlen(tok);
+      if (len > 0 && tok[len - 1] == '.')
+        tok[--len] = '\0';
+
+      host = uv__malloc(sizeof(*host) + len);
+      if (host == NULL) {
+        fclose(fp);
+        return -ENOMEM;
+      }
+
+      host->next = NULL;
+      host->type = type;
+      if (type == UV_DNS_A)
+        host->addr.in = in;
+      else
+        host->addr.in6 = in6;
+      memcpy(host->name, tok, len + 1);
+
+      *tail = host;
+      tail = &host->next;
+    }
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+
+/* Returns the number of addresses for the name in /etc/hosts. */
+static int uv__resolver_hosts_lookup(struct uv__resolver_query* q) {
+  struct uv__resolver_host* host;
+  uv_dns_record_t record;
+  char name[UV__DNS_NAME_MAX + 1];
+  size_t len;
+  int err;
+
+  len = strlen(q->name);
+  memcpy(name, q->name, len + 1);
+  if (name[len - 1] == '.')
+    name[len - 1] = '\0';
+
+  for (host = q->ctx->hosts; host != NULL; host = host->next) {
+    if (host->type != q->type || !uv__dns_name_eq(host->name, name))
+      continue;
+
+    memset(&record, 0, sizeof(record));
+    record.type = host->type;
+    if (host->type == UV_DNS_A) {
+      record.u.in.sin_family = AF_INET;
+      record.u.in.sin_addr = host->addr.in;
+    } else {
+      record.u.in6.sin6_family = AF_INET6;
+      record.u.in6.sin6_addr = host->addr.in6;
+    }
+
+    err = uv__resolver_add_record(q, &record);
+    if (err)
+      return err;
+  }
+
+  return q->nrecords;
+}
+
+
+static void uv__resolver_free(struct uv__resolver_ctx* ctx) {
+  struct uv__resolver_host* host;
+
+  while (ctx->hosts != NULL) {
+    host = ctx->hosts;
+    ctx->hosts = host->next;
+    uv__free(host);
+  }
+
+  uv__free(ctx);
+}
+
+
+static void uv__resolver_handle_closed(struct uv__resolver_ctx* ctx) {
+  assert(ctx->nhandles > 0);
+  ctx->nhandles--;
+
+  if (ctx->nhandles == 0 && ctx->resolver == NULL)
+    uv__resolver_free(ctx);
+}
+
+
+static void uv__resolver_timer_close_cb(uv_handle_t* handle) {
+  uv__resolver_handle_closed(container_of(handle,
+                                          struct uv__resolver_ctx,
+                                          timer));
+}
+
+
+static void uv__resolver_tcp_close_cb(uv_handle_t* handle) {
+  struct uv__resolver_tcp* tcp;
+
+  tcp = container_of(handle, struct uv__resolver_tcp, handle);
+  uv__free(tcp->buf);
+  uv__free(tcp);
+}
+
+
+static void uv__resolver_tcp_detach(struct uv__resolver_query* q) {
+  struct uv__resolver_tcp* tcp;
+
+  tcp = q->tcp;
+  if (tcp == NULL)
+    return;
+
+  q->tcp = NULL;
+  tcp->query = NULL;
+  uv_close((uv_handle_t*) &tcp->handle, uv__resolver_tcp_close_cb);
+}
+
+
+static void uv__resolver_socket_close_cb(uv_handle_t* handle) {
+  struct uv__resolver_socket* socket;
+  struct uv__resolver_ctx* ctx;
+
+  socket = container_of(handle, struct uv__resolver_socket, handle);
+  ctx = socket->ctx;
+  uv__free(socket);
+  uv__resolver_handle_closed(ctx);
+}
+
+
+static void uv__resolver_socket_close(struct uv__resolver_socket* socket) {
+  if (socket->retired)
+    QUEUE_REMOVE(&socket->retired_queue);
+
+  uv_close((uv_handle_t*) &socket->handle, uv__resolver_socket_close_cb);
+}
+
+
+static void uv__resolver_socket_detach(struct uv__resolver_query* q) {
+  struct uv__resolver_socket* socket;
+
+  socket = q->socket;
+  if (socket == NULL)
+    return;
+
+  q->socket = NULL;
+  socket->nqueries--;
+
+  if (socket->nqueries == 0 && socket->retired)
+    uv__resolver_socket_close(socket);
+}
+
+
+static void uv__resolver_finish(struct uv__resolver_query* q, int status) {
+  struct uv__resolver_ctx* ctx;
+  uv_resolve_t* req;
+
+  ctx = q->ctx;
+  req = q->req;
+
+  QUEUE_REMOVE(&q->queue);
+  QUEUE_REMOVE(&q->id_queue);
+  uv__resolver_tcp_detach(q);
+  uv__resolver_socket_detach(q);
+
+  uv__req_unregister(ctx->loop, req);
+  req->query = NULL;
+
+  if (--ctx->nqueries == 0)
+    uv__handle_stop(ctx->resolver);
+
+  if (q->active) {
+    ctx->nactive--;
+    uv__resolver_dequeue(ctx);
+  }
+
+  if (status != 0)
+    q->nrecords = 0;
+
+  req->cb(req, status, q->records, q->nrecords);
+
+  uv__free(q->records);
+  uv__free(q);
+}
+
+
+static void uv__resolver_done(uv_loop_t* loop,
+                              uv__io_t* w,
+                              unsigned int events) {
+  struct uv__resolver_ctx* ctx;
+  struct uv__resolver_query* q;
+  unsigned int n;
+  QUEUE* p;
+
+  ctx = container_of(w, struct uv__resolver_ctx, done_watcher);
+
+  /* Queries that callbacks add run on the next loop iteration. */
+  for (n = ctx->ndone; n > 0 && ctx->ndone > 0; n--) {
+    p = QUEUE_HEAD(&ctx->done_queue);
+    QUEUE_REMOVE(p);
+    QUEUE_INIT(p);
+    ctx->ndone--;
+
+    q = QUEUE_DATA(p, struct uv__resolver_query, queue);
+    uv__resolver_finish(q, q->status);
+  }
+}
+
+
+/* For queries that are done before they were sent. uv_resolve() doesn't call
+ * the callback itself.
+ */
+static void uv__resolver_defer(struct uv__resolver_query* q, int status) {
+  struct uv__resolver_ctx* ctx;
+
+  ctx = q->ctx;
+  q->status = status;
+
+  QUEUE_REMOVE(&q->queue);
+  QUEUE_INSERT_TAIL(&ctx->done_queue, &q->queue);
+  ctx->ndone++;
+  uv__io_feed(ctx->loop, &ctx->done_watcher);
+}
+
+
+/* Write the `i`th name to try into q->qname. Names with at least `ndots`
+ * dots are tried as they are before the search list is, shorter names after
+ * it. Returns 1 when the name doesn't fit, -1 when there are no more names.
+ */
+static int uv__resolver_candidate(struct uv__resolver_query* q,
+                                  unsigned int i) {
+  struct uv__resolver_ctx* ctx;
+  unsigned int ndots;
+  const char* p;
+  size_t len;
+
+  ctx = q->ctx;
+  len = strlen(q->name);
+
+  if (q->name[len - 1] == '.') {
+    if (i > 0)
+      return -1;
+    memcpy(q->qname, q->name, len - 1);
+    q->qname[len - 1] = '\0';
+    return 0;
+  }
+
+  for (ndots = 0, p = q->name; *p != '\0'; p++)
+    ndots += (*p == '.');
+
+  if (ndots >= ctx->ndots) {
+    if (i == 0) {
+      memcpy(q->qname, q->name, len + 1);
+      return 0;
+    }
+    i--;
+  } else if (i == ctx->nsearch) {
+    memcpy(q->qname, q->name, len + 1);
+    return 0;
+  }
+
+  if (i >= ctx->nsearch)
+    return -1;
+
+  if (len + 1 + strlen(ctx->search[i]) > UV__DNS_NAME_MAX)
+    return 1;
+
+  memcpy(q->qname, q->name, len);
+  q->qname[len] = '.';
+  strcpy(q->qname + len + 1, ctx->search[i]);
+
+  return 0;
+}
+
+
+static void uv__resolver_encode(struct uv__resolver_query* q) {
+  unsigned char* label;
+  unsigned char* p;
+  const char* s;
+
+  p = q->packet + 2;
+  p[0] = q->id >> 8;
+  p[1] = q->id & 0xFF;
+  p[2] = UV__DNS_FLAG_RD >> 8;
+  p[3] = 0;
+  p[4] = 0;
+  p[5] = 1;  /* QDCOUNT */
+  memset(p + 6, 0, 6);
+  p += UV__DNS_HEADER_SIZE;
+
+  /* Labels are prefixed with their length. */
+  label = p++;
+  for (s = q->qname; *s != '\0'; s++) {
+    if (*s == '.') {
+      *label = p - label - 1;
+      label = p++;
+    } else {
+      *p++ = *s;
+    }
+  }
+  *label = p - label - 1;
+  *p++ = 0;
+
+  *p++ = q->type >> 8;
+  *p++ = q->type & 0xFF;
+  *p++ = 0;
+  *p++ = UV__DNS_CLASS_IN;
+
+  q->len = p - q->packet - 2;
+  q->packet[0] = q->len >> 8;
+  q->packet[1] = q->len & 0xFF;
+}
+
+
+/* Send the next name from the search list. Returns 0, UV_EAI_NONAME when
+ * there are no names left to try, or UV_EAI_FAIL when there's no randomness
+ * for the query ID.
+ */
+static int uv__resolver_start(struct uv__resolver_query* q) {
+  struct uv__resolver_ctx* ctx;
+  int r;
+
+  ctx = q->ctx;
+
+  do
+    r = uv__resolver_candidate(q, q->candidate++);
+  while (r == 1);
+
+  if (r == -1)
+    return UV_EAI_NONAME;
+
+  QUEUE_REMOVE(&q->id_queue);
+  QUEUE_INIT(&q->id_queue);
+
+  if (uv__resolver_random_id(ctx, &q->id)) {
+    q->status = UV_EAI_FAIL;
+    return UV_EAI_FAIL;
+  }
+
+  QUEUE_INSERT_TAIL(&ctx->buckets[q->id % UV__RESOLVER_BUCKETS], &q->id_queue);
+
+  uv__resolver_tcp_detach(q);
+  q->use_tcp = 0;
+  q->tries = 0;
+  q->maxtries = ctx->nservers * ctx->attempts;
+
+  uv__resolver_encode(q);
+  uv__resolver_send(q);
+
+  return 0;
+}
+
+
+/* The name didn't resolve, try the next one from the search list. NODATA
+ * means the name exists and wins over NONAME.
+ */
+static void uv__resolver_next(struct uv__resolver_query* q, int status) {
+  if (q->status != UV_EAI_NODATA)
+    q->status = status;
+
+  if (uv__resolver_start(q))
+    uv__resolver_finish(q, q->status);
+}
+
+
+/* Start waiting queries while there are slots. */
+static void uv__resolver_dequeue(struct uv__resolver_ctx* ctx) {
+  struct uv__resolver_query* q;
+  QUEUE* p;
+  int err;
+
+  while (!ctx->closing &&
+         !QUEUE_EMPTY(&ctx->waiting) &&
+         ctx->nactive < UV__RESOLVER_MAX_ACTIVE) {
+    p = QUEUE_HEAD(&ctx->waiting);
+    QUEUE_REMOVE(p);
+    QUEUE_INIT(p);
+
+    q = QUEUE_DATA(p, struct uv__resolver_query, queue);
+    q->active = 1;
+    ctx->nactive++;
+
+    err = uv__resolver_start(q);
+    if (err)
+      uv__resolver_defer(q, err);
+  }
+}
+
+
+/* The server didn't answer in time or answered with an error. */
+static void uv__resolver_retry(struct uv__resolver_query* q) {
+  if (q->tries < q->maxtries)
+    uv__resolver_send(q);
+  else
+    uv__resolver_finish(q, q->failed ? UV_EAI_FAIL : UV_EAI_AGAIN);
+}
+
+
+static void uv__resolver_timer_cb(uv_timer_t* timer) {
+  struct uv__resolver_ctx* ctx;
+  struct uv__resolver_query* q;
+  uint64_t now;
+
+  ctx = container_of(timer, struct uv__resolver_ctx, timer);
+  now = uv_now(ctx->loop);
+
+  while (!ctx->closing && !QUEUE_EMPTY(&ctx->inflight)) {
+    q = QUEUE_DATA(QUEUE_HEAD(&ctx->inflight),
+                   struct uv__resolver_query,
+                   queue);
+    if (q->deadline > now)
+      break;
+    uv__resolver_retry(q);
+  }
+
+  if (ctx->closing || QUEUE_EMPTY(&ctx->inflight))
+    return;
+
+  q = QUEUE_DATA(QUEUE_HEAD(&ctx->inflight), struct uv__resolver_query, queue);
+  ctx->timer_deadline = q->deadline;
+  uv_timer_start(&ctx->timer, uv__resolver_timer_cb, q->deadline - now, 0);
+}
+
+
+/* Queries are kept in deadline order. They're nearly always appended: all
+ * queries wait equally long unless uv_resolver_set_timeout() was called.
+ */
+static void uv__resolver_schedule(struct uv__resolver_query* q) {
+  struct uv__resolver_query* prev;
+  struct uv__resolver_ctx* ctx;
+  uint64_t now;
+  QUEUE* p;
+
+  ctx = q->ctx;
+  now = uv_now(ctx->loop);
+  q->deadline = now + ctx->timeout;
+
+  QUEUE_REMOVE(&q->queue);
+  for (p = QUEUE_PREV(&ctx->inflight); p != &ctx->inflight; p = QUEUE_PREV(p)) {
+    prev = QUEUE_DATA(p, struct uv__resolver_query, queue);
+    if (prev->deadline <= q->deadline)
+      break;
+  }
+  QUEUE_INSERT_HEAD(p, &q->queue);
+
+  /* The timer fires early when queries finish before their deadline and
+   * re-arms itself for the next one.
+   */
+  if (uv__is_active(&ctx->timer) && ctx->timer_deadline <= q->deadline)
+    return;
+
+  ctx->timer_deadline = q->deadline;
+  uv_timer_start(&ctx->timer, uv__resolver_timer_cb, ctx->timeout, 0);
+}
+
+
+static void uv__resolver_tcp_read_cb(uv_stream_t* stream,
+                                     ssize_t nread,
+                                     const uv_buf_t* buf) {
+  struct uv__resolver_query* q;
+  struct uv__resolver_tcp* tcp;
+  size_t len;
+
+  tcp = container_of(stream, struct uv__resolver_tcp, handle);
+  q = tcp->query;
+  if (q == NULL || nread == 0)
+    return;
+
+  if (nread < 0) {
+    uv__resolver_retry(q);
+    return;
+  }
+
+  tcp->len += nread;
+  if (tcp->len < 2)
+    return;
+
+  len = uv__dns_get16(tcp->buf);
+  if (tcp->len < 2 + len)
+    return;
+
+  if (uv__resolver_process(q, tcp->buf + 2, len, q->server, 0))
+    uv__resolver_retry(q);
+}
+
+
+static void uv__resolver_tcp_alloc_cb(uv_handle_t* handle,
+                                      size_t suggested_size,
+                                      uv_buf_t* buf) {
+  struct uv__resolver_tcp* tcp;
+  size_t size;
+
+  tcp = container_of(handle, struct uv__resolver_tcp, handle);
+  size = 2 + 65535;
+
+  if (tcp->buf == NULL)
+    tcp->buf = uv__malloc(size);
+
+  if (tcp->buf == NULL)
+    *buf = uv_buf_init(NULL, 0);
+  else
+    *buf = uv_buf_init((char*) tcp->buf + tcp->len, size - tcp->len);
+}
+
+
+static void uv__resolver_tcp_connect_cb(uv_connect_t* req, int status) {
+  struct uv__resolver_query* q;
+  struct uv__resolver_tcp* tcp;
+  uv_buf_t buf;
+
+  tcp = container_of(req, struct uv__resolver_tcp, connect_req);
+  q = tcp->query;
+  if (q == NULL)
+    return;
+
+  if (status == 0) {
+    buf = uv_buf_init((char*) tcp->packet, 2 + q->len);
+    status = uv_write(&tcp->write_req,
+                      (uv_stream_t*) &tcp->handle,
+                      &buf,
+                      1,
+                      NULL);
+  }
+
+  if (status == 0)
+    status = uv_read_start((uv_stream_t*) &tcp->handle,
+                           uv__resolver_tcp_alloc_cb,
+                           uv__resolver_tcp_read_cb);
+
+  if (status != 0)
+    uv__resolver_retry(q);
+}
+
+
+static int uv__resolver_tcp_connect(struct uv__resolver_query* q) {
+  struct uv__resolver_server* server;
+  struct uv__resolver_tcp* tcp;
+  int err;
+
+  server = q->ctx->servers[q->server];
+
+  tcp = uv__malloc(sizeof(*tcp));
+  if (tcp == NULL)
+    return -ENOMEM;
+
+  err = uv_tcp_init(q->ctx->loop, &tcp->handle);
+  if (err) {
+    uv__free(tcp);
+    return err;
+  }
+
+  tcp->handle.flags |= UV__HANDLE_INTERNAL;
+  uv__handle_unref(&tcp->handle);
+  tcp->query = q;
+  tcp->buf = NULL;
+  tcp->len = 0;
+  memcpy(tcp->packet, q->packet, 2 + q->len);
+  q->tcp = tcp;
+
+  err = uv_tcp_connect(&tcp->connect_req,
+                       &tcp->handle,
+                       (const struct sockaddr*) &server->addr,
+                       uv__resolver_tcp_connect_cb);
+  if (err)
+    uv__resolver_tcp_detach(q);
+
+  return err;
+}
+
+
+/* Send to the servers in turn. Errors count as a lost datagram, the query is
+ * retried when it times out.
+ */
+static void uv__resolver_send(struct uv__resolver_query* q) {
+  struct uv__resolver_socket* socket;
+  struct uv__resolver_ctx* ctx;
+  uv_buf_t buf;
+
+  ctx = q->ctx;
+  q->server = q->tries % ctx->nservers;
+  q->tries++;
+
+  uv__resolver_socket_detach(q);
+
+  if (q->use_tcp) {
+    uv__resolver_tcp_detach(q);
+    uv__resolver_tcp_connect(q);
+  } else {
+    socket = uv__resolver_socket_get(ctx->servers[q->server]);
+    socket->nqueries++;
+    socket->nsends++;
+    q->socket = socket;
+
+    buf = uv_buf_init((char*) q->packet + 2, q->len);
+    uv_udp_try_send(&socket->handle, &buf, 1, NULL);
+  }
+
+  uv__resolver_schedule(q);
+}
+
+
+/* Returns -1 when the message isn't an answer to the query. `truncated` is
+ * set for datagrams that didn't fit in the receive buffer.
+ */
+static int uv__resolver_process(struct uv__resolver_query* q,
+                                const unsigned char* msg,
+                                size_t len,
+                                unsigned int server,
+                                int truncated) {
+  char name[UV__DNS_NAME_MAX + 1];
+  char cname[UV__DNS_NAME_MAX + 1];
+  uv_dns_record_t record;
+  unsigned int ancount;
+  unsigned int flags;
+  unsigned int rdlen;
+  unsigned int type;
+  size_t rdata;
+  int off;
+  int err;
+
+  if (len < UV__DNS_HEADER_SIZE || uv__dns_get16(msg) != q->id)
+    return -1;
+
+  flags = uv__dns_get16(msg + 2);
+  if (!(flags & UV__DNS_FLAG_QR) || uv__dns_get16(msg + 4) != 1)
+    return -1;
+
+  off = uv__dns_read_name(msg, len, UV__DNS_HEADER_SIZE, name);
+  if (off < 0 || (size_t) off + 4 > len)
+    return -1;
+
+  if (!uv__dns_name_eq(name, q->qname) ||
+      uv__dns_get16(msg + off) != q->type ||
+      uv__dns_get16(msg + off + 2) != UV__DNS_CLASS_IN) {
+    return -1;
+  }
+  off += 4;
+
+  if ((flags & UV__DNS_FLAG_TC) || truncated) {
+    if (q->use_tcp)
+      return -1;
+    /* Ask the same server again, over TCP. */
+    q->use_tcp = 1;
+    q->tries = server;
+    uv__resolver_send(q);
+    return 0;
+  }
+
+  switch (flags & 0xF) {
+  case UV__DNS_RCODE_NOERROR:
+    break;
+
+  case UV__DNS_RCODE_NXDOMAIN:
+    uv__resolver_next(q, UV_EAI_NONAME);
+    return 0;
+
+  default:
+    /* SERVFAIL, REFUSED and the like. Late answers from servers that were
+     * asked before don't change what the query waits for.
+     */
+    q->failed = 1;
+    if (server == q->server)
+      uv__resolver_retry(q);
+    return 0;
+  }
+
+  /* Follow CNAMEs from the name that was asked for to the records. */
+  strcpy(cname, q->qname);
+  q->nrecords = 0;
+
+  for (ancount = uv__dns_get16(msg + 6); ancount > 0; ancount--) {
+    off = uv__dns_read_name(msg, len, off, name);
+    if (off < 0 || (size_t) off + 10 > len)
+      goto malformed;
+
+    type = uv__dns_get16(msg + off);
+    rdlen = uv__dns_get16(msg + off + 8);
+    rdata = off + 10;
+    if (rdata + rdlen > len)
+      goto malformed;
+
+    off = rdata + rdlen;
+
+    if (uv__dns_get16(msg + rdata - 8) != UV__DNS_CLASS_IN ||
+        !uv__dns_name_eq(name, cname)) {
+      continue;
+    }
+
+    if (type == UV__DNS_TYPE_CNAME) {
+      if (uv__dns_read_name(msg, len, rdata, cname) < 0)
+        goto malformed;
+      continue;
+    }
+
+    if (type != q->type)
+      continue;
+
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.ttl = (uv__dns_get16(msg + rdata - 6) << 16) |
+                 uv__dns_get16(msg + rdata - 4);
+
+    if (type == UV_DNS_A) {
+      if (rdlen != 4)
+        goto malformed;
+      record.u.in.sin_family = AF_INET;
+      memcpy(&record.u.in.sin_addr, msg + rdata, 4);
+    } else if (type == UV_DNS_AAAA) {
+      if (rdlen != 16)
+        goto malformed;
+      record.u.in6.sin6_family = AF_INET6;
+      memcpy(&record.u.in6.sin6_addr, msg + rdata, 16);
+    } else {
+      if (rdlen < 7)
+        goto malformed;
+      record.u.srv.priority = uv__dns_get16(msg + rdata);
+      record.u.srv.weight = uv__dns_get16(msg + rdata + 2);
+      record.u.srv.port = uv__dns_get16(msg + rdata + 4);
+      if (uv__dns_read_name(msg, len, rdata + 6, record.u.srv.target) < 0) {
+        goto malformed;
+      }
+    }
+
+    err = uv__resolver_add_record(q, &record);
+    if (err) {
+      uv__resolver_finish(q, UV_EAI_MEMORY);
+      return 0;
+    }
+  }
+
+  if (q->nrecords > 0)
+    uv__resolver_finish(q, 0);
+  else
+    uv__resolver_next(q, UV_EAI_NODATA);
+
+  return 0;
+
+malformed:
+  q->nrecords = 0;
+  return -1;
+}
+
+
+static void uv__resolver_alloc_cb(uv_handle_t* handle,
+                                  size_t suggested_size,
+                                  uv_buf_t* buf) {
+  struct uv__resolver_socket* socket;
+
+  socket = container_of(handle, struct uv__resolver_socket, handle);
+  *buf = uv_buf_init((char*) socket->ctx->recvbuf,
+                     sizeof(socket->ctx->recvbuf));
+}
+
+
+static void uv__resolver_recv_cb(uv_udp_t* handle,
+                                 ssize_t nread,
+                                 const uv_buf_t* buf,
+                                 const struct sockaddr* addr,
+                                 unsigned int flags) {
+  struct uv__resolver_socket* socket;
+  struct uv__resolver_query* q;
+  struct uv__resolver_ctx* ctx;
+  const unsigned char* msg;
+  unsigned int index;
+  unsigned int id;
+  QUEUE* bucket;
+  QUEUE* p;
+
+  /* Errors like ECONNREFUSED are left to the retransmit timer. The rest of a
+   * batch that was read before a retired socket was closed is dropped.
+   */
+  if (nread < UV__DNS_HEADER_SIZE || addr == NULL || uv__is_closing(handle))
+    return;
+
+  socket = container_of(handle, struct uv__resolver_socket, handle);
+  ctx = socket->ctx;
+  msg = (const unsigned char*) buf->base;
+
+  for (index = 0; index < ctx->nservers; index++)
+    if (ctx->servers[index] == socket->server)
+      break;
+
+  /* Several queries can share an ID, the question tells them apart. */
+  id = uv__dns_get16(msg);
+  bucket = &ctx->buckets[id % UV__RESOLVER_BUCKETS];
+
+  QUEUE_FOREACH(p, bucket) {
+    q = QUEUE_DATA(p, struct uv__resolver_query, id_queue);
+    if (q->id != id || q->use_tcp)
+      continue;
+
+    if (uv__resolver_process(q,
+                             msg,
+                             nread,
+                             index,
+                             flags & UV_UDP_PARTIAL) == 0) {
+      return;
+    }
+  }
+}
+
+
+static void uv__resolver_close_server(struct uv__resolver_server* server) {
+  uv__resolver_socket_close(server->socket);
+  uv__free(server);
+}
+
+
+static void uv__resolver_close_handles(struct uv__resolver_ctx* ctx) {
+  unsigned int i;
+
+  for (i = 0; i < ctx->nservers; i++)
+    uv__resolver_close_server(ctx->servers[i]);
+
+  while (!QUEUE_EMPTY(&ctx->retired))
+    uv__resolver_socket_close(QUEUE_DATA(QUEUE_HEAD(&ctx->retired),
+                                         struct uv__resolver_socket,
+                                         retired_queue));
+
+  ctx->nservers = 0;
+  uv_close((uv_handle_t*) &ctx->timer, uv__resolver_timer_close_cb);
+}
+
+
+static int uv__resolver_socket_open(struct uv__resolver_ctx* ctx,
+                                    struct uv__resolver_server* server,
+                                    struct uv__resolver_socket** result) {
+  struct uv__resolver_socket* socket;
+  int size;
+  int err;
+
+  socket = uv__malloc(sizeof(*socket));
+  if (socket == NULL)
+    return -ENOMEM;
+
+  err = uv_udp_init(ctx->loop, &socket->handle);
+  if (err) {
+    uv__free(socket);
+    return err;
+  }
+
+  socket->handle.flags |= UV__HANDLE_INTERNAL;
+  uv__handle_unref(&socket->handle);
+  socket->ctx = ctx;
+  socket->server = server;
+  socket->nqueries = 0;
+  socket->nsends = 0;
+  socket->retired = 0;
+  ctx->nhandles++;
+
+  /* A connected socket only hears from the server. The kernel picks a random
+   * source port for it, together with the random query IDs that makes it
+   * hard for anybody else to spoof an answer.
+   */
+  err = uv_udp_connect(&socket->handle,
+                       (const struct sockaddr*) &server->addr);
+
+  /* Make room for an answer to every active query. The kernel caps the size
+   * at net.core.rmem_max.
+   */
+  if (err == 0) {
+    size = UV__RESOLVER_MAX_ACTIVE * 2048;
+    uv_recv_buffer_size((uv_handle_t*) &socket->handle, &size);
+    uv_udp_set_recvmmsg(&socket->handle, UV__DNS_UDP_SIZE);
+    err = uv_udp_recv_start(&socket->handle,
+                            uv__resolver_alloc_cb,
+                            uv__resolver_recv_cb);
+  }
+
+  if (err) {
+    uv_close((uv_handle_t*) &socket->handle, uv__resolver_socket_close_cb);
+    return err;
+  }
+
+  *result = socket;
+  return 0;
+}
+
+
+/* Returns the socket for the next query to the server, a new one every
+ * UV__RESOLVER_ROTATE queries.
+ */
+static struct uv__resolver_socket* uv__resolver_socket_get(
+    struct uv__resolver_server* server) {
+  struct uv__resolver_socket* socket;
+  struct uv__resolver_ctx* ctx;
+
+  socket = server->socket;
+  if (socket->nsends < UV__RESOLVER_ROTATE)
+    return socket;
+
+  /* Stay with the old one for another round if there's no new one. */
+  ctx = socket->ctx;
+  if (uv__resolver_socket_open(ctx, server, &server->socket)) {
+    socket->nsends = 0;
+    return socket;
+  }
+
+  socket->retired = 1;
+  QUEUE_INSERT_TAIL(&ctx->retired, &socket->retired_queue);
+
+  if (socket->nqueries == 0)
+    uv__resolver_socket_close(socket);
+
+  return server->socket;
+}
+
+
+static int uv__resolver_open_server(struct uv__resolver_ctx* ctx,
+                                    const struct sockaddr* addr,
+                                    struct uv__resolver_server** result) {
+  struct uv__resolver_server* server;
+  int err;
+
+  server = uv__malloc(sizeof(*server));
+  if (server == NULL)
+    return -ENOMEM;
+
+  if (addr->sa_family == AF_INET) {
+    memcpy(&server->addr, addr, sizeof(struct sockaddr_in));
+    if (((struct sockaddr_in*) &server->addr)->sin_port == 0)
+      ((struct sockaddr_in*) &server->addr)->sin_port = htons(UV__DNS_PORT);
+  } else {
+    memcpy(&server->addr, addr, sizeof(struct sockaddr_in6));
+    if (((struct sockaddr_in6*) &server->addr)->sin6_port == 0)
+      ((struct sockaddr_in6*) &server->addr)->sin6_port = htons(UV__DNS_PORT);
+  }
+
+  err = uv__resolver_socket_open(ctx, server, &server->socket);
+  if (err) {
+    uv__free(server);
+    return err;
+  }
+
+  *result = server;
+  return 0;
+}
+
+
+static int uv__resolver_open_servers(struct uv__resolver_ctx* ctx,
+                                     const struct sockaddr* addrs[],
+                                     unsigned int naddrs,
+                                     struct uv__resolver_server** servers) {
+  unsigned int i;
+  int err;
+
+  for (i = 0; i < naddrs; i++) {
+    err = uv__resolver_open_server(ctx, addrs[i], servers + i);
+    if (err) {
+      while (i > 0)
+        uv__resolver_close_server(servers[--i]);
+      return err;
+    }
+  }
+
+  return 0;
+}
+
+
+int uv_resolver_init(uv_loop_t* loop, uv_resolver_t* resolver) {
+  const struct sockaddr* addrs[UV__RESOLVER_MAXNS];
+  struct sockaddr_storage storage[UV__RESOLVER_MAXNS];
+  struct uv__resolver_ctx* ctx;
+  unsigned int naddrs;
+  unsigned int i;
+  int err;
+
+  ctx = uv__calloc(1, sizeof(*ctx));
+  if (ctx == NULL)
+    return -ENOMEM;
+
+  ctx->loop = loop;
+  ctx->timeout = 5000;
+  ctx->attempts = 2;
+  ctx->ndots = 1;
+  QUEUE_INIT(&ctx->waiting);
+  QUEUE_INIT(&ctx->inflight);
+  QUEUE_INIT(&ctx->done_queue);
+  QUEUE_INIT(&ctx->retired);
+  uv__io_init(&ctx->done_watcher, uv__resolver_done, -1);
+  for (i = 0; i < UV__RESOLVER_BUCKETS; i++)
+    QUEUE_INIT(&ctx->buckets[i]);
+
+  naddrs = 0;
+  uv__resolver_read_resolv_conf(ctx, storage, &naddrs);
+
+  err = uv__resolver_read_hosts(ctx);
+  if (err) {
+    uv__resolver_free(ctx);
+    return err;
+  }
+
+  uv_timer_init(loop, &ctx->timer);
+  ctx->timer.flags |= UV__HANDLE_INTERNAL;
+  uv__handle_unref(&ctx->timer);
+  ctx->nhandles++;
+
+  for (i = 0; i < naddrs; i++)
+    addrs[i] = (const struct sockaddr*) (storage + i);
+
+  err = uv__resolver_open_servers(ctx, addrs, naddrs, ctx->servers);
+  if (err) {
+    /* The context goes when the timer has been closed. */
+    uv_close((uv_handle_t*) &ctx->timer, uv__resolver_timer_close_cb);
+    return err;
+  }
+  ctx->nservers = naddrs;
+
+  uv__handle_init(loop, (uv_handle_t*) resolver, UV_RESOLVER);
+  resolver->resolver_ctx = ctx;
+  ctx->resolver = resolver;
+
+  return 0;
+}
+
+
+int uv_resolver_set_servers(uv_resolver_t* resolver,
+                            const struct sockaddr* addrs[],
+                            unsigned int naddrs) {
+  struct uv__resolver_server* servers[UV__RESOLVER_MAXNS];
+  struct uv__resolver_ctx* ctx;
+  unsigned int i;
+  int err;
+
+  if (uv__is_closing(resolver) || naddrs == 0 || naddrs > UV__RESOLVER_MAXNS)
+    return -EINVAL;
+
+  for (i = 0; i < naddrs; i++)
+    if (addrs[i]->sa_family != AF_INET && addrs[i]->sa_family != AF_INET6)
+      return -EINVAL;
+
+  ctx = resolver->resolver_ctx;
+
+  /* Queries in flight remember servers by index. With none in flight, no
+   * socket has been retired and is still open either.
+   */
+  if (ctx->nactive != 0)
+    return -EBUSY;
+
+  assert(QUEUE_EMPTY(&ctx->retired));
+
+  err = uv__resolver_open_servers(ctx, addrs, naddrs, servers);
+  if (err)
+    return err;
+
+  for (i = 0; i < ctx->nservers; i++)
+    uv__resolver_close_server(ctx->servers[i]);
+
+  memcpy(ctx->servers, servers, naddrs * sizeof(servers[0]));
+  ctx->nservers = naddrs;
+
+  return 0;
+}
+
+
+int uv_resolver_set_timeout(uv_resolver_t* resolver,
+                            unsigned int timeout,
+                            unsigned int attempts) {
+  struct uv__resolver_ctx* ctx;
+
+  if (uv__is_closing(resolver) || timeout == 0 || attempts == 0)
+    return -EINVAL;
+
+  ctx = resolver->resolver_ctx;
+  ctx->timeout = timeout;
+  ctx->attempts = attempts;
+
+  return 0;
+}
+
+
+int uv_resolve(uv_resolver_t* resolver,
+               uv_resolve_t* req,
+               const char* name,
+               uv_dns_type type,
+               uv_resolve_cb cb) {
+  struct uv__resolver_query* q;
+  struct uv__resolver_ctx* ctx;
+  size_t len;
+  int err;
+
+  if (uv__is_closing(resolver) || cb == NULL || name == NULL)
+    return -EINVAL;
+
+  if (type != UV_DNS_A && type != UV_DNS_AAAA && type != UV_DNS_SRV)
+    return -EINVAL;
+
+  if (!uv__dns_name_valid(name))
+    return -EINVAL;
+
+  ctx = resolver->resolver_ctx;
+  len = strlen(name);
+
+  q = uv__malloc(sizeof(*q) + len);
+  if (q == NULL)
+    return -ENOMEM;
+
+  QUEUE_INIT(&q->queue);
+  QUEUE_INIT(&q->id_queue);
+  q->req = req;
+  q->ctx = ctx;
+  q->tcp = NULL;
+  q->socket = NULL;
+  q->records = NULL;
+  q->nrecords = 0;
+  q->candidate = 0;
+  q->active = 0;
+  q->failed = 0;
+  q->status = 0;
+  q->type = type;
+  memcpy(q->name, name, len + 1);
+
+  uv__req_init(ctx->loop, req, UV_RESOLVE);
+  req->resolver = resolver;
+  req->cb = cb;
+  req->query = q;
+
+  if (ctx->nqueries++ == 0)
+    uv__handle_start(resolver);
+
+  if (type != UV_DNS_SRV) {
+    err = uv__resolver_hosts_lookup(q);
+    if (err != 0) {
+      uv__resolver_defer(q, err > 0 ? 0 : UV_EAI_MEMORY);
+      return 0;
+    }
+  }
+
+  QUEUE_INSERT_TAIL(&ctx->waiting, &q->queue);
+  uv__resolver_dequeue(ctx);
+
+  return 0;
+}
+
+
+void uv__resolver_close(uv_resolver_t* resolver) {
+  struct uv__resolver_query* q;
+  struct uv__resolver_ctx* ctx;
+  QUEUE* p;
+
+  ctx = resolver->resolver_ctx;
+  ctx->closing = 1;
+
+  QUEUE_FOREACH(p, &ctx->inflight) {
+    q = QUEUE_DATA(p, struct uv__resolver_query, queue);
+    uv__resolver_tcp_detach(q);
+    uv__resolver_socket_detach(q);
+  }
+
+  uv__resolver_close_handles(ctx);
+  uv__handle_stop(resolver);
+}
+
+
+/* Called when the resolver is closed for good. Queries that are still in
+ * flight are cancelled before the close callback runs.
+ */
+void uv__resolver_destroy(uv_resolver_t* resolver) {
+  struct uv__resolver_ctx* ctx;
+  struct uv__resolver_query* q;
+
+  ctx = resolver->resolver_ctx;
+
+  while (ctx->ndone > 0)
+    uv__resolver_done(ctx->loop, &ctx->done_watcher, UV__POLLOUT);
+
+  /* The watcher has no file descriptor, it can only be pending. */
+  QUEUE_REMOVE(&ctx->done_watcher.pending_queue);
+  QUEUE_INIT(&ctx->done_watcher.pending_queue);
+
+  while (!QUEUE_EMPTY(&ctx->inflight)) {
+    q = QUEUE_DATA(QUEUE_HEAD(&ctx->inflight),
+                   struct uv__resolver_query,
+                   queue);
+    uv__resolver_finish(q, UV_ECANCELED);
+  }
+
+  while (!QUEUE_EMPTY(&ctx->waiting)) {
+    q = QUEUE_DATA(QUEUE_HEAD(&ctx->waiting),
+                   struct uv__resolver_query,
+                   queue);
+    uv__resolver_finish(q, UV_ECANCELED);
+  }
+
+  assert(ctx->nqueries == 0);
+  resolver->resolver_ctx = NULL;
+  ctx->resolver = NULL;
+
+  if (ctx->nhandles == 0)
+    uv__resolver_free(ctx);
+}
@@ -48,6 +48,18 @@ static struct uv__signal_tree_s uv__signal_tree =
     RB_INITIALIZER(uv__signal_tree);
 static int uv__signal_lock_pipefd[2];
 
+#if defined(__linux__)
+static void uv__signalfd_event(uv_loop_t* loop,
+                               uv__io_t* w,
+                               unsigned int events);
+
+/* Number of started watchers per signal, across all loops. Only changed
+ * with the signal lock held.
+ */
+static unsigned int uv__signal_watchers[NSIG];
+static int uv__signalfd_works = -1;
+#endif
+
 
 RB_GENERATE_STATIC(uv__signal_tree_s,
                    uv_signal_s, tree_entry,
@@ -133,24 +145,23 @@ static uv_signal_t* uv__signal_first_handle(int signum) {
 }
 
 
-static void uv__signal_handler(int signum) {
+/* Writes a message into the signal pipe of every loop with a watcher for
+ * {signum}, except {skip}. Called with the signal lock held.
+ */
+static void uv__signal_deliver(int signum, uv_loop_t* skip) {
   uv__signal_msg_t msg;
   uv_signal_t* handle;
-  int saved_errno;
 
-  saved_errno = errno;
   memset(&msg, 0, sizeof msg);
 
-  if (uv__signal_lock()) {
-    errno = saved_errno;
-    return;
-  }
-
   for (handle = uv__signal_first_handle(signum);
        handle != NULL && handle->signum == signum;
        handle = RB_NEXT(uv__signal_tree_s, &uv__signal_tree, handle)) {
     int r;
 
+    if (handle->loop == skip)
+      continue;
+
     msg.signum = signum;
     msg.handle = handle;
 
@@ -168,6 +179,20 @@ static void uv__signal_handler(int signum) {
     if (r != -1)
       handle->caught_signals++;
   }
+}
+
+
+static void uv__signal_handler(int signum) {
+  int saved_errno;
+
+  saved_errno = errno;
+
+  if (uv__signal_lock()) {
+    errno = saved_errno;
+    return;
+  }
+
+  uv__signal_deliver(signum, NULL);
 
   uv__signal_unlock();
   errno = saved_errno;
@@ -224,10 +249,213 @@ static int uv__signal_loop_once_init(uv_loop_t* loop) {
               loop->signal_pipefd[0]);
   uv__io_start(loop, &loop->signal_io_watcher, UV__POLLIN);
 
+#if defined(__linux__)
+  uv__io_init(&loop->signalfd_watcher, uv__signalfd_event, -1);
+  QUEUE_INIT(&loop->signalfd_handles);
+  loop->signalfd_mask = 0;
+  loop->signalfd_blocked = 0;
+  memset(loop->signalfd_watchers, 0, sizeof(loop->signalfd_watchers));
+#endif
+
   return 0;
 }
 
 
+#if defined(__linux__)
+/* On Linux, a loop also reads the signals it watches from a signalfd and
+ * blocks them in the loop thread. A signal that is pending for the loop
+ * thread or for the process (when no other thread has it unblocked) then
+ * stays queued in the kernel until the loop reads it, instead of going
+ * through uv__signal_handler() and a pipe that may be full. Threads that do
+ * have the signal unblocked still get the handler, so both paths stay
+ * active.
+ */
+static void uv__signal_mask_to_set(uint64_t mask, sigset_t* set) {
+  int signum;
+
+  sigemptyset(set);
+
+  for (signum = 1; signum <= 64; signum++)
+    if (mask & ((uint64_t) 1 << (signum - 1)))
+      sigaddset(set, signum);
+}
+
+
+void uv__signal_blocked_set(const uv_loop_t* loop, sigset_t* set) {
+  uv__signal_mask_to_set(loop->signalfd_blocked, set);
+}
+
+
+static int uv__signalfd_update(uv_loop_t* loop, uint64_t mask) {
+  uv__io_t* w;
+  sigset_t set;
+  int fd;
+
+  if (uv__signalfd_works == 0)
+    return -ENOSYS;
+
+  w = &loop->signalfd_watcher;
+  uv__signal_mask_to_set(mask, &set);
+
+  fd = uv__signalfd4(w->fd, &set, UV__SFD_NONBLOCK | UV__SFD_CLOEXEC);
+  if (fd == -1) {
+    if (errno == ENOSYS || errno == EINVAL)
+      uv__signalfd_works = 0;
+    return -errno;
+  }
+
+  uv__signalfd_works = 1;
+
+  if (w->fd == -1) {
+    w->fd = fd;
+    uv__io_start(loop, w, UV__POLLIN);
+  }
+
+  loop->signalfd_mask = mask;
+
+  return 0;
+}
+
+
+static void uv__signalfd_start(uv_signal_t* handle) {
+  uv_loop_t* loop;
+  sigset_t saved;
+  sigset_t set;
+  uint64_t bit;
+
+  loop = handle->loop;
+  QUEUE_INSERT_TAIL(&loop->signalfd_handles, &handle->signalfd_queue);
+
+  if (handle->signum > 64)
+    return;
+
+  loop->signalfd_watchers[handle->signum - 1]++;
+
+  bit = (uint64_t) 1 << (handle->signum - 1);
+  if (loop->signalfd_mask & bit)
+    return;
+
+  if (uv__signalfd_update(loop, loop->signalfd_mask | bit))
+    return;
+
+  /* Leave the signal alone if the application blocked it already. */
+  sigemptyset(&set);
+  sigaddset(&set, handle->signum);
+
+  if (pthread_sigmask(SIG_BLOCK, &set, &saved))
+    abort();
+
+  if (!sigismember(&saved, handle->signum))
+    loop->signalfd_blocked |= bit;
+}
+
+
+static void uv__signalfd_stop(uv_signal_t* handle) {
+  uv_loop_t* loop;
+  sigset_t set;
+  uint64_t bit;
+
+  loop = handle->loop;
+  QUEUE_REMOVE(&handle->signalfd_queue);
+
+  if (handle->signum > 64)
+    return;
+
+  /* Count rather than look for other watchers on signalfd_handles, while
+   * uv__signalfd_dispatch() runs some of them are on a detached queue.
+   */
+  assert(loop->signalfd_watchers[handle->signum - 1] > 0);
+  if (--loop->signalfd_watchers[handle->signum - 1] > 0)
+    return;
+
+  bit = (uint64_t) 1 << (handle->signum - 1);
+  if (!(loop->signalfd_mask & bit))
+    return;
+
+  /* Unblock first; a signal that's still pending is then delivered to
+   * uv__signal_handler() while it's installed.
+   */
+  if (loop->signalfd_blocked & bit) {
+    sigemptyset(&set);
+    sigaddset(&set, handle->signum);
+
+    if (pthread_sigmask(SIG_UNBLOCK, &set, NULL))
+      abort();
+
+    loop->signalfd_blocked &= ~bit;
+  }
+
+  uv__signalfd_update(loop, loop->signalfd_mask & ~bit);
+}
+
+
+static void uv__signalfd_dispatch(uv_loop_t* loop, int signum) {
+  sigset_t saved_sigmask;
+  uv_signal_t* handle;
+  unsigned int n;
+  QUEUE queue;
+  QUEUE* q;
+
+  n = 0;
+
+  /* Callbacks may stop and start watchers; walk a detached copy of the
+   * list and put every watcher back before running its callback.
+   */
+  if (!QUEUE_EMPTY(&loop->signalfd_handles)) {
+    q = QUEUE_HEAD(&loop->signalfd_handles);
+    QUEUE_SPLIT(&loop->signalfd_handles, q, &queue);
+
+    while (!QUEUE_EMPTY(&queue)) {
+      q = QUEUE_HEAD(&queue);
+      QUEUE_REMOVE(q);
+      QUEUE_INSERT_TAIL(&loop->signalfd_handles, q);
+
+      handle = QUEUE_DATA(q, uv_signal_t, signalfd_queue);
+      if (handle->signum != signum)
+        continue;
+
+      n++;
+      handle->signal_cb(handle, signum);
+    }
+  }
+
+  /* A process-directed signal is read by only one signalfd. If watchers on
+   * other loops want it too, pass it on through their signal pipes.
+   */
+  if (uv__signal_watchers[signum] > n) {
+    uv__signal_block_and_lock(&saved_sigmask);
+    uv__signal_deliver(signum, loop);
+    uv__signal_unlock_and_unblock(&saved_sigmask);
+  }
+}
+
+
+static void uv__signalfd_event(uv_loop_t* loop,
+                               uv__io_t* w,
+                               unsigned int events) {
+  struct uv__signalfd_siginfo buf[32];
+  ssize_t r;
+  size_t i;
+
+  do {
+    r = read(w->fd, buf, sizeof(buf));
+
+    if (r == -1 && errno == EINTR)
+      continue;
+
+    if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+
+    if (r == -1)
+      abort();
+
+    for (i = 0; i < r / sizeof(buf[0]); i++)
+      uv__signalfd_dispatch(loop, buf[i].ssi_signo);
+  } while (r == sizeof(buf));
+}
+#endif
+
+
 void uv__signal_loop_cleanup(uv_loop_t* loop) {
   QUEUE* q;
 
@@ -242,6 +470,14 @@ void uv__signal_loop_cleanup(uv_loop_t* loop) {
       uv__signal_stop((uv_signal_t*) handle);
   }
 
+#if defined(__linux__)
+  if (loop->signal_pipefd[0] != -1 && loop->signalfd_watcher.fd != -1) {
+    uv__io_close(loop, &loop->signalfd_watcher);
+    uv__close(loop->signalfd_watcher.fd);
+    loop->signalfd_watcher.fd = -1;
+  }
+#endif
+
   if (loop->signal_pipefd[0] != -1) {
     uv__close(loop->signal_pipefd[0]);
     loop->signal_pipefd[0] = -1;
@@ -328,9 +564,16 @@ int uv_signal_start(uv_signal_t* handle, uv_signal_cb signal_cb, int signum) {
 
   handle->signum = signum;
   RB_INSERT(uv__signal_tree_s, &uv__signal_tree, handle);
+#if defined(__linux__)
+  uv__signal_watchers[signum]++;
+#endif
 
   uv__signal_unlock_and_unblock(&saved_sigmask);
 
+#if defined(__linux__)
+  uv__signalfd_start(handle);
+#endif
+
   handle->signal_cb = signal_cb;
   uv__handle_start(handle);
 
@@ -446,11 +689,18 @@ static void uv__signal_stop(uv_signal_t* handle) {
   if (handle->signum == 0)
     return;
 
+#if defined(__linux__)
+  uv__signalfd_stop(handle);
+#endif
+
   uv__signal_block_and_lock(&saved_sigmask);
 
   removed_handle = RB_REMOVE(uv__signal_tree_s, &uv__signal_tree, handle);
   assert(removed_handle == handle);
   (void) removed_handle;
+#if defined(__linux__)
+  uv__signal_watchers[handle->signum]--;
+#endif
 
   /* Check if there are other active signal watchers observing this signal. If
    * not, unregister the signal handler.
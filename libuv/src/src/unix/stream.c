@@ -35,6 +35,25 @@
 #include <unistd.h>
 #include <limits.h> /* IOV_MAX */
 
+#if defined(__linux__)
+# include <fcntl.h>  /* splice() */
+#endif
+
+#if defined(__linux__) || defined(__sun)
+# include <sys/sendfile.h>
+#endif
+
+#if defined(__linux__)
+# include <netinet/in.h>
+# include <linux/errqueue.h>
+# ifndef MSG_ZEROCOPY
+#  define MSG_ZEROCOPY 0x4000000
+# endif
+# ifndef SO_EE_ORIGIN_ZEROCOPY
+#  define SO_EE_ORIGIN_ZEROCOPY 5
+# endif
+#endif
+
 #if defined(__APPLE__)
 # include <sys/event.h>
 # include <sys/time.h>
@@ -62,6 +81,9 @@ static void uv__read(uv_stream_t* stream);
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 static void uv__write_callbacks(uv_stream_t* stream);
 static size_t uv__write_req_size(uv_write_t* req);
+static void uv__splice_close(uv_stream_t* stream);
+static void uv__splice_destroy(uv_stream_t* stream);
+static int uv__stream_queue_fd(uv_stream_t* stream, int fd);
 
 
 void uv__stream_init(uv_loop_t* loop,
@@ -74,14 +96,21 @@ void uv__stream_init(uv_loop_t* loop,
   stream->alloc_cb = NULL;
   stream->close_cb = NULL;
   stream->connection_cb = NULL;
+  stream->connection_batch_cb = NULL;
   stream->connect_req = NULL;
   stream->shutdown_req = NULL;
   stream->accepted_fd = -1;
   stream->queued_fds = NULL;
+  stream->splice_read = NULL;
+  stream->splice_write = NULL;
   stream->delayed_error = 0;
   QUEUE_INIT(&stream->write_queue);
   QUEUE_INIT(&stream->write_completed_queue);
+  QUEUE_INIT(&stream->zerocopy_queue);
   stream->write_queue_size = 0;
+  stream->zerocopy_threshold = 0;
+  stream->zerocopy_seq = 0;
+  stream->zerocopy_acked = 0;
 
   if (loop->emfile_fd == -1) {
     err = uv__open_cloexec("/", O_RDONLY);
@@ -242,7 +271,7 @@ static void uv__stream_osx_cb_close(uv_handle_t* async) {
   uv__stream_select_t* s;
 
   s = container_of(async, uv__stream_select_t, async);
-  free(s);
+  uv__free(s);
 }
 
 
@@ -284,7 +313,7 @@ int uv__stream_try_select(uv_stream_t* stream, int* fd) {
     return 0;
 
   /* At this point we definitely know that this fd won't work with kqueue */
-  s = malloc(sizeof(*s));
+  s = uv__malloc(sizeof(*s));
   if (s == NULL)
     return -ENOMEM;
 
@@ -293,7 +322,7 @@ int uv__stream_try_select(uv_stream_t* stream, int* fd) {
 
   err = uv_async_init(stream->loop, &s->async, uv__stream_osx_select_cb);
   if (err) {
-    free(s);
+    uv__free(s);
     return err;
   }
 
@@ -353,6 +382,12 @@ int uv__stream_open(uv_stream_t* stream, int fd, int flags) {
     /* TODO Use delay the user passed in. */
     if ((stream->flags & UV_TCP_KEEPALIVE) && uv__tcp_keepalive(fd, 1, 60))
       return -errno;
+
+    /* Not fatal, writes are copied like they normally are. */
+    if ((stream->flags & UV_TCP_ZEROCOPY) && uv__tcp_zerocopy(fd, 1)) {
+      stream->flags &= ~UV_TCP_ZEROCOPY;
+      stream->zerocopy_threshold = 0;
+    }
   }
 
   stream->io_watcher.fd = fd;
@@ -374,6 +409,21 @@ void uv__stream_destroy(uv_stream_t* stream) {
     stream->connect_req = NULL;
   }
 
+  /* Zero-copy writes whose completion didn't arrive before uv__stream_close()
+   * are cancelled. The kernel may still transmit from their buffers, the
+   * uv_tcp_zerocopy() documentation tells users to leave them alone.
+   */
+  while (!QUEUE_EMPTY(&stream->zerocopy_queue)) {
+    q = QUEUE_HEAD(&stream->zerocopy_queue);
+    QUEUE_REMOVE(q);
+
+    req = QUEUE_DATA(q, uv_write_t, queue);
+    if (req->error == 0)
+      req->error = -ECANCELED;
+
+    QUEUE_INSERT_TAIL(&stream->write_completed_queue, q);
+  }
+
   while (!QUEUE_EMPTY(&stream->write_queue)) {
     q = QUEUE_HEAD(&stream->write_queue);
     QUEUE_REMOVE(q);
@@ -398,6 +448,8 @@ void uv__stream_destroy(uv_stream_t* stream) {
   }
 
   assert(stream->write_queue_size == 0);
+
+  uv__splice_destroy(stream);
 }
 
 
@@ -443,6 +495,89 @@ static int uv__emfile_trick(uv_loop_t* loop, int accept_fd) {
 #endif /* defined(UV_HAVE_KQUEUE) */
 
 
+/* Drains up to UV__ACCEPT_BATCH connections from the backlog and reports
+ * them with a single callback. The first one goes into accepted_fd, the
+ * rest is queued up for uv_accept() in queued_fds. Errors are only reported
+ * when there is nothing else to report, the next wakeup runs into them
+ * again otherwise.
+ */
+static void uv__server_io_batch(uv_loop_t* loop, uv_stream_t* stream) {
+  uv__io_t* w;
+  unsigned int count;
+  int err;
+  int fd;
+
+  w = &stream->io_watcher;
+  count = 0;
+  err = 0;
+
+  while (count < UV__ACCEPT_BATCH) {
+#if defined(UV_HAVE_KQUEUE)
+    if (w->rcount <= 0)
+      break;
+#endif /* defined(UV_HAVE_KQUEUE) */
+
+    fd = uv__accept(uv__stream_fd(stream));
+    if (fd < 0) {
+      if (fd == -EAGAIN || fd == -EWOULDBLOCK) {
+        uv__io_drained(w, UV__POLLIN);
+        break;
+      }
+
+      if (fd == -ECONNABORTED)
+        continue;
+
+      if (count > 0)
+        break;
+
+      if (fd == -EMFILE || fd == -ENFILE) {
+        fd = uv__emfile_trick(loop, uv__stream_fd(stream));
+        if (fd == -EAGAIN || fd == -EWOULDBLOCK)
+          break;
+      }
+
+      err = fd;
+      break;
+    }
+
+    UV_DEC_BACKLOG(w)
+
+    if (count == 0) {
+      stream->accepted_fd = fd;
+    } else if (uv__stream_queue_fd(stream, fd)) {
+      uv__close(fd);  /* Out of memory, drop the connection. */
+      break;
+    }
+
+    count++;
+  }
+
+  if (count == 0 && err == 0)
+    return;
+
+  stream->connection_batch_cb(stream, count, err);
+
+  /* The server may have been closed by the callback. */
+  if (uv__stream_fd(stream) == -1)
+    return;
+
+  /* Stop accepting until the user has taken all connections. uv_accept()
+   * restarts the watcher when it hands out the last one.
+   */
+  if (stream->accepted_fd != -1) {
+    uv__io_stop(loop, &stream->io_watcher, UV__POLLIN);
+    return;
+  }
+
+  if (stream->type == UV_TCP &&
+      (stream->flags & UV_TCP_SINGLE_ACCEPT) &&
+      !uv__io_exclusive(w)) {
+    struct timespec timeout = { 0, 1 };
+    nanosleep(&timeout, NULL);
+  }
+}
+
+
 void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   uv_stream_t* stream;
   int err;
@@ -454,6 +589,11 @@ void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   uv__io_start(stream->loop, &stream->io_watcher, UV__POLLIN);
 
+  if (stream->connection_batch_cb != NULL) {
+    uv__server_io_batch(loop, stream);
+    return;
+  }
+
   /* connection_cb can close the server socket while we're
    * in the loop so check it on each iteration.
    */
@@ -467,8 +607,10 @@ void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
     err = uv__accept(uv__stream_fd(stream));
     if (err < 0) {
-      if (err == -EAGAIN || err == -EWOULDBLOCK)
+      if (err == -EAGAIN || err == -EWOULDBLOCK) {
+        uv__io_drained(w, UV__POLLIN);
         return;  /* Not an error. */
+      }
 
       if (err == -ECONNABORTED)
         continue;  /* Ignore. Nothing we can do about that. */
@@ -493,8 +635,12 @@ void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
       return;
     }
 
-    if (stream->type == UV_TCP && (stream->flags & UV_TCP_SINGLE_ACCEPT)) {
-      /* Give other processes a chance to accept connections. */
+    if (stream->type == UV_TCP &&
+        (stream->flags & UV_TCP_SINGLE_ACCEPT) &&
+        !uv__io_exclusive(w)) {
+      /* Give other processes a chance to accept connections. Not needed
+       * when the kernel wakes up only one of them, see uv_tcp_listen().
+       */
       struct timespec timeout = { 0, 1 };
       nanosleep(&timeout, NULL);
     }
@@ -553,7 +699,7 @@ done:
     /* All read, free */
     assert(queued_fds->offset > 0);
     if (--queued_fds->offset == 0) {
-      free(queued_fds);
+      uv__free(queued_fds);
       server->queued_fds = NULL;
     } else {
       /* Shift rest */
@@ -573,6 +719,8 @@ done:
 int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb) {
   int err;
 
+  stream->connection_batch_cb = NULL;
+
   switch (stream->type) {
   case UV_TCP:
     err = uv_tcp_listen((uv_tcp_t*)stream, backlog, cb);
@@ -593,6 +741,22 @@ int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb) {
 }
 
 
+int uv_listen_batch(uv_stream_t* stream,
+                    int backlog,
+                    uv_connection_batch_cb cb) {
+  int err;
+
+  if (cb == NULL)
+    return -EINVAL;
+
+  err = uv_listen(stream, backlog, NULL);
+  if (err == 0)
+    stream->connection_batch_cb = cb;
+
+  return err;
+}
+
+
 static void uv__drain(uv_stream_t* stream) {
   uv_shutdown_t* req;
   int err;
@@ -637,6 +801,17 @@ static size_t uv__write_req_size(uv_write_t* req) {
 }
 
 
+/* True if the kernel may still be reading from the buffers of a request
+ * that was sent with MSG_ZEROCOPY.
+ */
+static int uv__write_zerocopy_pending(uv_stream_t* stream, uv_write_t* req) {
+  if (req->zerocopy == 0)
+    return 0;
+
+  return (int) (stream->zerocopy_acked - req->zerocopy) < 0;
+}
+
+
 static void uv__write_req_finish(uv_write_t* req) {
   uv_stream_t* stream = req->handle;
 
@@ -651,8 +826,17 @@ static void uv__write_req_finish(uv_write_t* req) {
    */
   if (req->error == 0) {
     if (req->bufs != req->bufsml)
-      free(req->bufs);
+      uv__free(req->bufs);
     req->bufs = NULL;
+
+    /* Hold on to it until the kernel is done with the buffers. Requests that
+     * finish later wait their turn so that callbacks still run in order.
+     */
+    if (!QUEUE_EMPTY(&stream->zerocopy_queue) ||
+        uv__write_zerocopy_pending(stream, req)) {
+      QUEUE_INSERT_TAIL(&stream->zerocopy_queue, &req->queue);
+      return;
+    }
   }
 
   /* Add it to the write_completed_queue where it will have its
@@ -690,16 +874,306 @@ static int uv__getiovmax() {
 #endif
 }
 
+/* Upper bound for the number of iovecs that uv__write() gathers from
+ * consecutive write requests. Matches IOV_MAX on linux.
+ */
+#define UV__WRITE_MAXIOV 1024
+
+/* Copies the unwritten buffers of `req` and the requests queued behind it
+ * to `iov`, up to `iovmax` of them. Stops at a request that passes a handle
+ * or sends a file, those need a system call of their own.
+ */
+static int uv__write_gather(uv_stream_t* stream,
+                            uv_write_t* req,
+                            struct iovec* iov,
+                            int iovmax) {
+  unsigned int nbufs;
+  int iovcnt;
+  QUEUE* q;
+
+  iovcnt = 0;
+
+  for (q = &req->queue; q != &stream->write_queue; q = QUEUE_NEXT(q)) {
+    req = QUEUE_DATA(q, uv_write_t, queue);
+
+    if (req->send_handle != NULL || req->file != -1)
+      break;
+
+    nbufs = req->nbufs - req->write_index;
+    if (nbufs > (unsigned int) (iovmax - iovcnt))
+      nbufs = iovmax - iovcnt;
+
+    memcpy(iov + iovcnt, req->bufs + req->write_index, nbufs * sizeof(*iov));
+    iovcnt += nbufs;
+
+    if (iovcnt == iovmax)
+      break;
+  }
+
+  return iovcnt;
+}
+
+
+/* Number of sendfile() calls that uv__write_file() makes before it lets
+ * other handles run.
+ */
+#define UV__WRITE_FILE_ROUNDS 16
+
+/* Fallback for when sendfile() can't be used with this pair of fds. Sends
+ * one buffer's worth at most, it's positional so nothing is lost if the
+ * write() comes up short.
+ */
+static ssize_t uv__write_file_emul(int fd, uv_write_t* req) {
+  char buf[8192];
+  ssize_t nread;
+  ssize_t n;
+  size_t len;
+
+  len = req->bufs[0].len;
+  if (len > sizeof(buf))
+    len = sizeof(buf);
+
+  do
+    nread = pread(req->file, buf, len, req->file_offset);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread <= 0)
+    return nread;
+
+  do
+    n = write(fd, buf, nread);
+  while (n == -1 && errno == EINTR);
+
+  return n;
+}
+
+
+static ssize_t uv__write_file_once(int fd, uv_write_t* req) {
+#if defined(__linux__) || defined(__sun)
+  off_t off;
+  ssize_t r;
+
+  off = req->file_offset;
+
+  do
+    r = sendfile(fd, req->file, &off, req->bufs[0].len);
+  while (r == -1 && errno == EINTR);
+
+  /* See uv__fs_sendfile() for why SunOS needs the offset check. */
+  if (r != -1 || off > req->file_offset)
+    return off - req->file_offset;
+
+  if (errno != EINVAL &&
+      errno != EIO &&
+      errno != ENOTSOCK &&
+      errno != EXDEV) {
+    return -1;
+  }
+#elif defined(__FreeBSD__) || defined(__APPLE__)
+  off_t len;
+  int r;
+
+  /* Both return EAGAIN when a non-blocking socket fills up but still report
+   * the number of bytes that went out in `len`.
+   */
+#if defined(__FreeBSD__)
+  len = 0;
+  r = sendfile(req->file,
+               fd,
+               req->file_offset,
+               req->bufs[0].len,
+               NULL,
+               &len,
+               0);
+#else
+  len = req->bufs[0].len;
+  r = sendfile(req->file, fd, req->file_offset, &len, NULL, 0);
+#endif
+
+  if (r != -1 || len != 0)
+    return (ssize_t) len;
+
+  if (errno != EINVAL &&
+      errno != EIO &&
+      errno != ENOTSOCK &&
+      errno != EXDEV) {
+    return -1;
+  }
+#endif
+
+  return uv__write_file_emul(fd, req);
+}
+
+
+/* Sends the file range of a uv_write_file() request. Returns 0 when all of it
+ * is written, 1 when there is more to write and the stream may still be
+ * writable, or a negative error code; UV_EAGAIN means the socket is full.
+ */
+static int uv__write_file(uv_stream_t* stream, uv_write_t* req) {
+  uv_buf_t* buf;
+  ssize_t n;
+  int rounds;
+
+  buf = req->bufs;
+
+  for (rounds = 0; buf->len > 0; rounds++) {
+    if (rounds == UV__WRITE_FILE_ROUNDS &&
+        !(stream->flags & UV_STREAM_BLOCKING)) {
+      return 1;
+    }
+
+    n = uv__write_file_once(uv__stream_fd(stream), req);
+
+    if (n == -1) {
+      if (errno == EWOULDBLOCK)
+        return -EAGAIN;
+      return -errno;
+    }
+
+    /* The file is shorter than the range the user asked for. */
+    if (n == 0)
+      return UV_EOF;
+
+    req->file_offset += n;
+    buf->len -= n;
+    stream->write_queue_size -= n;
+  }
+
+  req->write_index = req->nbufs;
+
+  return 0;
+}
+
+
+#if defined(__linux__)
+/* Sends with MSG_ZEROCOPY. Sets `zerocopy` when the kernel took the buffers
+ * by reference; each such send gets the next number in a sequence that is
+ * shared with the kernel, see uv__stream_zerocopy_reap().
+ */
+static ssize_t uv__write_zerocopy(uv_stream_t* stream,
+                                  struct iovec* iov,
+                                  int iovcnt,
+                                  int* zerocopy) {
+  struct msghdr msg;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iovcnt;
+
+  do
+    n = sendmsg(uv__stream_fd(stream), &msg, MSG_ZEROCOPY);
+  while (n == -1 && errno == EINTR);
+
+  /* ENOBUFS means the socket hit its limit for pinned pages. Copy instead. */
+  if (n == -1 && errno == ENOBUFS) {
+    do
+      n = writev(uv__stream_fd(stream), iov, iovcnt);
+    while (n == -1 && errno == EINTR);
+    *zerocopy = 0;
+    return n;
+  }
+
+  *zerocopy = (n > 0);
+  if (n > 0) {
+    if (stream->zerocopy_seq == stream->zerocopy_acked)
+      uv__io_start(stream->loop, &stream->io_watcher, UV__POLLERR);
+    stream->zerocopy_seq++;
+  }
+
+  return n;
+}
+
+
+/* Collects the completion notifications of zero-copy sends from the socket's
+ * error queue. Each covers a range of sends, identified by the sequence
+ * number that the kernel assigned to them. Requests whose buffers are no
+ * longer in use get their callbacks.
+ */
+static void uv__stream_zerocopy_reap(uv_stream_t* stream) {
+  struct sock_extended_err* serr;
+  struct cmsghdr* cmsg;
+  struct msghdr msg;
+  uv_write_t* req;
+  QUEUE* q;
+  ssize_t r;
+  union {
+    char data[CMSG_SPACE(sizeof(*serr) + sizeof(struct sockaddr_in6))];
+    size_t align;
+  } control;
+
+  for (;;) {
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control.data;
+    msg.msg_controllen = sizeof(control.data);
+
+    do
+      r = recvmsg(uv__stream_fd(stream), &msg, MSG_ERRQUEUE);
+    while (r == -1 && errno == EINTR);
+
+    if (r == -1)
+      break;  /* EAGAIN, the error queue is empty. */
+
+    for (cmsg = CMSG_FIRSTHDR(&msg);
+         cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == IPPROTO_IP &&
+            cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == IPPROTO_IPV6 &&
+            cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+
+      /* silence aliasing warning */
+      {
+        void* pv = CMSG_DATA(cmsg);
+        serr = pv;
+      }
+
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+
+      /* Sends ee_info up to and including ee_data are done. */
+      if ((int) (serr->ee_data + 1 - stream->zerocopy_acked) > 0)
+        stream->zerocopy_acked = serr->ee_data + 1;
+    }
+  }
+
+  while (!QUEUE_EMPTY(&stream->zerocopy_queue)) {
+    q = QUEUE_HEAD(&stream->zerocopy_queue);
+    req = QUEUE_DATA(q, uv_write_t, queue);
+
+    if (uv__write_zerocopy_pending(stream, req))
+      break;
+
+    QUEUE_REMOVE(q);
+    QUEUE_INSERT_TAIL(&stream->write_completed_queue, q);
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
+
+  if (stream->zerocopy_acked == stream->zerocopy_seq)
+    uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLERR);
+}
+#endif /* defined(__linux__) */
+
+
 static void uv__write(uv_stream_t* stream) {
+  struct iovec iovs[UV__WRITE_MAXIOV];
   struct iovec* iov;
   QUEUE* q;
   uv_write_t* req;
+  size_t size;
   int iovmax;
   int iovcnt;
+  int full;
+  int err;
+  int zerocopy;
   ssize_t n;
 
 start:
 
+  zerocopy = 0;
+
   assert(uv__stream_fd(stream) >= 0);
 
   if (QUEUE_EMPTY(&stream->write_queue))
@@ -709,6 +1183,31 @@ start:
   req = QUEUE_DATA(q, uv_write_t, queue);
   assert(req->handle == stream);
 
+  if (req->file != -1) {
+    err = uv__write_file(stream, req);
+
+    if (err == 0) {
+      uv__write_req_finish(req);
+      goto start;
+    }
+
+    if (err == -EAGAIN) {
+      uv__io_drained(&stream->io_watcher, UV__POLLOUT);
+    } else if (err != 1) {
+      req->error = err;
+      uv__write_req_finish(req);
+      uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLOUT);
+      if (!uv__io_active(&stream->io_watcher, UV__POLLIN))
+        uv__handle_stop(stream);
+      uv__stream_osx_interrupt_select(stream);
+      return;
+    }
+
+    uv__io_start(stream->loop, &stream->io_watcher, UV__POLLOUT);
+    uv__stream_osx_interrupt_select(stream);
+    return;
+  }
+
   /*
    * Cast to iovec. We had to have our own uv_buf_t instead of iovec
    * because Windows's WSABUF is not an iovec.
@@ -723,6 +1222,20 @@ start:
   if (iovcnt > iovmax)
     iovcnt = iovmax;
 
+  /* Write out the requests queued behind this one in the same writev()
+   * call rather than one system call per request.
+   */
+  if (req->send_handle == NULL &&
+      iovcnt < iovmax &&
+      QUEUE_NEXT(q) != &stream->write_queue) {
+    if (iovmax > (int) ARRAY_SIZE(iovs))
+      iovmax = ARRAY_SIZE(iovs);
+    iovcnt = uv__write_gather(stream, req, iovs, iovmax);
+    iov = iovs;
+  }
+
+  size = uv__count_bufs((const uv_buf_t*) iov, iovcnt);
+
   /*
    * Now do the actual writev. Note that we've been updating the pointers
    * inside the iov each time we write. So there is no need to offset it.
@@ -761,6 +1274,11 @@ start:
       n = sendmsg(uv__stream_fd(stream), &msg, 0);
     }
     while (n == -1 && errno == EINTR);
+#if defined(__linux__)
+  } else if (stream->zerocopy_threshold != 0 &&
+             size >= stream->zerocopy_threshold) {
+    n = uv__write_zerocopy(stream, iov, iovcnt, &zerocopy);
+#endif
   } else {
     do {
       if (iovcnt == 1) {
@@ -786,15 +1304,21 @@ start:
       /* If this is a blocking stream, try again. */
       goto start;
     }
+    uv__io_drained(&stream->io_watcher, UV__POLLOUT);
   } else {
-    /* Successful write */
+    /* Successful write, spread the byte count over the requests. */
+    full = ((size_t) n == size);
 
-    while (n >= 0) {
+    for (;;) {
       uv_buf_t* buf = &(req->bufs[req->write_index]);
       size_t len = buf->len;
 
       assert(req->write_index < req->nbufs);
 
+      /* The kernel references these buffers until the send completes. */
+      if (zerocopy)
+        req->zerocopy = stream->zerocopy_seq;
+
       if ((size_t)n < len) {
         buf->base += n;
         buf->len -= n;
@@ -809,7 +1333,12 @@ start:
            */
           goto start;
         } else {
-          /* Break loop and ensure the watcher is pending. */
+          /* Break loop and ensure the watcher is pending. If the write was
+           * short the socket buffer is full and there won't be another edge
+           * until it drains.
+           */
+          if (!full)
+            uv__io_drained(&stream->io_watcher, UV__POLLOUT);
           break;
         }
 
@@ -825,10 +1354,14 @@ start:
 
         if (req->write_index == req->nbufs) {
           /* Then we're done! */
-          assert(n == 0);
           uv__write_req_finish(req);
-          /* TODO: start trying to write the next request. */
-          return;
+          if (n == 0)
+            return;
+
+          /* The rest of the bytes belong to the requests behind it. */
+          assert(!QUEUE_EMPTY(&stream->write_queue));
+          q = QUEUE_HEAD(&stream->write_queue);
+          req = QUEUE_DATA(q, uv_write_t, queue);
         }
       }
     }
@@ -862,11 +1395,12 @@ static void uv__write_callbacks(uv_stream_t* stream) {
     if (req->bufs != NULL) {
       stream->write_queue_size -= uv__write_req_size(req);
       if (req->bufs != req->bufsml)
-        free(req->bufs);
+        uv__free(req->bufs);
       req->bufs = NULL;
     }
 
     /* NOTE: call callback AFTER freeing the request data. */
+    UV_STREAM_WRITE(stream, req, req->error);
     if (req->cb)
       req->cb(req, req->error);
   }
@@ -926,8 +1460,8 @@ static int uv__stream_queue_fd(uv_stream_t* stream, int fd) {
   queued_fds = stream->queued_fds;
   if (queued_fds == NULL) {
     queue_size = 8;
-    queued_fds = malloc((queue_size - 1) * sizeof(*queued_fds->fds) +
-                        sizeof(*queued_fds));
+    queued_fds = uv__malloc((queue_size - 1) * sizeof(*queued_fds->fds) +
+                            sizeof(*queued_fds));
     if (queued_fds == NULL)
       return -ENOMEM;
     queued_fds->size = queue_size;
@@ -937,9 +1471,9 @@ static int uv__stream_queue_fd(uv_stream_t* stream, int fd) {
     /* Grow */
   } else if (queued_fds->size == queued_fds->offset) {
     queue_size = queued_fds->size + 8;
-    queued_fds = realloc(queued_fds,
-                         (queue_size - 1) * sizeof(*queued_fds->fds) +
-                             sizeof(*queued_fds));
+    queued_fds = uv__realloc(queued_fds,
+                             (queue_size - 1) * sizeof(*queued_fds->fds) +
+                                 sizeof(*queued_fds));
 
     /*
      * Allocation failure, report back.
@@ -1018,13 +1552,16 @@ static void uv__read(uv_stream_t* stream) {
   struct msghdr msg;
   char cmsg_space[CMSG_SPACE(UV__CMSG_FD_SIZE)];
   int count;
+  int done;
   int err;
   int is_ipc;
+  int pooled;
 
   stream->flags &= ~UV_STREAM_READ_PARTIAL;
 
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
-   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
+   * we can read it. Edge-triggered watchers that run out of budget before
+   * they see EAGAIN are rearmed by uv__io_poll().
    */
   count = 32;
 
@@ -1038,6 +1575,9 @@ static void uv__read(uv_stream_t* stream) {
       && (count-- > 0)) {
     assert(stream->alloc_cb != NULL);
 
+    /* read_cb may restart reading with a different alloc_cb. */
+    pooled = (stream->alloc_cb == uv_buf_pool_alloc);
+
     stream->alloc_cb((uv_handle_t*)stream, 64 * 1024, &buf);
     if (buf.len == 0) {
       /* User indicates it can't or won't handle the read. */
@@ -1070,10 +1610,14 @@ static void uv__read(uv_stream_t* stream) {
       while (nread < 0 && errno == EINTR);
     }
 
+    UV_STREAM_READ(stream, (long) nread);
+    done = 1;
+
     if (nread < 0) {
       /* Error */
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
         /* Wait for the next one. */
+        uv__io_drained(&stream->io_watcher, UV__POLLIN);
         if (stream->flags & UV_STREAM_READING) {
           uv__io_start(stream->loop, &stream->io_watcher, UV__POLLIN);
           uv__stream_osx_interrupt_select(stream);
@@ -1085,29 +1629,40 @@ static void uv__read(uv_stream_t* stream) {
         assert(!uv__io_active(&stream->io_watcher, UV__POLLIN) &&
                "stream->read_cb(status=-1) did not call uv_close()");
       }
-      return;
     } else if (nread == 0) {
       uv__stream_eof(stream, &buf);
-      return;
     } else {
       /* Successful read */
       ssize_t buflen = buf.len;
 
+      err = 0;
       if (is_ipc) {
         err = uv__stream_recv_cmsg(stream, &msg);
-        if (err != 0) {
+        if (err != 0)
           stream->read_cb(stream, err, &buf);
-          return;
-        }
       }
-      stream->read_cb(stream, nread, &buf);
 
-      /* Return if we didn't fill the buffer, there is no more data to read. */
-      if (nread < buflen) {
-        stream->flags |= UV_STREAM_READ_PARTIAL;
-        return;
+      if (err == 0) {
+        stream->read_cb(stream, nread, &buf);
+
+        /* Stop if we didn't fill the buffer, there is no more data to read. */
+        if (nread < buflen) {
+          stream->flags |= UV_STREAM_READ_PARTIAL;
+          uv__io_drained(&stream->io_watcher, UV__POLLIN);
+        } else {
+          done = 0;
+        }
       }
     }
+
+    /* The callback has had its look at the data, the pool gets the buffer
+     * back unless uv_buf_pool_ref() was called.
+     */
+    if (pooled)
+      uv_buf_pool_unref(&buf);
+
+    if (done)
+      return;
   }
 }
 
@@ -1144,6 +1699,311 @@ int uv_shutdown(uv_shutdown_t* req, uv_stream_t* stream, uv_shutdown_cb cb) {
 }
 
 
+#if defined(__linux__)
+
+/* Bytes per splice() call and the pipe size we ask for. A bigger pipe means
+ * fewer round trips when the destination is slower than the source.
+ */
+#define UV__SPLICE_CHUNK (64 * 1024)
+#define UV__SPLICE_PIPE_SIZE (256 * 1024)
+
+
+/* Points the watchers of both streams at the work that's left: reading from
+ * src while there's room in the pipe, writing to dst while there's data in
+ * it. Writes that the user queued before the splice own POLLOUT until the
+ * write queue is empty.
+ */
+static void uv__splice_update(uv_splice_t* req) {
+  uv_stream_t* src;
+  uv_stream_t* dst;
+
+  src = req->src;
+  dst = req->dst;
+
+  if (!req->eof && !req->pipe_full)
+    uv__io_start(src->loop, &src->io_watcher, UV__POLLIN);
+  else
+    uv__io_stop(src->loop, &src->io_watcher, UV__POLLIN);
+
+  if (req->pending > 0)
+    uv__io_start(dst->loop, &dst->io_watcher, UV__POLLOUT);
+  else if (QUEUE_EMPTY(&dst->write_queue))
+    uv__io_stop(dst->loop, &dst->io_watcher, UV__POLLOUT);
+
+  uv__stream_osx_interrupt_select(src);
+  uv__stream_osx_interrupt_select(dst);
+}
+
+
+/* Unhooks the request from the stream(s) that are still open, stops their
+ * watchers and closes the pipe. Passing the stream that's being closed in
+ * `closing` keeps the request attached to it so that uv__stream_destroy()
+ * can run the callback.
+ */
+static void uv__splice_detach(uv_splice_t* req, uv_stream_t* closing) {
+  uv_stream_t* src;
+  uv_stream_t* dst;
+
+  src = req->src;
+  dst = req->dst;
+
+  if (src != closing) {
+    src->splice_read = NULL;
+    if (!(src->flags & UV_STREAM_READING)) {
+      uv__io_stop(src->loop, &src->io_watcher, UV__POLLIN);
+      if (!uv__io_active(&src->io_watcher, UV__POLLOUT))
+        uv__handle_stop(src);
+    }
+  }
+
+  if (dst != closing) {
+    dst->splice_write = NULL;
+    if (QUEUE_EMPTY(&dst->write_queue)) {
+      /* A shutdown request waited for the splice to finish. */
+      if (dst->flags & UV_STREAM_SHUTTING) {
+        uv__io_start(dst->loop, &dst->io_watcher, UV__POLLOUT);
+      } else {
+        uv__io_stop(dst->loop, &dst->io_watcher, UV__POLLOUT);
+        if (!uv__io_active(&dst->io_watcher, UV__POLLIN))
+          uv__handle_stop(dst);
+      }
+    }
+  }
+
+  uv__stream_osx_interrupt_select(src);
+  uv__stream_osx_interrupt_select(dst);
+
+  if (req->pipefd[0] != -1) {
+    uv__close(req->pipefd[0]);
+    uv__close(req->pipefd[1]);
+    req->pipefd[0] = -1;
+    req->pipefd[1] = -1;
+  }
+}
+
+
+static void uv__splice_finish(uv_splice_t* req, int status) {
+  uv__splice_detach(req, NULL);
+  uv__req_unregister(req->src->loop, req);
+
+  if (req->cb != NULL)
+    req->cb(req, status);
+}
+
+
+/* Moves data from src to the pipe and from the pipe to dst until neither
+ * makes progress. Like uv__read(), it gives up after a number of rounds so
+ * that a fast connection doesn't starve the rest of the loop.
+ */
+static void uv__splice_io(uv_splice_t* req) {
+  uv_stream_t* src;
+  uv_stream_t* dst;
+  int progress;
+  int count;
+  ssize_t n;
+
+  src = req->src;
+  dst = req->dst;
+
+  for (count = 32; count > 0; count--) {
+    progress = 0;
+
+    if (!req->eof && !req->pipe_full) {
+      do
+        n = splice(uv__stream_fd(src),
+                   NULL,
+                   req->pipefd[1],
+                   NULL,
+                   UV__SPLICE_CHUNK,
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      while (n == -1 && errno == EINTR);
+
+      if (n > 0) {
+        req->pending += n;
+        progress = 1;
+      } else if (n == 0) {
+        req->eof = 1;
+      } else if (errno != EAGAIN) {
+        uv__splice_finish(req, -errno);
+        return;
+      } else if (req->pending == 0) {
+        uv__io_drained(&src->io_watcher, UV__POLLIN);
+      } else {
+        /* Either src ran dry or the pipe is full, there's no telling which.
+         * Wait for dst to make room before reading again.
+         */
+        req->pipe_full = 1;
+      }
+    }
+
+    if (req->pending > 0 && QUEUE_EMPTY(&dst->write_queue)) {
+      do
+        n = splice(req->pipefd[0],
+                   NULL,
+                   uv__stream_fd(dst),
+                   NULL,
+                   req->pending,
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      while (n == -1 && errno == EINTR);
+
+      if (n > 0) {
+        req->pending -= n;
+        req->nbytes += n;
+        req->pipe_full = 0;
+        progress = 1;
+      } else if (n == -1 && errno == EAGAIN) {
+        uv__io_drained(&dst->io_watcher, UV__POLLOUT);
+      } else {
+        uv__splice_finish(req, n == -1 ? -errno : -EPIPE);
+        return;
+      }
+    }
+
+    if (!progress)
+      break;
+  }
+
+  if (req->eof && req->pending == 0) {
+    uv__splice_finish(req, 0);
+    return;
+  }
+
+  uv__splice_update(req);
+}
+
+
+int uv_splice_start(uv_splice_t* req,
+                    uv_stream_t* src,
+                    uv_stream_t* dst,
+                    uv_splice_cb cb) {
+  int fds[2];
+  int err;
+
+  if (src == dst)
+    return -EINVAL;
+
+  if ((src->type == UV_NAMED_PIPE && ((uv_pipe_t*) src)->ipc) ||
+      (dst->type == UV_NAMED_PIPE && ((uv_pipe_t*) dst)->ipc)) {
+    return -EINVAL;
+  }
+
+  if (uv__stream_fd(src) == -1 || uv__stream_fd(dst) == -1)
+    return -EBADF;
+
+  if (src->connect_req != NULL || dst->connect_req != NULL)
+    return -ENOTCONN;
+
+  if ((src->flags & UV_STREAM_READING) ||
+      src->splice_read != NULL ||
+      dst->splice_write != NULL) {
+    return -EBUSY;
+  }
+
+  err = uv__make_pipe(fds, UV__F_NONBLOCK);
+  if (err)
+    return err;
+
+  /* Not fatal, the pipe just stays at its default size. */
+  fcntl(fds[1], F_SETPIPE_SZ, UV__SPLICE_PIPE_SIZE);
+
+  uv__req_init(src->loop, req, UV_SPLICE);
+  req->src = src;
+  req->dst = dst;
+  req->nbytes = 0;
+  req->cb = cb;
+  req->pipefd[0] = fds[0];
+  req->pipefd[1] = fds[1];
+  req->pending = 0;
+  req->eof = 0;
+  req->pipe_full = 0;
+
+  src->splice_read = req;
+  dst->splice_write = req;
+  uv__handle_start(src);
+  uv__handle_start(dst);
+  uv__splice_update(req);
+
+  return 0;
+}
+
+
+int uv_splice_stop(uv_splice_t* req) {
+  if (req->pipefd[0] == -1 || req->src->splice_read != req)
+    return -EINVAL;
+
+  uv__splice_detach(req, NULL);
+  uv__req_unregister(req->src->loop, req);
+
+  return 0;
+}
+
+
+/* Called from uv__stream_close(), see uv__splice_detach(). */
+static void uv__splice_close(uv_stream_t* stream) {
+  if (stream->splice_read != NULL)
+    uv__splice_detach(stream->splice_read, stream);
+
+  if (stream->splice_write != NULL)
+    uv__splice_detach(stream->splice_write, stream);
+}
+
+
+/* Called from uv__stream_destroy(), cancels the splices that were still
+ * running when the stream was closed.
+ */
+static void uv__splice_destroy(uv_stream_t* stream) {
+  uv_splice_t* req;
+
+  req = stream->splice_read;
+  if (req != NULL) {
+    stream->splice_read = NULL;
+    if (req->dst->splice_write == req)
+      req->dst->splice_write = NULL;  /* Both ends were closed. */
+    uv__req_unregister(stream->loop, req);
+    if (req->cb != NULL)
+      req->cb(req, -ECANCELED);
+  }
+
+  req = stream->splice_write;
+  if (req != NULL) {
+    stream->splice_write = NULL;
+    if (req->src->splice_read == req)
+      req->src->splice_read = NULL;
+    uv__req_unregister(stream->loop, req);
+    if (req->cb != NULL)
+      req->cb(req, -ECANCELED);
+  }
+}
+
+#else  /* !__linux__ */
+
+int uv_splice_start(uv_splice_t* req,
+                    uv_stream_t* src,
+                    uv_stream_t* dst,
+                    uv_splice_cb cb) {
+  return -ENOSYS;
+}
+
+
+int uv_splice_stop(uv_splice_t* req) {
+  return -ENOSYS;
+}
+
+
+static void uv__splice_close(uv_stream_t* stream) {
+}
+
+
+static void uv__splice_destroy(uv_stream_t* stream) {
+}
+
+
+static void uv__splice_io(uv_splice_t* req) {
+}
+
+#endif  /* __linux__ */
+
+
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   uv_stream_t* stream;
 
@@ -1161,9 +2021,18 @@ static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   assert(uv__stream_fd(stream) >= 0);
 
+#if defined(__linux__)
+  if ((events & UV__POLLERR) && stream->zerocopy_seq != stream->zerocopy_acked)
+    uv__stream_zerocopy_reap(stream);
+#endif
+
   /* Ignore POLLHUP here. Even it it's set, there may still be data to read. */
-  if (events & (UV__POLLIN | UV__POLLERR | UV__POLLHUP))
-    uv__read(stream);
+  if (events & (UV__POLLIN | UV__POLLERR | UV__POLLHUP)) {
+    if (stream->splice_read != NULL)
+      uv__splice_io(stream->splice_read);
+    else
+      uv__read(stream);
+  }
 
   if (uv__stream_fd(stream) == -1)
     return;  /* read_cb closed stream. */
@@ -1189,8 +2058,15 @@ static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
     uv__write(stream);
     uv__write_callbacks(stream);
 
-    /* Write queue drained. */
-    if (QUEUE_EMPTY(&stream->write_queue))
+    /* Spliced data goes out after the queued writes. */
+    if (stream->splice_write != NULL) {
+      uv__splice_io(stream->splice_write);
+      if (uv__stream_fd(stream) == -1)
+        return;  /* splice_cb closed stream. */
+    }
+
+    /* Write queue drained. A shutdown waits for the splice to finish. */
+    if (QUEUE_EMPTY(&stream->write_queue) && stream->splice_write == NULL)
       uv__drain(stream);
   }
 }
@@ -1239,12 +2115,27 @@ static void uv__stream_connect(uv_stream_t* stream) {
 }
 
 
-int uv_write2(uv_write_t* req,
-              uv_stream_t* stream,
-              const uv_buf_t bufs[],
-              unsigned int nbufs,
-              uv_stream_t* send_handle,
-              uv_write_cb cb) {
+/* Requests that completed but haven't had their callbacks called yet put the
+ * watcher on the pending queue, where uv__stream_io() runs with UV__POLLOUT.
+ * A write made before that happens is queued up behind them so that all
+ * writes made in one loop iteration go out together in a single writev().
+ */
+static int uv__write_coalesce(uv_stream_t* stream) {
+  return !(stream->flags & UV_STREAM_BLOCKING) &&
+         !QUEUE_EMPTY(&stream->io_watcher.pending_queue);
+}
+
+
+/* uv_try_write() passes coalesce=0, it needs the write to be attempted right
+ * away and takes the request back out before it returns.
+ */
+static int uv__write_start(uv_write_t* req,
+                           uv_stream_t* stream,
+                           const uv_buf_t bufs[],
+                           unsigned int nbufs,
+                           uv_stream_t* send_handle,
+                           uv_write_cb cb,
+                           int coalesce) {
   int empty_queue;
 
   assert(nbufs > 0);
@@ -1256,6 +2147,9 @@ int uv_write2(uv_write_t* req,
   if (uv__stream_fd(stream) < 0)
     return -EBADF;
 
+  if (stream->splice_write != NULL)
+    return -EBUSY;
+
   if (send_handle) {
     if (stream->type != UV_NAMED_PIPE || !((uv_pipe_t*)stream)->ipc)
       return -EINVAL;
@@ -1277,6 +2171,8 @@ int uv_write2(uv_write_t* req,
    * a write() syscall when we know that the handle is in error mode.
    */
   empty_queue = (stream->write_queue_size == 0);
+  if (coalesce && uv__write_coalesce(stream))
+    empty_queue = 0;
 
   /* Initialize the req */
   uv__req_init(stream->loop, req, UV_WRITE);
@@ -1284,11 +2180,13 @@ int uv_write2(uv_write_t* req,
   req->handle = stream;
   req->error = 0;
   req->send_handle = send_handle;
+  req->file = -1;
+  req->zerocopy = 0;
   QUEUE_INIT(&req->queue);
 
   req->bufs = req->bufsml;
   if (nbufs > ARRAY_SIZE(req->bufsml))
-    req->bufs = malloc(nbufs * sizeof(bufs[0]));
+    req->bufs = uv__malloc(nbufs * sizeof(bufs[0]));
 
   if (req->bufs == NULL)
     return -ENOMEM;
@@ -1326,6 +2224,16 @@ int uv_write2(uv_write_t* req,
 }
 
 
+int uv_write2(uv_write_t* req,
+              uv_stream_t* stream,
+              const uv_buf_t bufs[],
+              unsigned int nbufs,
+              uv_stream_t* send_handle,
+              uv_write_cb cb) {
+  return uv__write_start(req, stream, bufs, nbufs, send_handle, cb, 1);
+}
+
+
 /* The buffers to be written must remain valid until the callback is called.
  * This is not required for the uv_buf_t array.
  */
@@ -1338,6 +2246,70 @@ int uv_write(uv_write_t* req,
 }
 
 
+int uv_write_file(uv_write_t* req,
+                  uv_stream_t* stream,
+                  uv_file file,
+                  int64_t offset,
+                  size_t length,
+                  uv_write_cb cb) {
+  int empty_queue;
+
+  assert((stream->type == UV_TCP ||
+          stream->type == UV_NAMED_PIPE ||
+          stream->type == UV_TTY) &&
+         "uv_write_file (unix) does not yet support other types of streams");
+
+  if (uv__stream_fd(stream) < 0 || file < 0)
+    return -EBADF;
+
+  if (offset < 0)
+    return -EINVAL;
+
+  if (stream->splice_write != NULL)
+    return -EBUSY;
+
+  /* See uv__write_start(). */
+  empty_queue = (stream->write_queue_size == 0);
+  if (uv__write_coalesce(stream))
+    empty_queue = 0;
+
+  uv__req_init(stream->loop, req, UV_WRITE);
+  req->cb = cb;
+  req->handle = stream;
+  req->error = 0;
+  req->send_handle = NULL;
+  req->file = file;
+  req->file_offset = offset;
+  req->zerocopy = 0;
+  QUEUE_INIT(&req->queue);
+
+  /* The remaining length is tracked in bufsml[0] so that write_queue_size
+   * bookkeeping works the same as for regular writes. It has no base.
+   */
+  req->bufs = req->bufsml;
+  req->bufs[0] = uv_buf_init(NULL, length);
+  req->nbufs = 1;
+  req->write_index = 0;
+  stream->write_queue_size += length;
+
+  QUEUE_INSERT_TAIL(&stream->write_queue, &req->queue);
+
+  if (stream->connect_req) {
+    /* Still connecting, do nothing. */
+  }
+  else if (empty_queue) {
+    uv__write(stream);
+  }
+  else {
+    assert(!(stream->flags & UV_STREAM_BLOCKING));
+    uv__io_start(stream->loop, &stream->io_watcher, UV__POLLOUT);
+    uv__stream_osx_interrupt_select(stream);
+  }
+
+  return 0;
+}
+
+
 void uv_try_write_cb(uv_write_t* req, int status) {
   /* Should not be called */
   abort();
@@ -1351,6 +2323,7 @@ int uv_try_write(uv_stream_t* stream,
   int has_pollout;
   size_t written;
   size_t req_size;
+  size_t zerocopy_threshold;
   uv_write_t req;
 
   /* Connecting or already writing some data */
@@ -1359,7 +2332,13 @@ int uv_try_write(uv_stream_t* stream,
 
   has_pollout = uv__io_active(&stream->io_watcher, UV__POLLOUT);
 
-  r = uv_write(&req, stream, bufs, nbufs, uv_try_write_cb);
+  /* The caller gets the buffers back right away, the kernel can't keep
+   * referencing them.
+   */
+  zerocopy_threshold = stream->zerocopy_threshold;
+  stream->zerocopy_threshold = 0;
+  r = uv__write_start(&req, stream, bufs, nbufs, NULL, uv_try_write_cb, 0);
+  stream->zerocopy_threshold = zerocopy_threshold;
   if (r != 0)
     return r;
 
@@ -1376,7 +2355,7 @@ int uv_try_write(uv_stream_t* stream,
   QUEUE_REMOVE(&req.queue);
   uv__req_unregister(stream->loop, &req);
   if (req.bufs != req.bufsml)
-    free(req.bufs);
+    uv__free(req.bufs);
   req.bufs = NULL;
 
   /* Do not poll for writable, if we wasn't before calling this */
@@ -1401,6 +2380,9 @@ int uv_read_start(uv_stream_t* stream,
   if (stream->flags & UV_CLOSING)
     return -EINVAL;
 
+  if (stream->splice_read != NULL)
+    return -EBUSY;
+
   /* The UV_STREAM_READING flag is irrelevant of the state of the tcp - it just
    * expresses the desired state of the user.
    */
@@ -1433,13 +2415,18 @@ int uv_read_stop(uv_stream_t* stream) {
          !QUEUE_EMPTY(&stream->write_completed_queue) ||
          !QUEUE_EMPTY(&stream->write_queue) ||
          stream->shutdown_req != NULL ||
-         stream->connect_req != NULL);
+         stream->connect_req != NULL ||
+         stream->splice_write != NULL);
 
   stream->flags &= ~UV_STREAM_READING;
-  uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLIN);
-  if (!uv__io_active(&stream->io_watcher, UV__POLLOUT))
-    uv__handle_stop(stream);
-  uv__stream_osx_interrupt_select(stream);
+
+  /* A splice reads from the stream, leave the watcher alone. */
+  if (stream->splice_read == NULL) {
+    uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLIN);
+    if (!uv__io_active(&stream->io_watcher, UV__POLLOUT))
+      uv__handle_stop(stream);
+    uv__stream_osx_interrupt_select(stream);
+  }
 
   stream->read_cb = NULL;
   stream->alloc_cb = NULL;
@@ -1499,6 +2486,18 @@ void uv__stream_close(uv_stream_t* handle) {
   }
 #endif /* defined(__APPLE__) */
 
+  uv__splice_close(handle);
+
+#if defined(__linux__)
+  /* Zero-copy writes that the kernel already finished complete with status 0,
+   * the error queue goes away with the socket.
+   */
+  if (handle->io_watcher.fd != -1 &&
+      handle->zerocopy_seq != handle->zerocopy_acked) {
+    uv__stream_zerocopy_reap(handle);
+  }
+#endif
+
   uv__io_close(handle->loop, &handle->io_watcher);
   uv_read_stop(handle);
   uv__handle_stop(handle);
@@ -1520,7 +2519,7 @@ void uv__stream_close(uv_stream_t* handle) {
     queued_fds = handle->queued_fds;
     for (i = 0; i < queued_fds->offset; i++)
       uv__close(queued_fds->fds[i]);
-    free(handle->queued_fds);
+    uv__free(handle->queued_fds);
     handle->queued_fds = NULL;
   }
 
@@ -1531,3 +2530,12 @@ void uv__stream_close(uv_stream_t* handle) {
 int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
   return UV_ENOSYS;
 }
+
+
+int uv_stream_set_edge_triggered(uv_stream_t* handle, int enable) {
+#if defined(__linux__)
+  return uv__io_set_edge(handle->loop, &handle->io_watcher, enable);
+#else
+  return -ENOSYS;
+#endif
+}
@@ -27,6 +27,13 @@
 #include <assert.h>
 #include <errno.h>
 
+#if defined(__linux__)
+# include <sys/socket.h>
+# ifndef SO_ZEROCOPY
+#  define SO_ZEROCOPY 60
+# endif
+#endif
+
 
 int uv_tcp_init(uv_loop_t* loop, uv_tcp_t* tcp) {
   uv__stream_init(loop, (uv_stream_t*)tcp, UV_TCP);
@@ -77,6 +84,20 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return -errno;
 
+  if (flags & UV_TCP_REUSEPORT) {
+#ifdef SO_REUSEPORT
+    if (setsockopt(tcp->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT,
+                   &on,
+                   sizeof(on))) {
+      return -errno;
+    }
+#else
+    return -ENOTSUP;
+#endif
+  }
+
 #ifdef IPV6_V6ONLY
   if (addr->sa_family == AF_INET6) {
     on = (flags & UV_TCP_IPV6ONLY) != 0;
@@ -228,6 +249,15 @@ int uv_tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb) {
   if (listen(tcp->io_watcher.fd, backlog))
     return -errno;
 
+#if defined(__linux__)
+  /* Let the kernel do the balancing, there's no need to back off after
+   * every accept when only one of the processes is woken up. Falls back to
+   * the nanosleep() in uv__server_io() when the backend can't do it.
+   */
+  if (tcp->flags & UV_TCP_SINGLE_ACCEPT)
+    uv__io_set_exclusive(tcp->loop, &tcp->io_watcher, 1);
+#endif
+
   tcp->connection_cb = cb;
 
   /* Start listening for connections. */
@@ -267,6 +297,17 @@ int uv__tcp_keepalive(int fd, int on, unsigned int delay) {
 }
 
 
+int uv__tcp_zerocopy(int fd, int on) {
+#if defined(__linux__)
+  if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)))
+    return -errno;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv_tcp_nodelay(uv_tcp_t* handle, int on) {
   int err;
 
@@ -307,11 +348,45 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int delay) {
 }
 
 
+int uv_tcp_zerocopy(uv_tcp_t* handle, int on, size_t threshold) {
+#if defined(__linux__)
+  int err;
+
+  if (uv__stream_fd(handle) != -1) {
+    err = uv__tcp_zerocopy(uv__stream_fd(handle), on);
+    if (err)
+      return err;
+  }
+
+  if (threshold == 0)
+    threshold = UV__ZEROCOPY_THRESHOLD;
+
+  if (on) {
+    handle->flags |= UV_TCP_ZEROCOPY;
+    handle->zerocopy_threshold = threshold;
+  } else {
+    handle->flags &= ~UV_TCP_ZEROCOPY;
+    handle->zerocopy_threshold = 0;
+  }
+
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   if (enable)
     handle->flags &= ~UV_TCP_SINGLE_ACCEPT;
   else
     handle->flags |= UV_TCP_SINGLE_ACCEPT;
+
+#if defined(__linux__)
+  if (handle->io_watcher.cb == uv__server_io)
+    uv__io_set_exclusive(handle->loop, &handle->io_watcher, !enable);
+#endif
+
   return 0;
 }
 
@@ -21,6 +21,7 @@
 
 #include "internal.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
 
@@ -34,6 +35,13 @@ static QUEUE exit_message;
 static QUEUE wq;
 static volatile int initialized;
 
+/* Guarded by the global mutex. */
+static unsigned int nqueued;
+static unsigned int max_queued;
+static unsigned int nbusy;
+static uint64_t ncompleted;
+static uv_metrics_histogram_t wait_histogram;
+
 
 static void uv__cancelled(struct uv__work* w) {
   abort();
@@ -45,13 +53,31 @@ static void uv__cancelled(struct uv__work* w) {
  */
 static void worker(void* arg) {
   struct uv__work* w;
+  uint64_t start;
+  uint64_t wait;
+  uint64_t end;
+  int busy;
   QUEUE* q;
 
   (void) arg;
+  busy = 0;
+  start = 0;
+  wait = 0;
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
+    /* Account for the previous piece of work now rather than take the mutex
+     * once more for it.
+     */
+    if (busy) {
+      nbusy--;
+      ncompleted++;
+      if (start != 0)
+        uv__metrics_histogram_add(&wait_histogram, wait / 1000);
+      busy = 0;
+    }
+
     while (QUEUE_EMPTY(&wq))
       uv_cond_wait(&cond, &mutex);
 
@@ -63,6 +89,9 @@ static void worker(void* arg) {
       QUEUE_REMOVE(q);
       QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
                              executing. */
+      nqueued--;
+      nbusy++;
+      busy = 1;
     }
 
     uv_mutex_unlock(&mutex);
@@ -71,9 +100,26 @@ static void worker(void* arg) {
       break;
 
     w = QUEUE_DATA(q, struct uv__work, wq);
+
+    /* Work is only timed when its loop has metrics on. */
+    wait = 0;
+    start = 0;
+    end = 0;
+    if (w->queued_at != 0) {
+      start = uv__hrtime(UV_CLOCK_PRECISE);
+      wait = start - w->queued_at;
+    }
+
+    UV_WORK_START(w->loop, w);
     w->work(w);
 
+    if (start != 0)
+      end = uv__hrtime(UV_CLOCK_PRECISE);
+
     uv_mutex_lock(&w->loop->wq_mutex);
+    if (start != 0 && w->loop->metrics != NULL)
+      uv__metrics_record_work(w->loop, wait, end - start);
+
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
     QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
@@ -86,12 +132,16 @@ static void worker(void* arg) {
 static void post(QUEUE* q) {
   uv_mutex_lock(&mutex);
   QUEUE_INSERT_TAIL(&wq, q);
+  if (q != &exit_message && ++nqueued > max_queued)
+    max_queued = nqueued;
   uv_cond_signal(&cond);
   uv_mutex_unlock(&mutex);
 }
 
 
 static void init_once(void) {
+  sigset_t saved_sigset;
+  sigset_t sigset;
   unsigned int i;
   const char* val;
 
@@ -106,7 +156,7 @@ static void init_once(void) {
 
   threads = default_threads;
   if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = malloc(nthreads * sizeof(threads[0]));
+    threads = uv__malloc(nthreads * sizeof(threads[0]));
     if (threads == NULL) {
       nthreads = ARRAY_SIZE(default_threads);
       threads = default_threads;
@@ -121,10 +171,23 @@ static void init_once(void) {
 
   QUEUE_INIT(&wq);
 
+  /* Workers never handle signals. Start them with everything blocked so
+   * process-directed signals stay queued for a loop's signalfd or go to a
+   * thread that wants them.
+   */
+  if (sigfillset(&sigset))
+    abort();
+
+  if (pthread_sigmask(SIG_SETMASK, &sigset, &saved_sigset))
+    abort();
+
   for (i = 0; i < nthreads; i++)
     if (uv_thread_create(threads + i, worker, NULL))
       abort();
 
+  if (pthread_sigmask(SIG_SETMASK, &saved_sigset, NULL))
+    abort();
+
   initialized = 1;
 }
 
@@ -142,7 +205,7 @@ UV_DESTRUCTOR(static void cleanup(void)) {
       abort();
 
   if (threads != default_threads)
-    free(threads);
+    uv__free(threads);
 
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
@@ -161,6 +224,10 @@ void uv__work_submit(uv_loop_t* loop,
   w->loop = loop;
   w->work = work;
   w->done = done;
+  w->queued_at = 0;
+  if (loop->metrics != NULL)
+    w->queued_at = uv__metrics_record_work_submit(loop);
+  UV_WORK_SUBMIT(loop, w);
   post(&w->wq);
 }
 
@@ -172,8 +239,10 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    nqueued--;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -194,6 +263,7 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
 void uv__work_done(uv_async_t* handle) {
   struct uv__work* w;
   uv_loop_t* loop;
+  unsigned int n;
   QUEUE* q;
   QUEUE wq;
   int err;
@@ -208,14 +278,21 @@ void uv__work_done(uv_async_t* handle) {
   }
   uv_mutex_unlock(&loop->wq_mutex);
 
+  n = 0;
   while (!QUEUE_EMPTY(&wq)) {
     q = QUEUE_HEAD(&wq);
     QUEUE_REMOVE(q);
 
     w = container_of(q, struct uv__work, wq);
     err = (w->work == uv__cancelled) ? -ECANCELED : 0;
+    UV_WORK_DONE(loop, w, err);
     w->done(w, err);
+    n++;
   }
+
+  /* Done callbacks can turn metrics on or off. */
+  if (loop->metrics != NULL)
+    uv__metrics_record_work_done(loop, n);
 }
 
 
@@ -282,3 +359,22 @@ int uv_cancel(uv_req_t* req) {
 
   return uv__work_cancel(loop, req, wreq);
 }
+
+
+int uv_threadpool_metrics(uv_threadpool_metrics_t* metrics) {
+  memset(metrics, 0, sizeof(*metrics));
+
+  if (initialized == 0)
+    return 0;
+
+  uv_mutex_lock(&mutex);
+  metrics->threads = nthreads;
+  metrics->queued = nqueued;
+  metrics->max_queued = max_queued;
+  metrics->busy = nbusy;
+  metrics->completed = ncompleted;
+  metrics->wait = wait_histogram;
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
@@ -24,6 +24,32 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Hierarchical timing wheel, see uv_loop_set_timer_wheel(). Level 0 has one
+ * slot per millisecond, every next level has slots that are 64 times wider.
+ * Timers are moved down a level when the loop's time reaches the start of
+ * their slot. That's called a cascade.
+ *
+ * Timers on the wheel reuse the storage of their heap_node: the first two
+ * pointers link the timer into its slot, the third points to the slot.
+ */
+#define UV__WHEEL_BITS    6
+#define UV__WHEEL_SIZE    (1 << UV__WHEEL_BITS)
+#define UV__WHEEL_MASK    (UV__WHEEL_SIZE - 1)
+#define UV__WHEEL_LEVELS  6
+
+struct uv__timer_wheel {
+  uint64_t cur;  /* Next millisecond to expire. */
+  uint64_t bits[UV__WHEEL_LEVELS];  /* Non-empty slots. */
+  unsigned int ntimers;
+  int running;
+  QUEUE slots[UV__WHEEL_LEVELS][UV__WHEEL_SIZE];
+};
+
+#define uv__timer_queue(handle) ((QUEUE*) &(handle)->heap_node)
+#define uv__timer_slot(handle) ((QUEUE*) (handle)->heap_node[2])
 
 
 static int timer_less_than(const struct heap_node* ha,
@@ -51,6 +77,329 @@ static int timer_less_than(const struct heap_node* ha,
 }
 
 
+static unsigned int uv__ctz64(uint64_t v) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(v);
+#else
+  unsigned int n;
+
+  for (n = 0; (v & 1) == 0; n++)
+    v >>= 1;
+
+  return n;
+#endif
+}
+
+
+static void uv__wheel_insert(struct uv__timer_wheel* wheel,
+                             uv_timer_t* handle) {
+  uint64_t expires;
+  uint64_t delta;
+  unsigned int level;
+  unsigned int slot;
+  QUEUE* q;
+
+  expires = handle->timeout;
+  if (expires < wheel->cur)
+    expires = wheel->cur;
+
+  delta = expires - wheel->cur;
+  for (level = 0; level < UV__WHEEL_LEVELS - 1; level++)
+    if ((delta >> (UV__WHEEL_BITS * (level + 1))) == 0)
+      break;
+
+  /* Too far out. Park it in the top level, it's put back in the right place
+   * when its slot is cascaded.
+   */
+  if ((delta >> (UV__WHEEL_BITS * UV__WHEEL_LEVELS)) != 0)
+    expires = wheel->cur +
+              ((uint64_t) 1 << (UV__WHEEL_BITS * UV__WHEEL_LEVELS)) - 1;
+
+  slot = (expires >> (UV__WHEEL_BITS * level)) & UV__WHEEL_MASK;
+  q = &wheel->slots[level][slot];
+  QUEUE_INSERT_TAIL(q, uv__timer_queue(handle));
+  handle->heap_node[2] = q;
+  wheel->bits[level] |= (uint64_t) 1 << slot;
+}
+
+
+static void uv__wheel_remove(struct uv__timer_wheel* wheel,
+                             uv_timer_t* handle) {
+  unsigned int index;
+  QUEUE* q;
+
+  QUEUE_REMOVE(uv__timer_queue(handle));
+
+  /* Expired timers are not on a slot anymore, see uv__wheel_expire(). */
+  q = uv__timer_slot(handle);
+  if (q == NULL || !QUEUE_EMPTY(q))
+    return;
+
+  index = q - &wheel->slots[0][0];
+  wheel->bits[index / UV__WHEEL_SIZE] &=
+      ~((uint64_t) 1 << (index % UV__WHEEL_SIZE));
+}
+
+
+static void uv__wheel_cascade(struct uv__timer_wheel* wheel,
+                              unsigned int level) {
+  unsigned int slot;
+  uv_timer_t* handle;
+  QUEUE queue;
+  QUEUE* head;
+  QUEUE* q;
+
+  slot = (wheel->cur >> (UV__WHEEL_BITS * level)) & UV__WHEEL_MASK;
+  q = &wheel->slots[level][slot];
+  if (QUEUE_EMPTY(q))
+    return;
+
+  /* Parked timers can go right back into the same slot. */
+  head = QUEUE_HEAD(q);
+  QUEUE_SPLIT(q, head, &queue);
+  wheel->bits[level] &= ~((uint64_t) 1 << slot);
+
+  while (!QUEUE_EMPTY(&queue)) {
+    q = QUEUE_HEAD(&queue);
+    QUEUE_REMOVE(q);
+    handle = container_of(q, uv_timer_t, heap_node);
+    uv__wheel_insert(wheel, handle);
+  }
+}
+
+
+static QUEUE* uv__wheel_merge(QUEUE* a, QUEUE* b) {
+  QUEUE head;
+  QUEUE* tail;
+
+  tail = &head;
+  while (a != NULL && b != NULL) {
+    if (timer_less_than((struct heap_node*) b, (struct heap_node*) a)) {
+      QUEUE_NEXT(tail) = b;
+      tail = b;
+      b = QUEUE_NEXT(b);
+    } else {
+      QUEUE_NEXT(tail) = a;
+      tail = a;
+      a = QUEUE_NEXT(a);
+    }
+  }
+
+  QUEUE_NEXT(tail) = (a != NULL) ? a : b;
+  return QUEUE_NEXT(&head);
+}
+
+
+/* Timers in a level 0 slot expire in the same millisecond (or are overdue)
+ * but they're not necessarily in start order because some got there by way
+ * of a cascade. Put them in the order timer_less_than() says, the same order
+ * the heap would run them in. Usually that's a no-op.
+ */
+static void uv__wheel_sort(QUEUE* queue) {
+  QUEUE* parts[64];
+  QUEUE* prev;
+  QUEUE* list;
+  QUEUE* next;
+  QUEUE* q;
+  unsigned int i;
+  int sorted;
+
+  sorted = 1;
+  prev = NULL;
+  QUEUE_FOREACH(q, queue) {
+    container_of(q, uv_timer_t, heap_node)->heap_node[2] = NULL;
+    if (prev != NULL &&
+        timer_less_than((struct heap_node*) q, (struct heap_node*) prev)) {
+      sorted = 0;
+    }
+    prev = q;
+  }
+
+  if (sorted)
+    return;
+
+  /* Bottom-up merge sort on a NULL terminated singly linked list. */
+  memset(parts, 0, sizeof(parts));
+  QUEUE_PREV_NEXT(queue) = NULL;
+  list = QUEUE_NEXT(queue);
+
+  while (list != NULL) {
+    q = list;
+    list = QUEUE_NEXT(list);
+    QUEUE_NEXT(q) = NULL;
+
+    for (i = 0; parts[i] != NULL; i++) {
+      q = uv__wheel_merge(parts[i], q);
+      parts[i] = NULL;
+    }
+    parts[i] = q;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(parts); i++)
+    if (parts[i] != NULL)
+      list = uv__wheel_merge(parts[i], list);
+
+  QUEUE_INIT(queue);
+  for (q = list; q != NULL; q = next) {
+    next = QUEUE_NEXT(q);
+    QUEUE_INSERT_TAIL(queue, q);
+  }
+}
+
+
+static void uv__wheel_expire(struct uv__timer_wheel* wheel) {
+  unsigned int slot;
+  uv_timer_t* handle;
+  QUEUE queue;
+  QUEUE* head;
+  QUEUE* q;
+
+  slot = wheel->cur & UV__WHEEL_MASK;
+  q = &wheel->slots[0][slot];
+
+  /* Callbacks can start timers that are due right away. They end up in the
+   * same slot and run in the same uv__run_timers() call, like they would
+   * with the heap.
+   */
+  while (!QUEUE_EMPTY(q)) {
+    head = QUEUE_HEAD(q);
+    QUEUE_SPLIT(q, head, &queue);
+    wheel->bits[0] &= ~((uint64_t) 1 << slot);
+    uv__wheel_sort(&queue);
+
+    while (!QUEUE_EMPTY(&queue)) {
+      handle = container_of(QUEUE_HEAD(&queue), uv_timer_t, heap_node);
+      uv_timer_stop(handle);
+      uv_timer_again(handle);
+      handle->timer_cb(handle);
+    }
+  }
+}
+
+
+static void uv__wheel_run(uv_loop_t* loop, struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int slot;
+  uint64_t bits;
+  uint64_t next;
+
+  for (;;) {
+    uv__wheel_expire(wheel);
+
+    if (wheel->cur >= loop->time)
+      break;
+
+    /* Skip ahead to the next non-empty slot in this round of level 0, or
+     * to the start of the next round if there's none.
+     */
+    slot = wheel->cur & UV__WHEEL_MASK;
+    bits = wheel->bits[0] & ~(((uint64_t) 2 << slot) - 1);
+    if (bits != 0)
+      next = wheel->cur - slot + uv__ctz64(bits);
+    else
+      next = (wheel->cur | UV__WHEEL_MASK) + 1;
+
+    if (next > loop->time)
+      next = loop->time;
+
+    wheel->cur = next;
+
+    if ((next & UV__WHEEL_MASK) != 0)
+      continue;
+
+    for (level = 1; level < UV__WHEEL_LEVELS; level++) {
+      uv__wheel_cascade(wheel, level);
+      if ((next >> (UV__WHEEL_BITS * level)) & UV__WHEEL_MASK)
+        break;
+    }
+  }
+}
+
+
+/* Returns the first point in time where uv__wheel_run() has work to do,
+ * either expiring timers or cascading them.
+ */
+static uint64_t uv__wheel_next(const struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int shift;
+  unsigned int slot;
+  uint64_t bits;
+  uint64_t best;
+  uint64_t dist;
+  uint64_t t;
+
+  best = (uint64_t) -1;
+
+  for (level = 0; level < UV__WHEEL_LEVELS; level++) {
+    bits = wheel->bits[level];
+    if (bits == 0)
+      continue;
+
+    shift = UV__WHEEL_BITS * level;
+    slot = (wheel->cur >> shift) & UV__WHEEL_MASK;
+
+    if (level == 0 && (bits & ((uint64_t) 1 << slot)))
+      return wheel->cur;
+
+    /* The current slot of a level > 0 holds timers for the next round. */
+    if (slot != UV__WHEEL_MASK && (bits >> (slot + 1)) != 0)
+      dist = uv__ctz64(bits >> (slot + 1)) + 1;
+    else
+      dist = uv__ctz64(bits) + UV__WHEEL_SIZE - slot;
+
+    if (level == 0)
+      t = wheel->cur + dist;
+    else
+      t = ((wheel->cur >> shift) + dist) << shift;
+
+    if (t < best)
+      best = t;
+  }
+
+  return best;
+}
+
+
+int uv_loop_set_timer_wheel(uv_loop_t* loop, int enable) {
+  struct uv__timer_wheel* wheel;
+  unsigned int level;
+  unsigned int slot;
+
+  wheel = loop->timer_wheel;
+  if ((wheel != NULL) == (enable != 0))
+    return 0;
+
+  if (loop->timer_heap.nelts != 0)
+    return -EBUSY;
+
+  if (wheel != NULL && (wheel->ntimers != 0 || wheel->running))
+    return -EBUSY;
+
+  if (wheel != NULL) {
+    uv__free(wheel);
+    loop->timer_wheel = NULL;
+    return 0;
+  }
+
+  wheel = uv__malloc(sizeof(*wheel));
+  if (wheel == NULL)
+    return -ENOMEM;
+
+  for (level = 0; level < UV__WHEEL_LEVELS; level++) {
+    for (slot = 0; slot < UV__WHEEL_SIZE; slot++)
+      QUEUE_INIT(&wheel->slots[level][slot]);
+    wheel->bits[level] = 0;
+  }
+
+  wheel->cur = loop->time;
+  wheel->ntimers = 0;
+  wheel->running = 0;
+  loop->timer_wheel = wheel;
+
+  return 0;
+}
+
+
 int uv_timer_init(uv_loop_t* loop, uv_timer_t* handle) {
   uv__handle_init(loop, (uv_handle_t*)handle, UV_TIMER);
   handle->timer_cb = NULL;
@@ -63,6 +412,7 @@ int uv_timer_start(uv_timer_t* handle,
                    uv_timer_cb cb,
                    uint64_t timeout,
                    uint64_t repeat) {
+  struct uv__timer_wheel* wheel;
   uint64_t clamped_timeout;
 
   if (uv__is_active(handle))
@@ -78,9 +428,15 @@ int uv_timer_start(uv_timer_t* handle,
   /* start_id is the second index to be compared in uv__timer_cmp() */
   handle->start_id = handle->loop->timer_counter++;
 
-  heap_insert((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL) {
+    wheel = handle->loop->timer_wheel;
+    uv__wheel_insert(wheel, handle);
+    wheel->ntimers++;
+  } else {
+    heap_insert((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+  }
   uv__handle_start(handle);
 
   return 0;
@@ -88,12 +444,20 @@ int uv_timer_start(uv_timer_t* handle,
 
 
 int uv_timer_stop(uv_timer_t* handle) {
+  struct uv__timer_wheel* wheel;
+
   if (!uv__is_active(handle))
     return 0;
 
-  heap_remove((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL) {
+    wheel = handle->loop->timer_wheel;
+    uv__wheel_remove(wheel, handle);
+    wheel->ntimers--;
+  } else {
+    heap_remove((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+  }
   uv__handle_stop(handle);
 
   return 0;
@@ -124,9 +488,27 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 
 
 int uv__next_timeout(const uv_loop_t* loop) {
+  const struct uv__timer_wheel* wheel;
   const struct heap_node* heap_node;
   const uv_timer_t* handle;
   uint64_t diff;
+  uint64_t t;
+
+  if (loop->timer_wheel != NULL) {
+    wheel = loop->timer_wheel;
+    if (wheel->ntimers == 0)
+      return -1; /* block indefinitely */
+
+    t = uv__wheel_next(wheel);
+    if (t <= loop->time)
+      return 0;
+
+    diff = t - loop->time;
+    if (diff > INT_MAX)
+      diff = INT_MAX;
+
+    return diff;
+  }
 
   heap_node = heap_min((const struct heap*) &loop->timer_heap);
   if (heap_node == NULL)
@@ -144,10 +526,31 @@ int uv__next_timeout(const uv_loop_t* loop) {
 }
 
 
+
+unsigned int uv__timer_count(const uv_loop_t* loop) {
+  const struct uv__timer_wheel* wheel;
+
+  wheel = loop->timer_wheel;
+  if (wheel != NULL)
+    return wheel->ntimers;
+
+  return loop->timer_heap.nelts;
+}
+
+
 void uv__run_timers(uv_loop_t* loop) {
+  struct uv__timer_wheel* wheel;
   struct heap_node* heap_node;
   uv_timer_t* handle;
 
+  if (loop->timer_wheel != NULL) {
+    wheel = loop->timer_wheel;
+    wheel->running = 1;
+    uv__wheel_run(loop, wheel);
+    wheel->running = 0;
+    return;
+  }
+
   for (;;) {
     heap_node = heap_min((struct heap*) &loop->timer_heap);
     if (heap_node == NULL)
@@ -28,6 +28,13 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+# include <netinet/in.h>
+# ifndef UDP_SEGMENT
+#  define UDP_SEGMENT 103
+# endif
+#endif
+
 #if defined(IPV6_JOIN_GROUP) && !defined(IPV6_ADD_MEMBERSHIP)
 # define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
 #endif
@@ -89,6 +96,9 @@ static void uv__udp_run_completed(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
 
+  assert(!(handle->flags & UV_HANDLE_UDP_PROCESSING));
+  handle->flags |= UV_HANDLE_UDP_PROCESSING;
+
   while (!QUEUE_EMPTY(&handle->write_completed_queue)) {
     q = QUEUE_HEAD(&handle->write_completed_queue);
     QUEUE_REMOVE(q);
@@ -100,7 +110,7 @@ static void uv__udp_run_completed(uv_udp_t* handle) {
     handle->send_queue_count--;
 
     if (req->bufs != req->bufsml)
-      free(req->bufs);
+      uv__free(req->bufs);
     req->bufs = NULL;
 
     if (req->send_cb == NULL)
@@ -115,6 +125,8 @@ static void uv__udp_run_completed(uv_udp_t* handle) {
       req->send_cb(req, req->status);
   }
 
+  handle->flags &= ~UV_HANDLE_UDP_PROCESSING;
+
   if (QUEUE_EMPTY(&handle->write_queue)) {
     /* Pending queue and completion queue empty, stop watcher. */
     uv__io_stop(handle->loop, &handle->io_watcher, UV__POLLOUT);
@@ -140,11 +152,92 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if defined(__linux__)
+
+#define UV__MMSG_MAXWIDTH 20
+
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  const struct sockaddr* addr;
+  uv_udp_recv_cb recv_cb;
+  uv_buf_t chunk;
+  size_t nchunks;
+  size_t size;
+  ssize_t nread;
+  ssize_t k;
+  int flags;
+
+  size = handle->mmsg_size;
+  if (size > buf->len)
+    size = buf->len;
+
+  nchunks = buf->len / size;
+  if (nchunks > ARRAY_SIZE(msgs))
+    nchunks = ARRAY_SIZE(msgs);
+
+  memset(msgs, 0, nchunks * sizeof(msgs[0]));
+  for (k = 0; k < (ssize_t) nchunks; k++) {
+    iov[k].iov_base = buf->base + k * size;
+    iov[k].iov_len = size;
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[k]);
+  }
+
+  do
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, nchunks, 0, NULL);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      uv__io_drained(&handle->io_watcher, UV__POLLIN);
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    } else {
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    }
+    return -1;
+  }
+
+  /* recv_cb may stop the handle. Hand back the buffer regardless. */
+  recv_cb = handle->recv_cb;
+
+  for (k = 0; k < nread && handle->recv_cb != NULL; k++) {
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    if (msgs[k].msg_hdr.msg_namelen == 0)
+      addr = NULL;
+    else
+      addr = (const struct sockaddr*) (peers + k);
+
+    chunk = uv_buf_init(iov[k].iov_base, msgs[k].msg_len);
+    handle->recv_cb(handle, msgs[k].msg_len, &chunk, addr, flags);
+  }
+
+  recv_cb(handle, 0, buf, NULL, 0);
+
+  /* A short batch means the socket buffer is empty. */
+  if ((size_t) nread < nchunks) {
+    uv__io_drained(&handle->io_watcher, UV__POLLIN);
+    return -1;
+  }
+
+  return nread;
+}
+
+#endif /* __linux__ */
+
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
   ssize_t nread;
   uv_buf_t buf;
+  int pooled;
   int flags;
   int count;
 
@@ -152,7 +245,8 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   assert(handle->alloc_cb != NULL);
 
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
-   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
+   * we can read it. Edge-triggered watchers that run out of budget before
+   * they see EAGAIN are rearmed by uv__io_poll().
    */
   count = 32;
 
@@ -160,6 +254,27 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   h.msg_name = &peer;
 
   do {
+    /* recv_cb may restart receiving with a different alloc_cb. */
+    pooled = (handle->alloc_cb == uv_buf_pool_alloc);
+
+#if defined(__linux__)
+    if (handle->mmsg_size != 0) {
+      handle->alloc_cb((uv_handle_t*) handle,
+                       handle->mmsg_size * UV__MMSG_MAXWIDTH,
+                       &buf);
+      if (buf.len == 0) {
+        handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
+        return;
+      }
+      assert(buf.base != NULL);
+
+      nread = uv__udp_recvmmsg(handle, &buf);
+      if (pooled)
+        uv_buf_pool_unref(&buf);
+      continue;
+    }
+#endif /* __linux__ */
+
     handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
@@ -177,9 +292,10 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
     while (nread == -1 && errno == EINTR);
 
     if (nread == -1) {
-      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        uv__io_drained(&handle->io_watcher, UV__POLLIN);
         handle->recv_cb(handle, 0, &buf, NULL, 0);
-      else
+      } else
         handle->recv_cb(handle, -errno, &buf, NULL, 0);
     }
     else {
@@ -195,6 +311,9 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 
       handle->recv_cb(handle, nread, &buf, addr, flags);
     }
+
+    if (pooled)
+      uv_buf_pool_unref(&buf);
   }
   /* recv_cb callback may decide to pause or close the handle */
   while (nread != -1
@@ -204,12 +323,241 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+
+/* The kernel refuses UDP_SEGMENT sends with more than 64 segments or that
+ * don't fit in a single IP packet before they're split up.
+ */
+#define UV__GSO_MAXSEGS 64
+#define UV__GSO_MAXSIZE 65000
+
+static int uv__udp_no_sendmmsg;
+
+
+static socklen_t uv__udp_addrlen(const struct sockaddr_storage* addr) {
+  if (addr->ss_family == AF_INET6)
+    return sizeof(struct sockaddr_in6);
+  else if (addr->ss_family == AF_UNSPEC)
+    return 0;  /* Connected socket, no address. */
+  else
+    return sizeof(struct sockaddr_in);
+}
+
+
+/* Appends as many requests as fit to a UDP_SEGMENT message that starts with
+ * `req`. They must go to the same peer and have the same size as `req`,
+ * except for the last one that can be shorter. Returns the number of
+ * requests in the message, 1 when coalescing isn't worth it.
+ */
+static unsigned int uv__udp_gso_group(uv_udp_t* handle,
+                                      uv_udp_send_t* req,
+                                      struct uv__mmsghdr* msg,
+                                      struct iovec* iov,
+                                      unsigned int iovmax,
+                                      char* control) {
+  uv_udp_send_t* next;
+  struct cmsghdr* cmsg;
+  socklen_t addrlen;
+  unsigned int nreqs;
+  unsigned int niov;
+  uint16_t segsize;
+  size_t total;
+  size_t size;
+  QUEUE* q;
+
+  total = uv__count_bufs(req->bufs, req->nbufs);
+  if (total == 0 || total > UV__GSO_MAXSIZE / 2 || req->nbufs > iovmax)
+    return 1;
+
+  segsize = total;
+
+  addrlen = uv__udp_addrlen(&req->addr);
+  memcpy(iov, req->bufs, req->nbufs * sizeof(*iov));
+  niov = req->nbufs;
+  nreqs = 1;
+
+  for (q = QUEUE_NEXT(&req->queue);
+       q != &handle->write_queue && nreqs < UV__GSO_MAXSEGS;
+       q = QUEUE_NEXT(q)) {
+    next = QUEUE_DATA(q, uv_udp_send_t, queue);
+    size = uv__count_bufs(next->bufs, next->nbufs);
+
+    if (size == 0 || size > segsize)
+      break;
+
+    if (total + size > UV__GSO_MAXSIZE || niov + next->nbufs > iovmax)
+      break;
+
+    if (next->addr.ss_family != req->addr.ss_family)
+      break;
+
+    if (memcmp(&next->addr, &req->addr, addrlen) != 0)
+      break;
+
+    memcpy(iov + niov, next->bufs, next->nbufs * sizeof(*iov));
+    niov += next->nbufs;
+    total += size;
+    nreqs++;
+
+    /* A short one ends the message. */
+    if (size < segsize)
+      break;
+  }
+
+  if (nreqs == 1)
+    return 1;
+
+  msg->msg_hdr.msg_iov = iov;
+  msg->msg_hdr.msg_iovlen = niov;
+  msg->msg_hdr.msg_control = control;
+  msg->msg_hdr.msg_controllen = CMSG_SPACE(sizeof(segsize));
+
+  cmsg = CMSG_FIRSTHDR(&msg->msg_hdr);
+  cmsg->cmsg_level = IPPROTO_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(segsize));
+  memcpy(CMSG_DATA(cmsg), &segsize, sizeof(segsize));
+
+  return nreqs;
+}
+
+
+/* Moves the first `nreqs` requests from the write queue to the completed
+ * queue. A negative `status` is an error, otherwise the requests' own
+ * sizes are reported.
+ */
+static void uv__udp_complete(uv_udp_t* handle, unsigned int nreqs, int status) {
+  uv_udp_send_t* req;
+  QUEUE* q;
+
+  while (nreqs-- > 0) {
+    q = QUEUE_HEAD(&handle->write_queue);
+    req = QUEUE_DATA(q, uv_udp_send_t, queue);
+
+    if (status < 0)
+      req->status = status;
+    else
+      req->status = uv__count_bufs(req->bufs, req->nbufs);
+
+    QUEUE_REMOVE(&req->queue);
+    QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+  }
+}
+
+
+/* Like the loop in uv__udp_sendmsg() but with one sendmmsg() call for up to
+ * UV__MMSG_MAXWIDTH messages. Returns -ENOSYS if the kernel doesn't have
+ * sendmmsg(), 0 otherwise.
+ */
+static int uv__udp_sendmmsg(uv_udp_t* handle) {
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  unsigned int nreqs[UV__MMSG_MAXWIDTH];
+  union {
+    char buf[CMSG_SPACE(sizeof(uint16_t))];
+    size_t align;  /* CMSG_ALIGN() unit. */
+  } control[UV__MMSG_MAXWIDTH];
+  struct iovec iov[256];
+  uv_udp_send_t* req;
+  unsigned int nmsgs;
+  unsigned int niov;
+  unsigned int i;
+  int completed;
+  int npkts;
+  QUEUE* q;
+
+  completed = 0;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    nmsgs = 0;
+    niov = 0;
+
+    for (q = QUEUE_HEAD(&handle->write_queue);
+         q != &handle->write_queue && nmsgs < ARRAY_SIZE(msgs);
+         q = QUEUE_NEXT(q)) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+
+      memset(&msgs[nmsgs], 0, sizeof(msgs[nmsgs]));
+      msgs[nmsgs].msg_hdr.msg_namelen = uv__udp_addrlen(&req->addr);
+      if (msgs[nmsgs].msg_hdr.msg_namelen != 0)
+        msgs[nmsgs].msg_hdr.msg_name = &req->addr;
+      msgs[nmsgs].msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      msgs[nmsgs].msg_hdr.msg_iovlen = req->nbufs;
+      nreqs[nmsgs] = 1;
+
+      if (handle->flags & UV_HANDLE_UDP_GSO) {
+        nreqs[nmsgs] = uv__udp_gso_group(handle,
+                                         req,
+                                         &msgs[nmsgs],
+                                         iov + niov,
+                                         ARRAY_SIZE(iov) - niov,
+                                         control[nmsgs].buf);
+        if (nreqs[nmsgs] > 1) {
+          niov += msgs[nmsgs].msg_hdr.msg_iovlen;
+          for (i = 1; i < nreqs[nmsgs]; i++)
+            q = QUEUE_NEXT(q);
+        }
+      }
+
+      nmsgs++;
+    }
+
+    do
+      npkts = uv__sendmmsg(handle->io_watcher.fd, msgs, nmsgs, 0);
+    while (npkts == -1 && errno == EINTR);
+
+    if (npkts == -1) {
+      if (errno == ENOSYS) {
+        uv__udp_no_sendmmsg = 1;
+        return -ENOSYS;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        uv__io_drained(&handle->io_watcher, UV__POLLOUT);
+        break;
+      }
+
+      /* The kernel or the route doesn't do segmentation offload. Stop
+       * trying and send the datagrams one by one.
+       */
+      if (nreqs[0] > 1 &&
+          (errno == EINVAL || errno == EIO || errno == ENOPROTOOPT ||
+           errno == EOPNOTSUPP)) {
+        handle->flags &= ~UV_HANDLE_UDP_GSO;
+        continue;
+      }
+
+      /* The error is for the first message, the others are tried again. */
+      uv__udp_complete(handle, nreqs[0], -errno);
+      completed = 1;
+      continue;
+    }
+
+    for (i = 0; i < (unsigned int) npkts; i++)
+      uv__udp_complete(handle, nreqs[i], 0);
+    completed = 1;
+  }
+
+  if (completed)
+    uv__io_feed(handle->loop, &handle->io_watcher);
+
+  return 0;
+}
+
+#endif /* __linux__ */
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  if (!uv__udp_no_sendmmsg)
+    if (uv__udp_sendmmsg(handle) == 0)
+      return;
+#endif /* __linux__ */
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -218,9 +566,11 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
     assert(req != NULL);
 
     memset(&h, 0, sizeof h);
-    h.msg_name = &req->addr;
-    h.msg_namelen = (req->addr.ss_family == AF_INET6 ?
-      sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+    if (req->addr.ss_family != AF_UNSPEC) {
+      h.msg_name = &req->addr;
+      h.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+    }
     h.msg_iov = (struct iovec*) req->bufs;
     h.msg_iovlen = req->nbufs;
 
@@ -228,8 +578,10 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
       size = sendmsg(handle->io_watcher.fd, &h, 0);
     } while (size == -1 && errno == EINTR);
 
-    if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      uv__io_drained(&handle->io_watcher, UV__POLLOUT);
       break;
+    }
 
     req->status = (size == -1 ? -errno : size);
 
@@ -290,7 +642,7 @@ int uv__udp_bind(uv_udp_t* handle,
   }
 #endif
   /* Check for bad flags. */
-  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR))
+  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR | UV_UDP_REUSEPORT))
     return -EINVAL;
     
   /* Cannot set IPv6-only mode on non-IPv6 socket. */
@@ -317,6 +669,19 @@ int uv__udp_bind(uv_udp_t* handle,
       goto out;
   }
 
+  if (flags & UV_UDP_REUSEPORT) {
+#ifdef SO_REUSEPORT
+    yes = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes))) {
+      err = -errno;
+      goto out;
+    }
+#else
+    err = -ENOTSUP;
+    goto out;
+#endif
+  }
+
   if (flags & UV_UDP_IPV6ONLY) {
 #ifdef IPV6_V6ONLY
     yes = 1;
@@ -392,6 +757,70 @@ static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
 }
 
 
+/* A connected handle sends to its peer and nowhere else, an unconnected one
+ * needs to be told where to send to.
+ */
+static int uv__udp_check_peer(const uv_udp_t* handle,
+                              const struct sockaddr* addr) {
+  if (handle->flags & UV_HANDLE_UDP_CONNECTED)
+    return addr == NULL ? 0 : -EISCONN;
+  else
+    return addr == NULL ? -EDESTADDRREQ : 0;
+}
+
+
+int uv_udp_connect(uv_udp_t* handle, const struct sockaddr* addr) {
+  struct sockaddr unspec;
+  unsigned int addrlen;
+  int err;
+
+  if (addr == NULL) {
+    if (!(handle->flags & UV_HANDLE_UDP_CONNECTED))
+      return -ENOTCONN;
+
+    /* Dissolve the association. Some kernels complain about the address
+     * family while doing so, the socket is disconnected nonetheless.
+     */
+    memset(&unspec, 0, sizeof(unspec));
+    unspec.sa_family = AF_UNSPEC;
+
+    do
+      err = connect(handle->io_watcher.fd, &unspec, sizeof(unspec));
+    while (err == -1 && errno == EINTR);
+
+    if (err == -1 && errno != EAFNOSUPPORT)
+      return -errno;
+
+    handle->flags &= ~UV_HANDLE_UDP_CONNECTED;
+    return 0;
+  }
+
+  if (handle->flags & UV_HANDLE_UDP_CONNECTED)
+    return -EISCONN;
+
+  if (addr->sa_family == AF_INET)
+    addrlen = sizeof(struct sockaddr_in);
+  else if (addr->sa_family == AF_INET6)
+    addrlen = sizeof(struct sockaddr_in6);
+  else
+    return -EINVAL;
+
+  err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+  if (err)
+    return err;
+
+  do
+    err = connect(handle->io_watcher.fd, addr, addrlen);
+  while (err == -1 && errno == EINTR);
+
+  if (err == -1)
+    return -errno;
+
+  handle->flags |= UV_HANDLE_UDP_CONNECTED;
+  return 0;
+}
+
+
 int uv__udp_send(uv_udp_send_t* req,
                  uv_udp_t* handle,
                  const uv_buf_t bufs[],
@@ -404,10 +833,16 @@ int uv__udp_send(uv_udp_send_t* req,
 
   assert(nbufs > 0);
 
-  err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+  err = uv__udp_check_peer(handle, addr);
   if (err)
     return err;
 
+  if (addr != NULL) {
+    err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+    if (err)
+      return err;
+  }
+
   /* It's legal for send_queue_count > 0 even when the write_queue is empty;
    * it means there are error-state requests in the write_completed_queue that
    * will touch up send_queue_size/count later.
@@ -416,14 +851,17 @@ int uv__udp_send(uv_udp_send_t* req,
 
   uv__req_init(handle->loop, req, UV_UDP_SEND);
   assert(addrlen <= sizeof(req->addr));
-  memcpy(&req->addr, addr, addrlen);
+  if (addr == NULL)
+    req->addr.ss_family = AF_UNSPEC;
+  else
+    memcpy(&req->addr, addr, addrlen);
   req->send_cb = send_cb;
   req->handle = handle;
   req->nbufs = nbufs;
 
   req->bufs = req->bufsml;
   if (nbufs > ARRAY_SIZE(req->bufsml))
-    req->bufs = malloc(nbufs * sizeof(bufs[0]));
+    req->bufs = uv__malloc(nbufs * sizeof(bufs[0]));
 
   if (req->bufs == NULL)
     return -ENOMEM;
@@ -434,9 +872,15 @@ int uv__udp_send(uv_udp_send_t* req,
   QUEUE_INSERT_TAIL(&handle->write_queue, &req->queue);
   uv__handle_start(handle);
 
-  if (empty_queue)
+  /* Don't send right away from inside a send callback, a request that
+   * completes immediately ends up on the completed queue again and
+   * uv__udp_run_completed() never gets to return to the event loop.
+   */
+  if (empty_queue && !(handle->flags & UV_HANDLE_UDP_PROCESSING))
     uv__udp_sendmsg(handle);
-  else
+
+  /* Socket buffer full, or the queue wasn't empty to begin with. */
+  if (!QUEUE_EMPTY(&handle->write_queue))
     uv__io_start(handle->loop, &handle->io_watcher, UV__POLLOUT);
 
   return 0;
@@ -458,10 +902,16 @@ int uv__udp_try_send(uv_udp_t* handle,
   if (handle->send_queue_count != 0)
     return -EAGAIN;
 
-  err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+  err = uv__udp_check_peer(handle, addr);
   if (err)
     return err;
 
+  if (addr != NULL) {
+    err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+    if (err)
+      return err;
+  }
+
   memset(&h, 0, sizeof h);
   h.msg_name = (struct sockaddr*) addr;
   h.msg_namelen = addrlen;
@@ -575,6 +1025,7 @@ int uv_udp_init(uv_loop_t* loop, uv_udp_t* handle) {
   handle->recv_cb = NULL;
   handle->send_queue_size = 0;
   handle->send_queue_count = 0;
+  handle->mmsg_size = 0;
   uv__io_init(&handle->io_watcher, uv__udp_io, -1);
   QUEUE_INIT(&handle->write_queue);
   QUEUE_INIT(&handle->write_completed_queue);
@@ -663,6 +1114,46 @@ int uv_udp_set_ttl(uv_udp_t* handle, int ttl) {
 }
 
 
+int uv_udp_set_recvmmsg(uv_udp_t* handle, size_t max_size) {
+#if defined(__linux__)
+  if (max_size > 64 * 1024)
+    return -EINVAL;
+
+  /* Find out if the kernel knows about recvmmsg (linux >= 2.6.33). */
+  if (max_size != 0)
+    if (uv__recvmmsg(-1, NULL, 0, 0, NULL) == -1 && errno == ENOSYS)
+      return -ENOSYS;
+
+  handle->mmsg_size = max_size;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_gso(uv_udp_t* handle, int enable) {
+#if defined(__linux__)
+  if (enable)
+    handle->flags |= UV_HANDLE_UDP_GSO;
+  else
+    handle->flags &= ~UV_HANDLE_UDP_GSO;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
+int uv_udp_set_edge_triggered(uv_udp_t* handle, int enable) {
+#if defined(__linux__)
+  return uv__io_set_edge(handle->loop, &handle->io_watcher, enable);
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv_udp_set_multicast_ttl(uv_udp_t* handle, int ttl) {
   return uv__setsockopt_maybe_char(handle, IP_MULTICAST_TTL, ttl);
 }
@@ -741,6 +1232,25 @@ int uv_udp_getsockname(const uv_udp_t* handle,
 }
 
 
+int uv_udp_getpeername(const uv_udp_t* handle,
+                       struct sockaddr* name,
+                       int* namelen) {
+  socklen_t socklen;
+
+  if (!(handle->flags & UV_HANDLE_UDP_CONNECTED))
+    return -ENOTCONN;
+
+  /* sizeof(socklen_t) != sizeof(int) on some systems. */
+  socklen = (socklen_t) *namelen;
+
+  if (getpeername(handle->io_watcher.fd, name, &socklen))
+    return -errno;
+
+  *namelen = (int) socklen;
+  return 0;
+}
+
+
 int uv__udp_recv_start(uv_udp_t* handle,
                        uv_alloc_cb alloc_cb,
                        uv_udp_recv_cb recv_cb) {
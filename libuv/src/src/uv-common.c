@@ -34,9 +34,11 @@
 #include <stddef.h> /* NULL */
 #include <stdlib.h> /* malloc */
 #include <string.h> /* memset */
+#include <errno.h>
 
 #if !defined(_WIN32)
 # include <net/if.h> /* if_nametoindex */
+# include <pthread.h>
 #endif
 
 /* EAI_* constants. */
@@ -47,6 +49,320 @@
 # include <linux/netlink.h>
 #endif
 
+typedef struct {
+  uv_malloc_func local_malloc;
+  uv_realloc_func local_realloc;
+  uv_calloc_func local_calloc;
+  uv_free_func local_free;
+  int cached;
+} uv__allocator_t;
+
+static uv__allocator_t uv__allocator = {
+  malloc,
+  realloc,
+  calloc,
+  free,
+#if defined(_WIN32)
+  0
+#else
+  1
+#endif
+};
+
+#if !defined(_WIN32)
+/* With the default allocator uv__free() keeps small blocks in a per-thread
+ * cache, one free list for each power-of-two size class from 32 to 2048
+ * bytes, and uv__malloc() takes them from there before it asks libc. The
+ * path copies, fs buffers and DNS cache copies are allocated on one thread
+ * and often freed on another, so a block goes to the cache of the thread
+ * that frees it. Nothing is tied to a loop; requests may outlive theirs.
+ *
+ * Each block starts with a header that holds its size class, which keeps
+ * malloc's alignment for the caller. Larger blocks get a header too and go
+ * straight back to libc. A replacement allocator sees every call unchanged.
+ */
+#define UV__ALLOC_HEADER  16
+#define UV__ALLOC_MIN     32
+#define UV__ALLOC_CLASSES 7
+#define UV__ALLOC_LARGE   UV__ALLOC_CLASSES
+#define UV__ALLOC_MAX_FREE 32  /* Blocks cached per class and thread. */
+
+struct uv__alloc_block {
+  size_t sclass;
+  struct uv__alloc_block* next;
+};
+
+struct uv__alloc_cache {
+  struct uv__alloc_block* free_list[UV__ALLOC_CLASSES];
+  unsigned int nfree[UV__ALLOC_CLASSES];
+};
+
+static pthread_key_t uv__alloc_key;
+static uv_once_t uv__alloc_key_once = UV_ONCE_INIT;
+static int uv__alloc_key_err;
+
+
+static void uv__alloc_cache_flush(void* arg) {
+  struct uv__alloc_cache* cache;
+  struct uv__alloc_block* b;
+  unsigned int i;
+
+  cache = arg;
+  for (i = 0; i < UV__ALLOC_CLASSES; i++) {
+    while ((b = cache->free_list[i]) != NULL) {
+      cache->free_list[i] = b->next;
+      free(b);
+    }
+  }
+
+  free(cache);
+}
+
+
+static void uv__alloc_key_init(void) {
+  uv__alloc_key_err = pthread_key_create(&uv__alloc_key, uv__alloc_cache_flush);
+}
+
+
+static struct uv__alloc_cache* uv__alloc_cache_get(int create) {
+  struct uv__alloc_cache* cache;
+
+  uv_once(&uv__alloc_key_once, uv__alloc_key_init);
+  if (uv__alloc_key_err)
+    return NULL;
+
+  cache = pthread_getspecific(uv__alloc_key);
+  if (cache != NULL || !create)
+    return cache;
+
+  cache = calloc(1, sizeof(*cache));
+  if (cache == NULL)
+    return NULL;
+
+  if (pthread_setspecific(uv__alloc_key, cache)) {
+    free(cache);
+    return NULL;
+  }
+
+  return cache;
+}
+
+
+static size_t uv__alloc_class(size_t size) {
+  size_t sclass;
+
+  if (size > UV__ALLOC_MIN << (UV__ALLOC_CLASSES - 1))
+    return UV__ALLOC_LARGE;
+
+  sclass = 0;
+  while (((size_t) UV__ALLOC_MIN << sclass) < size)
+    sclass++;
+
+  return sclass;
+}
+
+
+static void* uv__alloc_new(size_t size, size_t sclass, int zero) {
+  struct uv__alloc_block* b;
+
+  if (size > (size_t) -1 - UV__ALLOC_HEADER)
+    return NULL;
+
+  if (zero)
+    b = calloc(1, size + UV__ALLOC_HEADER);
+  else
+    b = malloc(size + UV__ALLOC_HEADER);
+
+  if (b == NULL)
+    return NULL;
+
+  b->sclass = sclass;
+  return (char*) b + UV__ALLOC_HEADER;
+}
+
+
+static void* uv__alloc_get(size_t size, int zero) {
+  struct uv__alloc_cache* cache;
+  struct uv__alloc_block* b;
+  size_t sclass;
+
+  sclass = uv__alloc_class(size);
+  if (sclass == UV__ALLOC_LARGE)
+    return uv__alloc_new(size, sclass, zero);
+
+  cache = uv__alloc_cache_get(0);
+  if (cache == NULL || cache->free_list[sclass] == NULL)
+    return uv__alloc_new((size_t) UV__ALLOC_MIN << sclass, sclass, zero);
+
+  b = cache->free_list[sclass];
+  cache->free_list[sclass] = b->next;
+  cache->nfree[sclass]--;
+
+  if (zero)
+    memset((char*) b + UV__ALLOC_HEADER, 0, size);
+
+  return (char*) b + UV__ALLOC_HEADER;
+}
+
+
+static void uv__alloc_put(void* ptr) {
+  struct uv__alloc_cache* cache;
+  struct uv__alloc_block* b;
+
+  b = (struct uv__alloc_block*) ((char*) ptr - UV__ALLOC_HEADER);
+  if (b->sclass == UV__ALLOC_LARGE) {
+    free(b);
+    return;
+  }
+
+  cache = uv__alloc_cache_get(1);
+  if (cache == NULL || cache->nfree[b->sclass] >= UV__ALLOC_MAX_FREE) {
+    free(b);
+    return;
+  }
+
+  b->next = cache->free_list[b->sclass];
+  cache->free_list[b->sclass] = b;
+  cache->nfree[b->sclass]++;
+}
+
+
+static void* uv__alloc_resize(void* ptr, size_t size) {
+  struct uv__alloc_block* b;
+  size_t avail;
+  void* p;
+
+  if (ptr == NULL)
+    return uv__alloc_get(size, 0);
+
+  b = (struct uv__alloc_block*) ((char*) ptr - UV__ALLOC_HEADER);
+  if (b->sclass == UV__ALLOC_LARGE) {
+    if (size > (size_t) -1 - UV__ALLOC_HEADER)
+      return NULL;
+
+    b = realloc(b, size + UV__ALLOC_HEADER);
+    if (b == NULL)
+      return NULL;
+
+    return (char*) b + UV__ALLOC_HEADER;
+  }
+
+  avail = (size_t) UV__ALLOC_MIN << b->sclass;
+  if (size <= avail)
+    return ptr;
+
+  p = uv__alloc_get(size, 0);
+  if (p == NULL)
+    return NULL;
+
+  memcpy(p, ptr, avail);
+  uv__alloc_put(ptr);
+
+  return p;
+}
+#endif
+
+
+void* uv__malloc(size_t size) {
+#if !defined(_WIN32)
+  if (uv__allocator.cached)
+    return uv__alloc_get(size, 0);
+#endif
+  return uv__allocator.local_malloc(size);
+}
+
+
+void* uv__calloc(size_t count, size_t size) {
+#if !defined(_WIN32)
+  if (uv__allocator.cached) {
+    if (size != 0 && count > (size_t) -1 / size)
+      return NULL;
+    return uv__alloc_get(count * size, 1);
+  }
+#endif
+  return uv__allocator.local_calloc(count, size);
+}
+
+
+void* uv__realloc(void* ptr, size_t size) {
+#if !defined(_WIN32)
+  if (uv__allocator.cached)
+    return uv__alloc_resize(ptr, size);
+#endif
+  return uv__allocator.local_realloc(ptr, size);
+}
+
+
+void uv__free(void* ptr) {
+  int saved_errno;
+
+  /* The error paths free memory before they return -errno. free(3) leaves
+   * errno alone, a replacement or the cache might not.
+   */
+  saved_errno = errno;
+#if !defined(_WIN32)
+  if (uv__allocator.cached) {
+    if (ptr != NULL)
+      uv__alloc_put(ptr);
+  } else {
+    uv__allocator.local_free(ptr);
+  }
+#else
+  uv__allocator.local_free(ptr);
+#endif
+  errno = saved_errno;
+}
+
+
+char* uv__strdup(const char* s) {
+  size_t len;
+  char* m;
+
+  len = strlen(s) + 1;
+  m = uv__malloc(len);
+  if (m == NULL)
+    return NULL;
+
+  return memcpy(m, s, len);
+}
+
+
+char* uv__strndup(const char* s, size_t n) {
+  size_t len;
+  char* m;
+
+  len = strlen(s);
+  if (n < len)
+    len = n;
+
+  m = uv__malloc(len + 1);
+  if (m == NULL)
+    return NULL;
+
+  m[len] = '\0';
+  return memcpy(m, s, len);
+}
+
+
+int uv_replace_allocator(uv_malloc_func malloc_func,
+                         uv_realloc_func realloc_func,
+                         uv_calloc_func calloc_func,
+                         uv_free_func free_func) {
+  if (malloc_func == NULL || realloc_func == NULL ||
+      calloc_func == NULL || free_func == NULL) {
+    return UV_EINVAL;
+  }
+
+  uv__allocator.local_malloc = malloc_func;
+  uv__allocator.local_realloc = realloc_func;
+  uv__allocator.local_calloc = calloc_func;
+  uv__allocator.local_free = free_func;
+  uv__allocator.cached = 0;
+
+  return 0;
+}
+
+
 #define XX(uc, lc) case UV_##uc: return sizeof(uv_##lc##_t);
 
 size_t uv_handle_size(uv_handle_type type) {
@@ -228,7 +544,9 @@ int uv_udp_send(uv_udp_send_t* req,
   if (handle->type != UV_UDP)
     return UV_EINVAL;
 
-  if (addr->sa_family == AF_INET)
+  if (addr == NULL)
+    addrlen = 0;  /* Connected handle, see uv_udp_connect(). */
+  else if (addr->sa_family == AF_INET)
     addrlen = sizeof(struct sockaddr_in);
   else if (addr->sa_family == AF_INET6)
     addrlen = sizeof(struct sockaddr_in6);
@@ -250,7 +568,9 @@ int uv_udp_try_send(uv_udp_t* handle,
   if (handle->type != UV_UDP)
     return UV_EINVAL;
 
-  if (addr->sa_family == AF_INET)
+  if (addr == NULL)
+    addrlen = 0;  /* Connected handle, see uv_udp_connect(). */
+  else if (addr->sa_family == AF_INET)
     addrlen = sizeof(struct sockaddr_in);
   else if (addr->sa_family == AF_INET6)
     addrlen = sizeof(struct sockaddr_in6);
@@ -298,7 +618,7 @@ static void* uv__thread_start(void *arg)
 
   ctx_p = arg;
   ctx = *ctx_p;
-  free(ctx_p);
+  uv__free(ctx_p);
   ctx.entry(ctx.arg);
 
   return 0;
@@ -309,7 +629,7 @@ int uv_thread_create(uv_thread_t *tid, void (*entry)(void *arg), void *arg) {
   struct thread_ctx* ctx;
   int err;
 
-  ctx = malloc(sizeof(*ctx));
+  ctx = uv__malloc(sizeof(*ctx));
   if (ctx == NULL)
     return UV_ENOMEM;
 
@@ -324,7 +644,7 @@ int uv_thread_create(uv_thread_t *tid, void (*entry)(void *arg), void *arg) {
 #endif
 
   if (err)
-    free(ctx);
+    uv__free(ctx);
 
   return err ? -1 : 0;
 }
@@ -111,6 +111,14 @@ int uv__socket_sockopt(uv_handle_t* handle, int optname, int* value);
 
 void uv__fs_readdir_cleanup(uv_fs_t* req);
 
+/* Allocator, see uv_replace_allocator(). */
+void* uv__malloc(size_t size);
+void* uv__calloc(size_t count, size_t size);
+void* uv__realloc(void* ptr, size_t size);
+void uv__free(void* ptr);
+char* uv__strdup(const char* s);
+char* uv__strndup(const char* s, size_t n);
+
 #define uv__has_active_reqs(loop)                                             \
   (QUEUE_EMPTY(&(loop)->active_reqs) == 0)
 
@@ -84,6 +84,19 @@ int uv_async_send(uv_async_t* handle) {
 }
 
 
+int uv_channel_init(uv_loop_t* loop,
+                    uv_channel_t* channel,
+                    unsigned int capacity,
+                    uv_channel_cb cb) {
+  return UV_ENOSYS;
+}
+
+
+int uv_channel_send(uv_channel_t* channel, void* msg) {
+  return UV_ENOSYS;
+}
+
+
 void uv_process_async_wakeup_req(uv_loop_t* loop, uv_async_t* handle,
     uv_req_t* req) {
   assert(handle->type == UV_ASYNC);
@@ -297,6 +297,21 @@ int uv_backend_timeout(const uv_loop_t* loop) {
 }
 
 
+int uv_loop_set_metrics(uv_loop_t* loop, int enable) {
+  return UV_ENOSYS;
+}
+
+
+int uv_loop_metrics(const uv_loop_t* loop, uv_loop_metrics_t* metrics) {
+  return UV_ENOSYS;
+}
+
+
+int uv_threadpool_metrics(uv_threadpool_metrics_t* metrics) {
+  return UV_ENOSYS;
+}
+
+
 static void uv_poll(uv_loop_t* loop, DWORD timeout) {
   DWORD bytes;
   ULONG_PTR key;
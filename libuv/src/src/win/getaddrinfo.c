@@ -352,3 +352,44 @@ error:
   }
   return uv_translate_sys_error(err);
 }
+
+
+int uv_loop_set_dns_cache(uv_loop_t* loop,
+                          unsigned int ttl,
+                          unsigned int negative_ttl,
+                          unsigned int max_entries) {
+  return UV_ENOSYS;
+}
+
+
+int uv_dns_cache_stats(const uv_loop_t* loop, uv_dns_cache_stats_t* stats) {
+  return UV_ENOSYS;
+}
+
+
+int uv_resolver_init(uv_loop_t* loop, uv_resolver_t* resolver) {
+  return UV_ENOSYS;
+}
+
+
+int uv_resolver_set_servers(uv_resolver_t* resolver,
+                            const struct sockaddr* addrs[],
+                            unsigned int naddrs) {
+  return UV_ENOSYS;
+}
+
+
+int uv_resolver_set_timeout(uv_resolver_t* resolver,
+                            unsigned int timeout,
+                            unsigned int attempts) {
+  return UV_ENOSYS;
+}
+
+
+int uv_resolve(uv_resolver_t* resolver,
+               uv_resolve_t* req,
+               const char* name,
+               uv_dns_type type,
+               uv_resolve_cb cb) {
+  return UV_ENOSYS;
+}
@@ -46,6 +46,13 @@ int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb) {
 }
 
 
+int uv_listen_batch(uv_stream_t* stream,
+                    int backlog,
+                    uv_connection_batch_cb cb) {
+  return UV_ENOSYS;
+}
+
+
 int uv_accept(uv_stream_t* server, uv_stream_t* client) {
   int err;
 
@@ -189,6 +196,16 @@ int uv_try_write(uv_stream_t* stream,
 }
 
 
+int uv_write_file(uv_write_t* req,
+                  uv_stream_t* handle,
+                  uv_file file,
+                  int64_t offset,
+                  size_t length,
+                  uv_write_cb cb) {
+  return UV_ENOSYS;
+}
+
+
 int uv_shutdown(uv_shutdown_t* req, uv_stream_t* handle, uv_shutdown_cb cb) {
   uv_loop_t* loop = handle->loop;
 
@@ -233,3 +250,49 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
 
   return 0;
 }
+
+
+int uv_stream_set_edge_triggered(uv_stream_t* handle, int enable) {
+  return UV_ENOSYS;
+}
+
+
+int uv_loop_set_buf_pool(uv_loop_t* loop,
+                         size_t buf_size,
+                         unsigned int max_free) {
+  return UV_ENOSYS;
+}
+
+
+void uv_buf_pool_alloc(uv_handle_t* handle,
+                       size_t suggested_size,
+                       uv_buf_t* buf) {
+  /* Zero-length buffer, the read callback gets UV_ENOBUFS. */
+  *buf = uv_buf_init(NULL, 0);
+}
+
+
+void uv_buf_pool_ref(const uv_buf_t* buf) {
+}
+
+
+void uv_buf_pool_unref(const uv_buf_t* buf) {
+}
+
+
+int uv_buf_pool_stats(const uv_loop_t* loop, uv_buf_pool_stats_t* stats) {
+  return UV_ENOSYS;
+}
+
+
+int uv_splice_start(uv_splice_t* req,
+                    uv_stream_t* src,
+                    uv_stream_t* dst,
+                    uv_splice_cb cb) {
+  return UV_ENOSYS;
+}
+
+
+int uv_splice_stop(uv_splice_t* req) {
+  return UV_ENOSYS;
+}
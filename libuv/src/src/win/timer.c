@@ -195,6 +195,11 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 }
 
 
+int uv_loop_set_timer_wheel(uv_loop_t* loop, int enable) {
+  return UV_ENOSYS;
+}
+
+
 DWORD uv__next_timeout(const uv_loop_t* loop) {
   uv_timer_t* timer;
   int64_t delta;
@@ -178,6 +178,10 @@ static int uv_udp_maybe_bind(uv_udp_t* handle,
     return ERROR_INVALID_PARAMETER;
   }
 
+  /* Windows has no SO_REUSEPORT. */
+  if (flags & UV_UDP_REUSEPORT)
+    return ERROR_NOT_SUPPORTED;
+
   if (handle->socket == INVALID_SOCKET) {
     SOCKET sock = socket(addr->sa_family, SOCK_DGRAM, 0);
     if (sock == INVALID_SOCKET) {
@@ -746,6 +750,33 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int value) {
 }
 
 
+int uv_udp_set_edge_triggered(uv_udp_t* handle, int enable) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_recvmmsg(uv_udp_t* handle, size_t max_size) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_set_gso(uv_udp_t* handle, int enable) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_connect(uv_udp_t* handle, const struct sockaddr* addr) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_getpeername(const uv_udp_t* handle,
+                       struct sockaddr* name,
+                       int* namelen) {
+  return UV_ENOSYS;
+}
+
+
 int uv_udp_open(uv_udp_t* handle, uv_os_sock_t sock) {
   WSAPROTOCOL_INFOW protocol_info;
   int opt_len;
@@ -855,6 +886,10 @@ int uv__udp_send(uv_udp_send_t* req,
   const struct sockaddr* bind_addr;
   int err;
 
+  /* There's no uv_udp_connect() on windows yet. */
+  if (addr == NULL)
+    return UV_EDESTADDRREQ;
+
   if (!(handle->flags & UV_HANDLE_BOUND)) {
     if (addrlen == sizeof(uv_addr_ip4_any_)) {
       bind_addr = (const struct sockaddr*) &uv_addr_ip4_any_;